@@ -0,0 +1,67 @@
+#include "AllocationHook.h"
+#include <cstdlib>
+#include <new>
+
+#ifndef NDEBUG
+
+namespace
+{
+	thread_local long long threadAllocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	threadAllocations++;
+	if (void* pointer = std::malloc(size > 0 ? size : 1))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+long long AllocationHook::getThreadAllocations()
+{
+	return threadAllocations;
+}
+
+bool AllocationHook::isEnabled()
+{
+	return true;
+}
+
+#else
+
+long long AllocationHook::getThreadAllocations()
+{
+	return 0;
+}
+
+bool AllocationHook::isEnabled()
+{
+	return false;
+}
+
+#endif
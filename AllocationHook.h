@@ -0,0 +1,12 @@
+#pragma once
+
+namespace AllocationHook
+{
+	/*
+	Debug builds replace the global operator new and delete to count the heap
+	allocations of every thread, so a steady state tick can be checked to allocate nothing.
+	Release builds keep the standard operators and always report 0
+	*/
+	long long getThreadAllocations(); // global operator new calls made by the calling thread
+	bool isEnabled();
+}
@@ -1,14 +1,14 @@
 #include "Asteroid.h"
+#include "FixedMath.h"
 #include <iostream>
 
 Asteroid::Asteroid(const sf::Texture& _asteroidTextureLevel0 , const sf::Texture& _asteroidTextureLevel1 , const int _level)
 	:
 	asteroidTextureLevel0{ _asteroidTextureLevel0},
 	asteroidTextureLevel1{ _asteroidTextureLevel1},
-	level{_level},
-	madeDamage{false}
+	level{_level}
 {
-	scale(sf::Vector2f(0.060f, 0.060f));
+	scale(sf::Vector2f(RULES_ASTEROID_SCALE, RULES_ASTEROID_SCALE));
 	setOrigin(getPosition().x + getLocalBounds().width / 2, getPosition().y + getLocalBounds().height / 2);
 	intializeAsteroid();
 }
@@ -17,26 +17,12 @@ Asteroid::~Asteroid()
 {
 }
 
-int getRandomNumber(int min, int max)
-{
-	/*
-	Retruns random number in range(min,max)
-	*/
-	static constexpr double fraction{ 1.0 / (RAND_MAX + 1.0) };  
-	return min + static_cast<int>((max - min + 1) * (std::rand() * fraction));
-}
-
 void Asteroid::moveAsteroid(const float dt)
 {
 	/*
 	Function moves the asteroid in its direction, and does some bound checking
 	*/
-	move(dt*speed*direction);
-
-	if (getPosition().x > 1000)		 setPosition(sf::Vector2f(0, getPosition().y));
-	else if (getPosition().x < -200) setPosition(sf::Vector2f(800, getPosition().y));
-	else if (getPosition().y > 1000) setPosition(sf::Vector2f(getPosition().x, 0));
-	else if (getPosition().y < -200) setPosition(sf::Vector2f(getPosition().x, 800));
+	setPosition(GameRules::moveAsteroid(getPosition(), speed, direction, dt, FixedMath::isEnabled()));
 }
 
 void Asteroid::intializeAsteroid()
@@ -44,28 +30,28 @@ void Asteroid::intializeAsteroid()
 	/*
 	Function intializes Asteroid based on its current level
 	*/
+	sf::Vector2f position = getPosition();
 	switch (level)
 	{
 	case 0:
 		setTexture(asteroidTextureLevel0);
-		direction = { static_cast <float> (rand()) / static_cast <float> (RAND_MAX) ,  static_cast <float> (rand()) / static_cast <float> (RAND_MAX) }; // range 0.0f - 1.0f
-		speed = 0.35f + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (0.40f - 0.35f)));
 		break;
-
 	case 1:
 		setTexture(asteroidTextureLevel1);
-		direction = { static_cast <float> (rand()) / static_cast <float> (RAND_MAX) ,  static_cast <float> (rand()) / static_cast <float> (RAND_MAX) }; // range 0.0f - 1.0f
-		speed = 0.15f + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (0.25f - 0.15f)));
-		setPosition(
-			0.0f + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (800.0f - 0.0f))),
-			0.0f + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (800.0f - 0.0f)))
-		);
-		if (direction.x < 0.02f && direction.y < 0.1f)
-			speed = 10 * speed;
 		break;
 	default:
-		break;
+		return;
 	}
+	GameRules::rollAsteroid(level, random, speed, direction, position);
+	setPosition(position);
+}
+
+void Asteroid::reset(const int _level, const CounterRandom& _random)
+{
+	random = _random;
+	level = _level;
+	expendable = false;
+	intializeAsteroid();
 }
 
 void Asteroid::downSize()
@@ -89,4 +75,66 @@ void Asteroid::downSize()
 int Asteroid::getLevel()
 {
 	return level;
-}
\ No newline at end of file
+}
+
+sf::Vector2f Asteroid::getVelocity() const
+{
+	return speed * direction; // pixels per ms
+}
+
+bool Asteroid::isExpendable() const
+{
+	return expendable;
+}
+
+void Asteroid::setExpendable(const bool _expendable)
+{
+	expendable = _expendable;
+}
+
+void Asteroid::setVelocity(const sf::Vector2f velocity)
+{
+	speed = 1.f;
+	direction = velocity;
+}
+
+float Asteroid::getMass() const
+{
+	return GameRules::asteroidMass(level);
+}
+
+float Asteroid::getRadius() const
+{
+	return GameRules::asteroidBounds(getPosition()).width / 2;
+}
+
+// Snapshot
+
+void Asteroid::saveState(StateWriter& writer) const
+{
+	writer.write(getPosition().x);
+	writer.write(getPosition().y);
+	writer.write(direction.x);
+	writer.write(direction.y);
+	writer.write(speed);
+	writer.write(static_cast<std::uint8_t>(level));
+	writer.write(static_cast<std::uint8_t>(expendable));
+	random.saveState(writer);
+}
+
+void Asteroid::loadState(StateReader& reader)
+{
+	/*
+	Function restores the state written by saveState, unlike intializeAsteroid it does not randomize anything
+	*/
+	float x = reader.read<float>();
+	float y = reader.read<float>();
+	setPosition(x, y);
+	direction.x = reader.read<float>();
+	direction.y = reader.read<float>();
+	speed = reader.read<float>();
+	level = reader.read<std::uint8_t>();
+	expendable = reader.read<std::uint8_t>() != 0;
+	random.loadState(reader);
+	setTexture(level == 0 ? asteroidTextureLevel0 : asteroidTextureLevel1);
+}
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include "Snapshot.h"
+#include "MemoryTracker.h"
+#include "CounterRandom.h"
+#include "GameRules.h"
 
-class Asteroid : public sf::Sprite
+class Asteroid : public sf::Sprite, public Tracked<MEMORY_ENTITIES>
 {
 public:
 	Asteroid(const sf::Texture& _asteroidTextureLevel0, const sf::Texture& _asteroidTextureLevel1 , const int _level = 1);
@@ -10,14 +14,26 @@ public:
 private:
 	int level; float speed = 1;
 	sf::Vector2f direction;
-	const sf::Texture asteroidTextureLevel0;
-	const sf::Texture asteroidTextureLevel1;
+	const sf::Texture& asteroidTextureLevel0; // owned by the Game, shared by every asteroid
+	const sf::Texture& asteroidTextureLevel1;
+	CounterRandom random; // own stream, given by the game when it spawns the asteroid
+	bool expendable = false; // part of a wave: gone instead of respawned when shot small
 
 public:
-	bool madeDamage;
 	void intializeAsteroid();
+	void reset(const int _level, const CounterRandom& _random); // reuse by the AsteroidPool
 	void moveAsteroid(const float speed);
 	void downSize();
 	int  getLevel();
+	sf::Vector2f getVelocity() const;
+	bool isExpendable() const;
+	void setExpendable(const bool _expendable);
+	void setVelocity(const sf::Vector2f velocity);
+	float getMass() const;
+	float getRadius() const;
+
+	// Snapshot
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
 };
 
@@ -0,0 +1,152 @@
+#include "AsteroidIndex.h"
+#include <algorithm>
+#include <cmath>
+
+AsteroidIndex::AsteroidIndex()
+	:
+	numOfCells{ static_cast<int>((INDEX_FIELD_MAX - INDEX_FIELD_MIN) / INDEX_CELL_SIZE) + 1 }
+{
+	cellStart.assign(numOfCells * numOfCells + 1, 0);
+}
+
+void AsteroidIndex::reserve(const int numOfAsteroids)
+{
+	pending.reserve(numOfAsteroids);
+	sorted.reserve(numOfAsteroids);
+	pendingCell.reserve(numOfAsteroids);
+}
+
+void AsteroidIndex::clear()
+{
+	pending.clear();
+}
+
+void AsteroidIndex::insert(const IndexedAsteroid& asteroid)
+{
+	pending.push_back(asteroid);
+}
+
+void AsteroidIndex::build()
+{
+	/*
+	Function groups the inserted asteroids by cell (counting sort, no allocations once the vectors have grown)
+	*/
+	const int numOfAsteroids = static_cast<int>(pending.size());
+	std::fill(cellStart.begin(), cellStart.end(), 0);
+	pendingCell.resize(numOfAsteroids);
+	sorted.resize(numOfAsteroids);
+
+	for (int i{ 0 }; i < numOfAsteroids; i++)
+	{
+		pendingCell[i] = getCell(pending[i].y) * numOfCells + getCell(pending[i].x);
+		cellStart[pendingCell[i]]++;
+	}
+	for (int c{ 1 }; c < numOfCells * numOfCells; c++) // end of every cell
+		cellStart[c] += cellStart[c - 1];
+	cellStart[numOfCells * numOfCells] = numOfAsteroids;
+	for (int i{ numOfAsteroids - 1 }; i >= 0; i--) // moves every end back to the start of its cell
+		sorted[--cellStart[pendingCell[i]]] = pending[i];
+}
+
+int AsteroidIndex::findNearest(const float x, const float y, const int k, Neighbour* neighbours) const
+{
+	/*
+	Function writes up to k (at most INDEX_MAX_NEIGHBOURS) asteroids closest to (x,y) into neighbours,
+	nearest first, and returns how many it found. It searches rings of cells around (x,y) and stops
+	once no unsearched cell can hold anything closer than the k-th neighbour
+	*/
+	const int maxNeighbours = std::min(k, INDEX_MAX_NEIGHBOURS);
+	const int cellX = getCell(x);
+	const int cellY = getCell(y);
+	int found = 0;
+
+	for (int ring{ 0 }; ring < numOfCells; ring++)
+	{
+		for (int cy{ cellY - ring }; cy <= cellY + ring; cy++)
+		{
+			if (cy < 0 || cy >= numOfCells)
+				continue;
+			const bool edgeRow = cy == cellY - ring || cy == cellY + ring;
+			for (int cx{ cellX - ring }; cx <= cellX + ring; cx += edgeRow ? 1 : 2 * ring) // only the border of the ring
+			{
+				if (cx >= 0 && cx < numOfCells)
+				{
+					const int cell = cy * numOfCells + cx;
+					for (int i{ cellStart[cell] }; i < cellStart[cell + 1]; i++)
+					{
+						float dx = sorted[i].x - x;
+						float dy = sorted[i].y - y;
+						float distanceSquared = dx * dx + dy * dy;
+						if (found == maxNeighbours && distanceSquared >= neighbours[found - 1].distanceSquared)
+							continue;
+
+						// insertion into the sorted list, it is at most INDEX_MAX_NEIGHBOURS long
+						int j = found < maxNeighbours ? found++ : found - 1;
+						while (j > 0 && neighbours[j - 1].distanceSquared > distanceSquared)
+						{
+							neighbours[j] = neighbours[j - 1];
+							j--;
+						}
+						neighbours[j] = { &sorted[i], distanceSquared };
+					}
+				}
+				if (ring == 0)
+					break;
+			}
+		}
+
+		// everything outside this ring is at least ring * INDEX_CELL_SIZE away
+		const float searched = ring * INDEX_CELL_SIZE;
+		if (found == maxNeighbours && neighbours[found - 1].distanceSquared <= searched * searched)
+			break;
+	}
+	return found;
+}
+
+bool AsteroidIndex::intercept(const float shooterX, const float shooterY, const float projectileSpeed,
+	const IndexedAsteroid& asteroid, float& time, float& aimX, float& aimY)
+{
+	/*
+	Function solves |asteroid + velocity * t - shooter| = projectileSpeed * t for the earliest t > 0,
+	the point where a shot fired now meets the asteroid. Returns false if the asteroid outruns the projectile
+	*/
+	const float dx = asteroid.x - shooterX;
+	const float dy = asteroid.y - shooterY;
+	const float a = asteroid.vx * asteroid.vx + asteroid.vy * asteroid.vy - projectileSpeed * projectileSpeed;
+	const float b = 2 * (dx * asteroid.vx + dy * asteroid.vy);
+	const float c = dx * dx + dy * dy;
+
+	if (std::fabs(a) < 1e-6f) // same speed, the equation is linear
+	{
+		if (b >= 0)
+			return false;
+		time = -c / b;
+	}
+	else
+	{
+		const float discriminant = b * b - 4 * a * c;
+		if (discriminant < 0)
+			return false;
+		const float root = std::sqrt(discriminant);
+		const float t1 = (-b - root) / (2 * a);
+		const float t2 = (-b + root) / (2 * a);
+		time = std::min(t1, t2) > 0 ? std::min(t1, t2) : std::max(t1, t2);
+		if (time <= 0)
+			return false;
+	}
+
+	aimX = asteroid.x + asteroid.vx * time;
+	aimY = asteroid.y + asteroid.vy * time;
+	return true;
+}
+
+int AsteroidIndex::getSize() const
+{
+	return static_cast<int>(sorted.size());
+}
+
+int AsteroidIndex::getCell(const float position) const
+{
+	int cell = static_cast<int>((position - INDEX_FIELD_MIN) / INDEX_CELL_SIZE);
+	return std::min(std::max(cell, 0), numOfCells - 1);
+}
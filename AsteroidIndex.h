@@ -0,0 +1,57 @@
+#pragma once
+
+#include "MemoryTracker.h"
+#include <vector>
+
+#define INDEX_FIELD_MIN -200.f	// asteroids live in this square, see Asteroid::moveAsteroid
+#define INDEX_FIELD_MAX 1000.f
+#define INDEX_CELL_SIZE 64.f
+#define INDEX_MAX_NEIGHBOURS 16
+
+struct IndexedAsteroid
+{
+	float x, y;
+	float vx, vy;	// pixels per ms
+	float radius;
+	int id;			// index in the caller's asteroid list
+};
+
+// Result of a nearest neighbour query
+struct Neighbour
+{
+	const IndexedAsteroid* asteroid;
+	float distanceSquared;
+};
+
+class AsteroidIndex
+{
+	/*
+	Uniform grid of asteroid centres, rebuilt every tick with a counting sort.
+	Asteroids are stored cell by cell, so a query reads a few short contiguous runs
+	and the index can be shared by any number of readers once it is built
+	*/
+public:
+	AsteroidIndex();
+	void reserve(const int numOfAsteroids); // building an index of that many asteroids does not allocate
+private:
+	int numOfCells;
+	TrackedVector<IndexedAsteroid, MEMORY_COLLISION> pending;	// inserted since clear()
+	TrackedVector<IndexedAsteroid, MEMORY_COLLISION> sorted;	// grouped by cell after build()
+	TrackedVector<int, MEMORY_COLLISION> cellStart;
+	TrackedVector<int, MEMORY_COLLISION> pendingCell;
+
+public:
+	void clear();
+	void insert(const IndexedAsteroid& asteroid);
+	void build();
+
+	// Queries, only valid after build()
+	int findNearest(const float x, const float y, const int k, Neighbour* neighbours) const;
+	static bool intercept(const float shooterX, const float shooterY, const float projectileSpeed,
+		const IndexedAsteroid& asteroid, float& time, float& aimX, float& aimY);
+
+	int getSize() const;
+
+private:
+	int getCell(const float position) const;
+};
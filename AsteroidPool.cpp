@@ -0,0 +1,44 @@
+#include "AsteroidPool.h"
+
+AsteroidPool::AsteroidPool(const sf::Texture& _asteroidTextureLevel0, const sf::Texture& _asteroidTextureLevel1, const int _size)
+{
+	allAsteroids.reserve(_size);
+	freeAsteroids.reserve(_size);
+	for (int i{ 0 }; i < _size; i++)
+	{
+		allAsteroids.push_back(new Asteroid(_asteroidTextureLevel0, _asteroidTextureLevel1));
+		freeAsteroids.push_back(allAsteroids.back());
+	}
+}
+
+AsteroidPool::~AsteroidPool()
+{
+	for (auto* asteroid : allAsteroids)
+		delete asteroid;
+}
+
+Asteroid* AsteroidPool::acquire(const CounterRandom& random, const int level)
+{
+	if (freeAsteroids.empty())
+		return nullptr;
+	Asteroid* asteroid = freeAsteroids.back();
+	freeAsteroids.pop_back();
+	asteroid->reset(level, random);
+	return asteroid;
+}
+
+void AsteroidPool::release(Asteroid* asteroid)
+{
+	freeAsteroids.push_back(asteroid); // capacity is the pool size, never grows
+}
+
+// G&S
+int AsteroidPool::getSize() const
+{
+	return static_cast<int>(allAsteroids.size());
+}
+
+int AsteroidPool::getNumOfFree() const
+{
+	return static_cast<int>(freeAsteroids.size());
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Asteroid.h"
+#include "MemoryTracker.h"
+
+class AsteroidPool
+{
+	/*
+	Every asteroid a game can use, created once when the textures are loaded.
+	acquire() hands out a free asteroid reinitialized at the given level and
+	release() takes it back, so spawning during the game never touches the heap
+	*/
+public:
+	AsteroidPool(const sf::Texture& _asteroidTextureLevel0, const sf::Texture& _asteroidTextureLevel1, const int _size = ASTEROID_POOL_SIZE);
+	~AsteroidPool();
+	AsteroidPool(const AsteroidPool&) = delete;
+	AsteroidPool& operator=(const AsteroidPool&) = delete;
+private:
+	TrackedVector<Asteroid*, MEMORY_ENTITIES> allAsteroids;
+	TrackedVector<Asteroid*, MEMORY_ENTITIES> freeAsteroids;
+
+public:
+	Asteroid* acquire(const CounterRandom& random, const int level = 1); // nullptr when every asteroid is in use
+	void release(Asteroid* asteroid);
+
+	// G&S
+	int getSize() const;
+	int getNumOfFree() const;
+};
@@ -0,0 +1,423 @@
+#include "AsteroidSolver.h"
+#include "SimWorld.h"
+#include "SimulationPolicies.h"
+#include "TimerWheel.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+AsteroidSolver::AsteroidSolver(const int _numOfThreads)
+{
+	int numOfThreads = _numOfThreads > 0 ? _numOfThreads : static_cast<int>(std::thread::hardware_concurrency());
+	numOfThreads = std::max(1, std::min(numOfThreads, SOLVER_MAX_THREADS));
+	for (int i{ 1 }; i < numOfThreads; i++) // the calling thread solves islands too
+		workers.emplace_back(&AsteroidSolver::workerLoop, this);
+}
+
+AsteroidSolver::~AsteroidSolver()
+{
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		stopWorkers = true;
+	}
+	workCondition.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void AsteroidSolver::resize(const int _numOfBodies)
+{
+	numOfBodies = _numOfBodies;
+	for (auto* array : { &x, &y, &vx, &vy, &radius, &inverseMass })
+		array->resize(numOfBodies);
+}
+
+void AsteroidSolver::reserve(const int maxBodies)
+{
+	for (auto* array : { &x, &y, &vx, &vy, &radius, &inverseMass })
+		array->reserve(maxBodies);
+	for (auto* array : { &bodyCell, &sortedBodies, &parent, &islandOf, &islandStart, &bodyContacts })
+		array->reserve(maxBodies + 1);
+	// every contact uses up one of the SOLVER_MAX_BODY_CONTACTS of two bodies
+	const size_t maxContacts = static_cast<size_t>(maxBodies) * SOLVER_MAX_BODY_CONTACTS / 2 + 1;
+	contacts.reserve(maxContacts);
+	islandContacts.reserve(maxContacts);
+	cellStart.reserve(SOLVER_MAX_GRID_CELLS * SOLVER_MAX_GRID_CELLS + 1);
+}
+
+void AsteroidSolver::solve()
+{
+	/*
+	Function resolves every overlap between the bodies, velocities get the elastic response
+	and positions are pushed apart
+	*/
+	contacts.clear();
+	droppedContacts = 0;
+	numOfIslands = 0;
+	largestIsland = 0;
+	if (numOfBodies < 2)
+		return;
+
+	findContacts();
+	if (contacts.empty())
+		return;
+	buildIslands();
+	solveIslands();
+}
+
+void AsteroidSolver::findContacts()
+{
+	/*
+	Function sorts the bodies into grid cells (counting sort) and tests every body against
+	the bodies after it in its own and the neighbouring cells, contacts come out in body order.
+	A body takes part in SOLVER_MAX_BODY_CONTACTS contacts at most, so the contacts fit what reserve()
+	allocated however the bodies pile up. Positions are already wrapped by the caller and the field
+	does not join up at its edges (Asteroid::moveAsteroid teleports from -200/1000 to 800/0),
+	so no pair touches across an edge and the grid covers the bodies where they are
+	*/
+	float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0], maxRadius = radius[0];
+	for (int i{ 1 }; i < numOfBodies; i++)
+	{
+		minX = std::min(minX, x[i]); maxX = std::max(maxX, x[i]);
+		minY = std::min(minY, y[i]); maxY = std::max(maxY, y[i]);
+		maxRadius = std::max(maxRadius, radius[i]);
+	}
+	cellSize = std::max({ 2.f * maxRadius, (maxX - minX) / SOLVER_MAX_GRID_CELLS, (maxY - minY) / SOLVER_MAX_GRID_CELLS, 1.f });
+	gridMinX = minX;
+	gridMinY = minY;
+	cellsX = std::min(static_cast<int>((maxX - minX) / cellSize) + 1, SOLVER_MAX_GRID_CELLS);
+	cellsY = std::min(static_cast<int>((maxY - minY) / cellSize) + 1, SOLVER_MAX_GRID_CELLS);
+	const int numOfCells = cellsX * cellsY;
+
+	auto cellX = [&](const float position) { return std::min(static_cast<int>((position - gridMinX) / cellSize), cellsX - 1); };
+	auto cellY = [&](const float position) { return std::min(static_cast<int>((position - gridMinY) / cellSize), cellsY - 1); };
+
+	cellStart.assign(numOfCells + 1, 0);
+	bodyContacts.assign(numOfBodies, 0);
+	bodyCell.resize(numOfBodies);
+	sortedBodies.resize(numOfBodies);
+	for (int i{ 0 }; i < numOfBodies; i++)
+	{
+		bodyCell[i] = cellY(y[i]) * cellsX + cellX(x[i]);
+		cellStart[bodyCell[i] + 1]++;
+	}
+	for (int c{ 0 }; c < numOfCells; c++)
+		cellStart[c + 1] += cellStart[c];
+	for (int i{ 0 }; i < numOfBodies; i++) // bodies keep index order inside a cell
+		sortedBodies[cellStart[bodyCell[i]]++] = i;
+	for (int c{ numOfCells }; c > 0; c--) // the fill moved every start to the next cell's
+		cellStart[c] = cellStart[c - 1];
+	cellStart[0] = 0;
+
+	for (int i{ 0 }; i < numOfBodies; i++)
+	{
+		const int cx = bodyCell[i] % cellsX;
+		const int cy = bodyCell[i] / cellsX;
+		for (int ny{ std::max(cy - 1, 0) }; ny <= std::min(cy + 1, cellsY - 1); ny++)
+		{
+			for (int nx{ std::max(cx - 1, 0) }; nx <= std::min(cx + 1, cellsX - 1); nx++)
+			{
+				const int cell = ny * cellsX + nx;
+				for (int k{ cellStart[cell] }; k < cellStart[cell + 1]; k++)
+				{
+					const int j = sortedBodies[k];
+					if (j <= i)
+						continue;
+					float dx = x[j] - x[i];
+					float dy = y[j] - y[i];
+					float reach = radius[i] + radius[j];
+					if (dx * dx + dy * dy >= reach * reach)
+						continue;
+					if (bodyContacts[i] >= SOLVER_MAX_BODY_CONTACTS || bodyContacts[j] >= SOLVER_MAX_BODY_CONTACTS)
+					{
+						droppedContacts++;
+						continue;
+					}
+					bodyContacts[i]++;
+					bodyContacts[j]++;
+					contacts.push_back({ i, j });
+				}
+			}
+		}
+	}
+	// neighbour cells are visited in a fixed order, sorting by pair keeps the order independent of the grid
+	std::sort(contacts.begin(), contacts.end(), [](const SolverContact& c1, const SolverContact& c2)
+	{
+		return c1.a != c2.a ? c1.a < c2.a : c1.b < c2.b;
+	});
+}
+
+int AsteroidSolver::findRoot(int body)
+{
+	while (parent[body] != body)
+	{
+		parent[body] = parent[parent[body]]; // path halving
+		body = parent[body];
+	}
+	return body;
+}
+
+void AsteroidSolver::buildIslands()
+{
+	/*
+	Function joins bodies that touch into islands, the root of an island is its lowest body
+	and islands are numbered in the order of their roots
+	*/
+	parent.resize(numOfBodies);
+	for (int i{ 0 }; i < numOfBodies; i++)
+		parent[i] = i;
+	for (const SolverContact& contact : contacts)
+	{
+		int rootA = findRoot(contact.a);
+		int rootB = findRoot(contact.b);
+		if (rootA != rootB)
+			parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+	}
+
+	islandOf.assign(numOfBodies, -1);
+	for (const SolverContact& contact : contacts)
+		islandOf[findRoot(contact.a)] = 0; // marks the roots
+	numOfIslands = 0;
+	for (int i{ 0 }; i < numOfBodies; i++)
+		if (islandOf[i] == 0)
+			islandOf[i] = ++numOfIslands; // numbered from 1 while marking
+	for (int i{ 0 }; i < numOfBodies; i++)
+		if (islandOf[i] > 0)
+			islandOf[i]--;
+
+	// contacts grouped by island with a counting sort, each island keeps the contact order
+	islandStart.assign(numOfIslands + 1, 0);
+	for (const SolverContact& contact : contacts)
+		islandStart[islandOf[findRoot(contact.a)] + 1]++;
+	for (int island{ 0 }; island < numOfIslands; island++)
+	{
+		largestIsland = std::max(largestIsland, islandStart[island + 1]);
+		islandStart[island + 1] += islandStart[island];
+	}
+	islandContacts.resize(contacts.size());
+	std::vector<int>& fill = bodyCell; // free again after the broadphase
+	fill.assign(islandStart.begin(), islandStart.end() - 1);
+	for (int c{ 0 }; c < static_cast<int>(contacts.size()); c++)
+		islandContacts[fill[islandOf[findRoot(contacts[c].a)]]++] = c;
+}
+
+void AsteroidSolver::solveIslands()
+{
+	nextChunk = 0;
+	if (!workers.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			workersDone = 0;
+			solveId++;
+		}
+		workCondition.notify_all();
+	}
+
+	const int numOfChunks = (numOfIslands + SOLVER_ISLAND_CHUNK - 1) / SOLVER_ISLAND_CHUNK;
+	int chunk;
+	while ((chunk = nextChunk.fetch_add(1)) < numOfChunks)
+	{
+		const int last = std::min((chunk + 1) * SOLVER_ISLAND_CHUNK, numOfIslands);
+		for (int island{ chunk * SOLVER_ISLAND_CHUNK }; island < last; island++)
+			solveIsland(island);
+	}
+
+	if (!workers.empty())
+	{
+		std::unique_lock<std::mutex> lock(workMutex);
+		doneCondition.wait(lock, [this] { return workersDone == static_cast<int>(workers.size()); });
+	}
+}
+
+void AsteroidSolver::solveIsland(const int island)
+{
+	/*
+	Function applies the elastic impulse to every approaching contact of the island, a few
+	times so chains of bodies pass the momentum on, then pushes the overlapping bodies apart
+	in proportion to their inverse masses, again a few times for piles
+	*/
+	const int first = islandStart[island];
+	const int last = islandStart[island + 1];
+
+	for (int iteration{ 0 }; iteration < SOLVER_ITERATIONS; iteration++)
+	{
+		for (int k{ first }; k < last; k++)
+		{
+			const SolverContact& contact = contacts[islandContacts[k]];
+			const int a = contact.a, b = contact.b;
+			float dx = x[b] - x[a];
+			float dy = y[b] - y[a];
+			float distance = std::sqrt(dx * dx + dy * dy);
+			float nx = distance > 1e-4f ? dx / distance : 1.f;
+			float ny = distance > 1e-4f ? dy / distance : 0.f;
+
+			float approach = (vx[b] - vx[a]) * nx + (vy[b] - vy[a]) * ny;
+			float inverseMassSum = inverseMass[a] + inverseMass[b];
+			if (approach >= 0.f || inverseMassSum <= 0.f)
+				continue;
+			float impulse = -(1.f + SOLVER_RESTITUTION) * approach / inverseMassSum;
+			vx[a] -= impulse * inverseMass[a] * nx;
+			vy[a] -= impulse * inverseMass[a] * ny;
+			vx[b] += impulse * inverseMass[b] * nx;
+			vy[b] += impulse * inverseMass[b] * ny;
+		}
+	}
+
+	for (int iteration{ 0 }; iteration < SOLVER_ITERATIONS; iteration++)
+	{
+		for (int k{ first }; k < last; k++)
+		{
+			const SolverContact& contact = contacts[islandContacts[k]];
+			const int a = contact.a, b = contact.b;
+			float dx = x[b] - x[a];
+			float dy = y[b] - y[a];
+			float distance = std::sqrt(dx * dx + dy * dy);
+			float overlap = radius[a] + radius[b] - distance - SOLVER_SLOP;
+			float inverseMassSum = inverseMass[a] + inverseMass[b];
+			if (overlap <= 0.f || inverseMassSum <= 0.f)
+				continue;
+			float nx = distance > 1e-4f ? dx / distance : 1.f;
+			float ny = distance > 1e-4f ? dy / distance : 0.f;
+			float push = SOLVER_POSITION_CORRECTION * overlap / inverseMassSum;
+			x[a] -= push * inverseMass[a] * nx;
+			y[a] -= push * inverseMass[a] * ny;
+			x[b] += push * inverseMass[b] * nx;
+			y[b] += push * inverseMass[b] * ny;
+		}
+	}
+}
+
+void AsteroidSolver::workerLoop()
+{
+	int lastSolve = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(workMutex);
+			workCondition.wait(lock, [&] { return stopWorkers || solveId != lastSolve; });
+			if (stopWorkers)
+				return;
+			lastSolve = solveId;
+		}
+
+		const int numOfChunks = (numOfIslands + SOLVER_ISLAND_CHUNK - 1) / SOLVER_ISLAND_CHUNK;
+		int chunk;
+		while ((chunk = nextChunk.fetch_add(1)) < numOfChunks)
+		{
+			const int last = std::min((chunk + 1) * SOLVER_ISLAND_CHUNK, numOfIslands);
+			for (int island{ chunk * SOLVER_ISLAND_CHUNK }; island < last; island++)
+				solveIsland(island);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			workersDone++;
+		}
+		doneCondition.notify_one();
+	}
+}
+
+// G&S
+int AsteroidSolver::getNumOfContacts() const
+{
+	return static_cast<int>(contacts.size());
+}
+
+int AsteroidSolver::getNumOfDroppedContacts() const
+{
+	return droppedContacts;
+}
+
+int AsteroidSolver::getNumOfIslands() const
+{
+	return numOfIslands;
+}
+
+int AsteroidSolver::getLargestIsland() const
+{
+	return largestIsland;
+}
+
+int AsteroidSolver::getNumOfThreads() const
+{
+	return static_cast<int>(workers.size()) + 1;
+}
+
+int AsteroidSolver::runBenchmark(int argc, char* argv[])
+{
+	SimScene scene;
+	scene.numOfAsteroids = SOLVER_BENCHMARK_ASTEROIDS;
+	scene.numOfBullets = 0;
+	int steps = SOLVER_BENCHMARK_STEPS;
+	int threads = 0;
+	try
+	{
+		if (argc > 0) scene.numOfAsteroids = std::stoi(argv[0]);
+		if (argc > 1) steps = std::stoi(argv[1]);
+		if (argc > 2) threads = std::stoi(argv[2]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-asteroid-collisions [asteroids] [steps] [threads]\n";
+		return 1;
+	}
+
+	std::uint64_t checksums[2];
+	for (int run{ 0 }; run < 2; run++)
+	{
+		SimWorld world{ scene };
+		AsteroidSolver solver{ run == 0 ? 1 : threads };
+		const int n = world.getNumOfAsteroids();
+		solver.reserve(n);
+		solver.resize(n);
+		long long contactSum = 0, islandSum = 0, droppedSum = 0;
+		int largestIsland = 0;
+		double solveSeconds = 0;
+
+		// SimWorld asteroids have the game's sizes, thousands of them would not fit the field,
+		// so they are shrunk until they cover SOLVER_BENCHMARK_COVERAGE of it
+		const float fieldArea = (SIM_FIELD_MAX - SIM_FIELD_MIN) * (SIM_FIELD_MAX - SIM_FIELD_MIN);
+		const float radius = GameRules::asteroidBounds(sf::Vector2f(0.f, 0.f)).width / 2;
+		const float radiusScale = std::min(1.f, std::sqrt(SOLVER_BENCHMARK_COVERAGE * fieldArea
+			/ (n * 3.14159265f * radius * radius)));
+
+		for (int step{ 0 }; step < steps; step++)
+		{
+			FloatIntegration::integrate(world, SIM_TICK_MS);
+
+			auto start = std::chrono::steady_clock::now();
+			std::copy(world.asteroidX.begin(), world.asteroidX.begin() + n, solver.x.begin());
+			std::copy(world.asteroidY.begin(), world.asteroidY.begin() + n, solver.y.begin());
+			for (int i{ 0 }; i < n; i++)
+			{
+				solver.vx[i] = world.asteroidSpeed[i] * world.asteroidDirectionX[i];
+				solver.vy[i] = world.asteroidSpeed[i] * world.asteroidDirectionY[i];
+				solver.radius[i] = world.asteroidRadius[i] * radiusScale;
+				solver.inverseMass[i] = 1.f / GameRules::asteroidMass(world.asteroidLevel[i]);
+			}
+			solver.solve();
+			std::copy(solver.x.begin(), solver.x.end(), world.asteroidX.begin());
+			std::copy(solver.y.begin(), solver.y.end(), world.asteroidY.begin());
+			for (int i{ 0 }; i < n; i++) // like Game::resolveAsteroidCollisions
+				if (solver.vx[i] != world.asteroidSpeed[i] * world.asteroidDirectionX[i] || solver.vy[i] != world.asteroidSpeed[i] * world.asteroidDirectionY[i])
+					world.setVelocity(i, solver.vx[i], solver.vy[i]);
+			solveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			contactSum += solver.getNumOfContacts();
+			droppedSum += solver.getNumOfDroppedContacts();
+			islandSum += solver.getNumOfIslands();
+			largestIsland = std::max(largestIsland, solver.getLargestIsland());
+		}
+		checksums[run] = world.getChecksum();
+
+		std::cout << n << " asteroids, " << steps << " steps, " << solver.getNumOfThreads() << " threads: "
+			<< 1000.0 * solveSeconds / steps << " ms per step, " << contactSum / steps << " contacts and "
+			<< islandSum / steps << " islands per step, largest island " << largestIsland << " contacts, " << droppedSum << " dropped, checksum "
+			<< std::hex << checksums[run] << std::dec << "\n";
+	}
+	std::cout << (checksums[0] == checksums[1] ? "same state on every thread count\n" : "STATE DIFFERS BETWEEN THREAD COUNTS\n");
+	return checksums[0] == checksums[1] ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#define SOLVER_ITERATIONS 4				// velocity passes over the contacts of an island
+#define SOLVER_RESTITUTION 1.f			// elastic
+#define SOLVER_POSITION_CORRECTION 0.8f	// share of the overlap removed per tick
+#define SOLVER_SLOP 0.5f				// pixels of overlap that are left alone, so resting contacts do not jitter
+#define SOLVER_MAX_GRID_CELLS 256		// per side, cells grow when the bodies are spread wider
+#define SOLVER_MAX_BODY_CONTACTS 8		// per body and tick, packed circles touch six, piled up spawns overlap more
+#define SOLVER_ISLAND_CHUNK 8			// islands a thread takes at a time
+#define SOLVER_MAX_THREADS 64
+#define SOLVER_BENCHMARK_ASTEROIDS 2000
+#define SOLVER_BENCHMARK_STEPS 600
+#define SOLVER_BENCHMARK_COVERAGE 0.35f	// share of the field the benchmark asteroids cover
+
+struct SolverContact
+{
+	int a, b; // body indices, a < b
+};
+
+class AsteroidSolver
+{
+	/*
+	Elastic collisions between circular bodies. A uniform grid finds the overlapping pairs, pairs that
+	share a body are joined into islands (union find) and every island is solved on its own with
+	sequential impulses, then pushed apart. Islands are handed to the worker threads in chunks;
+	they share no bodies and every island is solved in the same order whatever thread takes it,
+	so the result does not depend on the number of threads
+	*/
+public:
+	AsteroidSolver(const int _numOfThreads = 1);
+	~AsteroidSolver();
+	AsteroidSolver(const AsteroidSolver&) = delete;
+	AsteroidSolver& operator=(const AsteroidSolver&) = delete;
+
+	// Bodies, filled in by the caller before solve()
+	std::vector<float> x, y, vx, vy;
+	std::vector<float> radius;
+	std::vector<float> inverseMass;
+
+private:
+	int numOfBodies = 0;
+
+	// Broadphase
+	float gridMinX = 0.f, gridMinY = 0.f, cellSize = 1.f;
+	int cellsX = 1, cellsY = 1;
+	std::vector<int> cellStart;
+	std::vector<int> bodyCell;
+	std::vector<int> sortedBodies;
+	std::vector<SolverContact> contacts;
+	std::vector<int> bodyContacts;		// contacts of every body so far, capped at SOLVER_MAX_BODY_CONTACTS
+	int droppedContacts = 0;
+
+	// Islands
+	std::vector<int> parent;
+	std::vector<int> islandOf;			// per root body, -1 without contacts
+	std::vector<int> islandStart;		// into islandContacts
+	std::vector<int> islandContacts;	// contact indices grouped by island, in contact order
+	int numOfIslands = 0;
+	int largestIsland = 0;
+
+	// Workers
+	std::vector<std::thread> workers;
+	std::mutex workMutex;
+	std::condition_variable workCondition;
+	std::condition_variable doneCondition;
+	int solveId = 0;
+	int workersDone = 0;
+	bool stopWorkers = false;
+	std::atomic<int> nextChunk{ 0 };
+
+public:
+	void resize(const int _numOfBodies);
+	void reserve(const int maxBodies); // solving that many bodies does not allocate
+	void solve();
+
+	// G&S
+	int getNumOfContacts() const;
+	int getNumOfDroppedContacts() const; // past the cap in the last solve, they are solved once the pile spreads
+	int getNumOfIslands() const;
+	int getLargestIsland() const;	// contacts
+	int getNumOfThreads() const;
+
+	// Runs a dense SimWorld scene on one thread and on the given number of threads,
+	// prints the time per step and whether both runs ended in the same state.
+	// Arguments: [asteroids] [steps] [threads]
+	static int runBenchmark(int argc, char* argv[]);
+
+private:
+	void findContacts();
+	void buildIslands();
+	void solveIslands();
+	void solveIsland(const int island);
+	int findRoot(int body);
+	void workerLoop();
+};
@@ -0,0 +1,94 @@
+#include "Autopilot.h"
+#include <cmath>
+
+autopilotMode Autopilot::decide(const AsteroidIndex& index, const ShipState& ship, PlayerInput& input) const
+{
+	/*
+	Function fills input with the controls for this tick and returns what it is doing
+	*/
+	input = PlayerInput();
+	Neighbour neighbours[AUTOPILOT_NEIGHBOURS];
+	const int found = index.findNearest(ship.x, ship.y, AUTOPILOT_NEIGHBOURS, neighbours);
+
+	// Threats: closest approach of every neighbour, the ship only moves while thrusting so it counts as still.
+	// Every threat pushes the escape direction away from where it passes, the sooner the harder
+	float escapeX = 0, escapeY = 0;
+	float threatTime = AUTOPILOT_DODGE_HORIZON_MS;
+	for (int i{ 0 }; i < found; i++)
+	{
+		const IndexedAsteroid& asteroid = *neighbours[i].asteroid;
+		const float dx = asteroid.x - ship.x;
+		const float dy = asteroid.y - ship.y;
+		const float speedSquared = asteroid.vx * asteroid.vx + asteroid.vy * asteroid.vy;
+		const float closestTime = speedSquared > 0 ? std::fmax(0.f, -(dx * asteroid.vx + dy * asteroid.vy) / speedSquared) : 0.f;
+		float closestX = dx + asteroid.vx * closestTime;
+		float closestY = dy + asteroid.vy * closestTime;
+		const float closestSquared = closestX * closestX + closestY * closestY;
+		const float reach = asteroid.radius + ship.radius + AUTOPILOT_SAFE_DISTANCE;
+
+		if (closestTime < AUTOPILOT_DODGE_HORIZON_MS && closestSquared < reach * reach)
+		{
+			if (closestSquared < 1.f) // straight at the ship, sideways
+			{
+				closestX = asteroid.vy;
+				closestY = -asteroid.vx;
+			}
+			const float weight = (1 - closestTime / AUTOPILOT_DODGE_HORIZON_MS) / std::sqrt(std::fmax(closestSquared, 1.f));
+			escapeX -= weight * closestX;
+			escapeY -= weight * closestY;
+			threatTime = std::fmin(threatTime, closestTime);
+		}
+	}
+
+	// Target: the neighbour a bullet fired now reaches first
+	float targetTime = AUTOPILOT_MAX_SHOT_MS;
+	float aimX = 0, aimY = 0;
+	bool hasTarget = false;
+	for (int i{ 0 }; i < found; i++)
+	{
+		float time, x, y;
+		if (AsteroidIndex::intercept(ship.x, ship.y, AUTOPILOT_BULLET_SPEED, *neighbours[i].asteroid, time, x, y) && time < targetTime)
+		{
+			targetTime = time;
+			aimX = x;
+			aimY = y;
+			hasTarget = true;
+		}
+	}
+
+	if (hasTarget)
+	{
+		const float heading = headingTo(aimX - ship.x, aimY - ship.y);
+		const float aimError = std::fabs(std::fmod(heading - ship.rotation + 540.f, 360.f) - 180.f);
+		input.fire = ship.canShoot && aimError < AUTOPILOT_AIM_TOLERANCE;
+	}
+
+	if (threatTime < AUTOPILOT_DODGE_HORIZON_MS)
+	{
+		const float heading = headingTo(escapeX, escapeY);
+		steer(ship.rotation, heading, input);
+		input.thrust = std::fabs(std::fmod(heading - ship.rotation + 540.f, 360.f) - 180.f) < AUTOPILOT_THRUST_ANGLE;
+		return AUTOPILOT_DODGE;
+	}
+	if (hasTarget)
+	{
+		steer(ship.rotation, headingTo(aimX - ship.x, aimY - ship.y), input);
+		return AUTOPILOT_HUNT;
+	}
+	return AUTOPILOT_IDLE;
+}
+
+float Autopilot::headingTo(const float dx, const float dy)
+{
+	/*
+	Function returns the sprite rotation (degrees, 0 is up, clockwise) that points along (dx,dy)
+	*/
+	return std::atan2(dx, -dy) * 180.f / 3.14159265f;
+}
+
+void Autopilot::steer(const float rotation, const float heading, PlayerInput& input)
+{
+	const float error = std::fmod(heading - rotation + 540.f, 360.f) - 180.f; // -180 .. 180, positive is clockwise
+	input.rotateRight = error > AUTOPILOT_AIM_TOLERANCE / 2;
+	input.rotateLeft = error < -AUTOPILOT_AIM_TOLERANCE / 2;
+}
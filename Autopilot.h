@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AsteroidIndex.h"
+
+#define AUTOPILOT_NEIGHBOURS 8				// asteroids looked at every tick
+#define AUTOPILOT_DODGE_HORIZON_MS 700.f	// threats further away in time are ignored
+#define AUTOPILOT_SAFE_DISTANCE 25.f		// extra space kept around the ship
+#define AUTOPILOT_THRUST_ANGLE 60.f		// degrees, dodges with thrust once the nose is this close to the escape heading
+#define AUTOPILOT_AIM_TOLERANCE 4.f			// degrees, fires when the gun is this close to the aim point
+#define AUTOPILOT_MAX_SHOT_MS 1500.f		// targets that take longer to reach are not shot at
+#define AUTOPILOT_BULLET_SPEED 0.40f		// as in Player::moveBullets
+
+// The controls of the ship, what the arrow keys and Space do
+struct PlayerInput
+{
+	bool rotateLeft = false;
+	bool rotateRight = false;
+	bool thrust = false;
+	bool fire = false;
+};
+
+struct ShipState
+{
+	float x, y;
+	float rotation;	// degrees, 0 points up, like sf::Sprite
+	float radius;
+	bool canShoot;
+};
+
+// Autopilot Mode, what the last decision was about
+enum autopilotMode
+{
+	AUTOPILOT_IDLE,		// nothing in reach
+	AUTOPILOT_HUNT,		// turning to and shooting at the nearest interceptable asteroid
+	AUTOPILOT_DODGE,	// flying away from an asteroid on a collision course
+	NUMBER_OF_AUTOPILOT_MODES
+};
+
+class Autopilot
+{
+	/*
+	Plays the ship from a spatial index of the asteroids. Every tick it looks at the
+	k nearest asteroids: while any of them is on a collision course within the dodge horizon the ship
+	flies away from where they pass, otherwise the ship turns towards the intercept point of the fastest target and fires once aligned.
+	It has no state of its own, one autopilot can drive any number of ships
+	*/
+public:
+	autopilotMode decide(const AsteroidIndex& index, const ShipState& ship, PlayerInput& input) const;
+
+private:
+	static float headingTo(const float dx, const float dy);
+	static void steer(const float rotation, const float heading, PlayerInput& input);
+};
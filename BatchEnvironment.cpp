@@ -0,0 +1,456 @@
+#include "BatchEnvironment.h"
+#include "TimerWheel.h"
+#include "FixedMath.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+BatchEnvironment::BatchEnvironment(const int _numOfEnvs, const int _numOfThreads, const std::uint32_t _seed)
+	:
+	numOfEnvs{ _numOfEnvs },
+	seed{ _seed },
+	solver{ 1 }
+{
+	shipX.resize(numOfEnvs); shipY.resize(numOfEnvs); shipRotation.resize(numOfEnvs);
+	health.resize(numOfEnvs); score.resize(numOfEnvs); reloadTicks.resize(numOfEnvs);
+	thrustTicks.resize(numOfEnvs); episodeTicks.resize(numOfEnvs); episodes.resize(numOfEnvs);
+	random.resize(numOfEnvs);
+
+	const size_t asteroidSlots = static_cast<size_t>(numOfEnvs) * ENV_MAX_ASTEROIDS;
+	asteroidX.resize(asteroidSlots); asteroidY.resize(asteroidSlots);
+	asteroidSpeed.resize(asteroidSlots); asteroidDirectionX.resize(asteroidSlots); asteroidDirectionY.resize(asteroidSlots);
+	asteroidLevel.resize(asteroidSlots); asteroidTouching.resize(asteroidSlots);
+	numOfAsteroids.resize(numOfEnvs);
+
+	const size_t bulletSlots = static_cast<size_t>(numOfEnvs) * ENV_MAX_BULLETS;
+	bulletX.resize(bulletSlots); bulletY.resize(bulletSlots); bulletAngle.resize(bulletSlots);
+	bulletActive.resize(bulletSlots);
+
+	observations.resize(static_cast<size_t>(numOfEnvs) * ENV_OBSERVATION_SIZE);
+	rewards.resize(numOfEnvs);
+	dones.resize(numOfEnvs);
+
+	int numOfThreads = _numOfThreads > 0 ? _numOfThreads : static_cast<int>(std::thread::hardware_concurrency());
+	numOfThreads = std::max(1, std::min(numOfThreads, ENV_MAX_THREADS));
+	solver.reserve(ENV_MAX_ASTEROIDS);
+	for (int i{ 1 }; i < numOfThreads; i++) // the calling thread steps environments too
+		workers.emplace_back(&BatchEnvironment::workerLoop, this);
+
+	reset();
+}
+
+BatchEnvironment::~BatchEnvironment()
+{
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		stopWorkers = true;
+	}
+	workCondition.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void BatchEnvironment::reset()
+{
+	/*
+	Function starts a new episode in every environment, the generators start from the seed again
+	*/
+	for (int env{ 0 }; env < numOfEnvs; env++)
+	{
+		random[env] = CounterRandom(seed, static_cast<std::uint64_t>(env));
+		episodes[env] = 0;
+		resetEnv(env);
+		observe(env);
+		rewards[env] = 0.f;
+		dones[env] = 0;
+	}
+}
+
+void BatchEnvironment::step(const std::uint8_t* _actions)
+{
+	/*
+	Function advances every environment by one tick with actions[env] (envAction bits)
+	and returns once all of them are done
+	*/
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		actions = _actions;
+		nextChunk = 0;
+		workersDone = 0;
+		stepId++;
+	}
+	workCondition.notify_all();
+
+	stepChunks(solver);
+
+	std::unique_lock<std::mutex> lock(workMutex);
+	doneCondition.wait(lock, [this] { return workersDone == static_cast<int>(workers.size()); });
+}
+
+// G&S
+int BatchEnvironment::getNumOfEnvs() const
+{
+	return numOfEnvs;
+}
+
+const float* BatchEnvironment::getObservations() const
+{
+	return observations.data();
+}
+
+const float* BatchEnvironment::getRewards() const
+{
+	return rewards.data();
+}
+
+const std::uint8_t* BatchEnvironment::getDones() const
+{
+	return dones.data();
+}
+
+int BatchEnvironment::getEpisodes(const int env) const
+{
+	return episodes[env];
+}
+
+int BatchEnvironment::runBenchmark(int argc, char* argv[])
+{
+	int envs = ENV_BENCHMARK_ENVS;
+	int steps = ENV_BENCHMARK_STEPS;
+	int threads = 0;
+	try
+	{
+		if (argc > 0) envs = std::stoi(argv[0]);
+		if (argc > 1) steps = std::stoi(argv[1]);
+		if (argc > 2) threads = std::stoi(argv[2]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-batch [envs] [steps] [threads]\n";
+		return 1;
+	}
+
+	BatchEnvironment batch{ envs, threads };
+	std::vector<std::uint8_t> batchActions(envs);
+	std::uint32_t state = 12345;
+	double rewardSum = 0;
+	long long finished = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int step{ 0 }; step < steps; step++)
+	{
+		for (auto& action : batchActions) // random actions, held for a few ticks like a player would
+		{
+			state = state * 1664525u + 1013904223u;
+			if ((state >> 28) < 4)
+				action = static_cast<std::uint8_t>(state >> 20) & 15;
+		}
+		batch.step(batchActions.data());
+		for (int env{ 0 }; env < envs; env++)
+		{
+			rewardSum += batch.getRewards()[env];
+			finished += batch.getDones()[env];
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << envs << " environments, " << steps << " steps, " << batch.workers.size() + 1 << " threads\n";
+	std::cout << "  " << static_cast<long long>(static_cast<double>(envs) * steps / seconds) << " ticks per second ("
+		<< 1000.0 * seconds / steps << " ms per batch step)\n";
+	std::cout << "  " << finished << " episodes finished, " << rewardSum << " score\n";
+	return 0;
+}
+
+void BatchEnvironment::workerLoop()
+{
+	AsteroidSolver threadSolver{ 1 };
+	threadSolver.reserve(ENV_MAX_ASTEROIDS);
+	int lastStep = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(workMutex);
+			workCondition.wait(lock, [&] { return stopWorkers || stepId != lastStep; });
+			if (stopWorkers)
+				return;
+			lastStep = stepId;
+		}
+
+		stepChunks(threadSolver);
+
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			workersDone++;
+		}
+		doneCondition.notify_one();
+	}
+}
+
+void BatchEnvironment::stepChunks(AsteroidSolver& threadSolver)
+{
+	const int numOfChunks = (numOfEnvs + ENV_CHUNK_SIZE - 1) / ENV_CHUNK_SIZE;
+	int chunk;
+	while ((chunk = nextChunk.fetch_add(1)) < numOfChunks)
+	{
+		const int last = std::min((chunk + 1) * ENV_CHUNK_SIZE, numOfEnvs);
+		for (int env{ chunk * ENV_CHUNK_SIZE }; env < last; env++)
+			stepEnv(env, actions[env], threadSolver);
+	}
+}
+
+void BatchEnvironment::stepEnv(const int env, const std::uint8_t action, AsteroidSolver& threadSolver)
+{
+	/*
+	Function plays one tick of the game: Game::handleGameInput, updateGame, checkForCollision
+	and isGameOver, by the GameRules Player and Asteroid play by
+	*/
+	const float dt = SIM_TICK_MS;
+	const bool fixedPoint = FixedMath::isEnabled();
+	const int scoreBefore = score[env];
+	const ShipControls controls = ShipControls::fromAction(action);
+
+	// Ship, the thrust starts with 0 ms and no boost like Player::startRocketThrustTimer
+	sf::Vector2f shipPosition(shipX[env], shipY[env]);
+	GameRules::steerShip(shipPosition, shipRotation[env], controls, thrustTicks[env] * dt, dt, fixedPoint);
+	shipX[env] = shipPosition.x;
+	shipY[env] = shipPosition.y;
+	thrustTicks[env] = controls.thrust > 0.f ? thrustTicks[env] + 1 : 0;
+
+	// Shooting, the gun reloads for RULES_RELOAD_MS like the shot timer of Player
+	float* bx = &bulletX[static_cast<size_t>(env) * ENV_MAX_BULLETS];
+	float* by = &bulletY[static_cast<size_t>(env) * ENV_MAX_BULLETS];
+	float* angle = &bulletAngle[static_cast<size_t>(env) * ENV_MAX_BULLETS];
+	std::uint8_t* active = &bulletActive[static_cast<size_t>(env) * ENV_MAX_BULLETS];
+	if (reloadTicks[env] > 0)
+		reloadTicks[env]--;
+	if (controls.fire && reloadTicks[env] == 0)
+	{
+		for (int b{ 0 }; b < ENV_MAX_BULLETS; b++)
+		{
+			if (!active[b])
+			{
+				active[b] = 1;
+				bx[b] = shipX[env];
+				by[b] = shipY[env];
+				angle[b] = shipRotation[env];
+				reloadTicks[env] = msToTicks(RULES_RELOAD_MS);
+				break;
+			}
+		}
+	}
+
+	// Movement
+	for (int b{ 0 }; b < ENV_MAX_BULLETS; b++)
+	{
+		if (!active[b])
+			continue;
+		sf::Vector2f moved = GameRules::moveBullet(sf::Vector2f(bx[b], by[b]), angle[b], dt, fixedPoint);
+		bx[b] = moved.x;
+		by[b] = moved.y;
+		if (GameRules::isOffScreen(moved))
+			active[b] = 0;
+	}
+
+	const size_t first = static_cast<size_t>(env) * ENV_MAX_ASTEROIDS;
+	for (int i{ 0 }; i < numOfAsteroids[env]; i++)
+	{
+		const size_t a = first + i;
+		sf::Vector2f moved = GameRules::moveAsteroid(sf::Vector2f(asteroidX[a], asteroidY[a]), asteroidSpeed[a],
+			sf::Vector2f(asteroidDirectionX[a], asteroidDirectionY[a]), dt, fixedPoint);
+		asteroidX[a] = moved.x;
+		asteroidY[a] = moved.y;
+	}
+	bounceAsteroids(env, threadSolver);
+
+	// Collision, the contacts of Game::checkForCollision: the ship is hurt when a contact begins,
+	// a bullet is spent on the first asteroid it touches and an asteroid breaks once per tick
+	const sf::FloatRect shipBounds = GameRules::shipBounds(sf::Vector2f(shipX[env], shipY[env]), shipRotation[env]);
+	for (int i{ 0 }; i < numOfAsteroids[env]; i++)
+	{
+		const size_t a = first + i;
+		if (GameRules::overlaps(shipBounds, GameRules::asteroidBounds(sf::Vector2f(asteroidX[a], asteroidY[a])), false))
+		{
+			if (!asteroidTouching[a] && health[env] > 0)
+				health[env]--;
+			asteroidTouching[a] = 1;
+		}
+		else
+			asteroidTouching[a] = 0;
+	}
+
+	int hitAsteroids[ENV_MAX_BULLETS]; // found before any asteroid breaks, like the contacts of the game
+	for (int b{ 0 }; b < ENV_MAX_BULLETS; b++)
+	{
+		hitAsteroids[b] = -1;
+		if (!active[b])
+			continue;
+		const sf::FloatRect bounds = GameRules::bulletBounds(sf::Vector2f(bx[b], by[b]), angle[b]);
+		for (int i{ 0 }; i < numOfAsteroids[env] && hitAsteroids[b] == -1; i++)
+			if (GameRules::overlaps(bounds, GameRules::asteroidBounds(sf::Vector2f(asteroidX[first + i], asteroidY[first + i])), false))
+				hitAsteroids[b] = i;
+	}
+
+	int deadAsteroid = -1;
+	int brokenAsteroids[ENV_MAX_BULLETS];
+	int numOfBroken = 0;
+	for (int b{ 0 }; b < ENV_MAX_BULLETS; b++)
+	{
+		const int i = hitAsteroids[b];
+		if (i == -1)
+			continue;
+		active[b] = 0;
+		if (std::find(brokenAsteroids, brokenAsteroids + numOfBroken, i) != brokenAsteroids + numOfBroken)
+			continue; // the asteroid already broke, the bullet still hit it
+		const size_t a = first + i;
+		score[env] += GameRules::hitScore(asteroidLevel[a]);
+		initializeAsteroid(env, i, asteroidLevel[a] == 1 ? 0 : 1); // Asteroid::downSize
+		brokenAsteroids[numOfBroken++] = i;
+		deadAsteroid = i;
+	}
+	if (deadAsteroid != -1) // at most one new asteroid per tick, like Game::checkForCollision
+		addAsteroid(env, 0, asteroidX[first + deadAsteroid], asteroidY[first + deadAsteroid]);
+
+	// Game over
+	rewards[env] = static_cast<float>(score[env] - scoreBefore);
+	dones[env] = health[env] <= 0 || ++episodeTicks[env] >= ENV_MAX_EPISODE_TICKS;
+	if (dones[env])
+	{
+		episodes[env]++;
+		resetEnv(env);
+	}
+	observe(env);
+}
+
+void BatchEnvironment::bounceAsteroids(const int env, AsteroidSolver& threadSolver)
+{
+	/*
+	Function lets the asteroids of an environment bounce off each other, like Game::resolveAsteroidCollisions
+	*/
+	const size_t first = static_cast<size_t>(env) * ENV_MAX_ASTEROIDS;
+	const int n = numOfAsteroids[env];
+	threadSolver.resize(n);
+	for (int i{ 0 }; i < n; i++)
+	{
+		const size_t a = first + i;
+		threadSolver.x[i] = asteroidX[a];
+		threadSolver.y[i] = asteroidY[a];
+		threadSolver.vx[i] = asteroidSpeed[a] * asteroidDirectionX[a];
+		threadSolver.vy[i] = asteroidSpeed[a] * asteroidDirectionY[a];
+		threadSolver.radius[i] = GameRules::asteroidBounds(sf::Vector2f(asteroidX[a], asteroidY[a])).width / 2;
+		threadSolver.inverseMass[i] = 1.f / GameRules::asteroidMass(asteroidLevel[a]);
+	}
+
+	threadSolver.solve();
+	if (threadSolver.getNumOfContacts() == 0)
+		return;
+
+	for (int i{ 0 }; i < n; i++) // a changed velocity is set like Asteroid::setVelocity
+	{
+		const size_t a = first + i;
+		asteroidX[a] = threadSolver.x[i];
+		asteroidY[a] = threadSolver.y[i];
+		if (threadSolver.vx[i] != asteroidSpeed[a] * asteroidDirectionX[a] || threadSolver.vy[i] != asteroidSpeed[a] * asteroidDirectionY[a])
+		{
+			asteroidSpeed[a] = 1.f;
+			asteroidDirectionX[a] = threadSolver.vx[i];
+			asteroidDirectionY[a] = threadSolver.vy[i];
+		}
+	}
+}
+
+void BatchEnvironment::resetEnv(const int env)
+{
+	/*
+	Function does what Game::setupGame does for one environment
+	*/
+	shipX[env] = RULES_SCREEN_SIZE / 2;
+	shipY[env] = RULES_SCREEN_SIZE / 2;
+	shipRotation[env] = 0.f;
+	health[env] = ENV_START_HEALTH;
+	score[env] = 0;
+	reloadTicks[env] = 0;
+	thrustTicks[env] = 0;
+	episodeTicks[env] = 0;
+
+	numOfAsteroids[env] = 0;
+	for (int i{ 0 }; i < ENV_START_ASTEROIDS; i++)
+		addAsteroid(env, 1, 0.f, 0.f);
+	for (int b{ 0 }; b < ENV_MAX_BULLETS; b++)
+		bulletActive[static_cast<size_t>(env) * ENV_MAX_BULLETS + b] = 0;
+}
+
+void BatchEnvironment::initializeAsteroid(const int env, const int slot, const int level)
+{
+	/*
+	Function rolls the asteroid in a slot like Asteroid::intializeAsteroid, a large one is also placed anew
+	*/
+	const size_t a = static_cast<size_t>(env) * ENV_MAX_ASTEROIDS + slot;
+	sf::Vector2f direction;
+	sf::Vector2f position(asteroidX[a], asteroidY[a]);
+	GameRules::rollAsteroid(level, random[env], asteroidSpeed[a], direction, position);
+	asteroidX[a] = position.x;
+	asteroidY[a] = position.y;
+	asteroidDirectionX[a] = direction.x;
+	asteroidDirectionY[a] = direction.y;
+	asteroidLevel[a] = static_cast<std::uint8_t>(level);
+}
+
+void BatchEnvironment::addAsteroid(const int env, const int level, const float x, const float y)
+{
+	if (numOfAsteroids[env] >= ENV_MAX_ASTEROIDS)
+		return;
+	const int slot = numOfAsteroids[env]++;
+	const size_t a = static_cast<size_t>(env) * ENV_MAX_ASTEROIDS + slot;
+	asteroidX[a] = x;
+	asteroidY[a] = y;
+	asteroidTouching[a] = 0;
+	initializeAsteroid(env, slot, level);
+}
+
+void BatchEnvironment::observe(const int env)
+{
+	/*
+	Function writes the observation row of an environment, see ENV_OBSERVATION_SIZE.
+	The ENV_OBSERVED_ASTEROIDS nearest asteroids are shown, ties go to the lower slot
+	*/
+	float* row = &observations[static_cast<size_t>(env) * ENV_OBSERVATION_SIZE];
+	row[0] = shipX[env] / RULES_SCREEN_SIZE;
+	row[1] = shipY[env] / RULES_SCREEN_SIZE;
+	row[2] = std::sin(shipRotation[env] * 3.14159265f / 180);
+	row[3] = std::cos(shipRotation[env] * 3.14159265f / 180);
+	row[4] = static_cast<float>(health[env]) / ENV_START_HEALTH;
+	row[5] = reloadTicks[env] == 0 ? 1.f : 0.f;
+
+	const size_t first = static_cast<size_t>(env) * ENV_MAX_ASTEROIDS;
+	const int n = numOfAsteroids[env];
+	float distances[ENV_MAX_ASTEROIDS];
+	int nearest[ENV_MAX_ASTEROIDS];
+	for (int i{ 0 }; i < n; i++)
+	{
+		const float dx = asteroidX[first + i] - shipX[env];
+		const float dy = asteroidY[first + i] - shipY[env];
+		distances[i] = dx * dx + dy * dy;
+		nearest[i] = i;
+	}
+	const int observed = std::min(n, ENV_OBSERVED_ASTEROIDS);
+	std::partial_sort(nearest, nearest + observed, nearest + n, [&](const int i, const int j)
+		{ return distances[i] < distances[j] || (distances[i] == distances[j] && i < j); });
+
+	float* slot = row + ENV_SHIP_FEATURES;
+	for (int k{ 0 }; k < ENV_OBSERVED_ASTEROIDS; k++, slot += ENV_ASTEROID_FEATURES)
+	{
+		if (k < observed)
+		{
+			const size_t a = first + nearest[k];
+			slot[0] = (asteroidX[a] - shipX[env]) / RULES_SCREEN_SIZE;
+			slot[1] = (asteroidY[a] - shipY[env]) / RULES_SCREEN_SIZE;
+			slot[2] = asteroidSpeed[a] * asteroidDirectionX[a];
+			slot[3] = asteroidSpeed[a] * asteroidDirectionY[a];
+			slot[4] = asteroidLevel[a] + 1.f;
+		}
+		else
+			std::fill(slot, slot + ENV_ASTEROID_FEATURES, 0.f);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "GameRules.h"
+#include "AsteroidSolver.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+#define ENV_MAX_ASTEROIDS ASTEROID_POOL_SIZE	// the pool of a game with ENV_START_ASTEROIDS, no asteroid spawns past it
+#define ENV_START_ASTEROIDS 6		// NUM_OF_ASTEROIDS
+#define ENV_MAX_BULLETS NUMBER_OF_BULLETS
+#define ENV_START_HEALTH INTIAL_PLAYER_HEALTH
+#define ENV_MAX_EPISODE_TICKS (5 * 60 * 60) // five minutes, then the episode is cut off
+#define ENV_CHUNK_SIZE 64			// environments a thread takes at a time
+#define ENV_MAX_THREADS 64
+#define ENV_BENCHMARK_ENVS 4096
+#define ENV_BENCHMARK_STEPS 1000
+
+// Observation Layout, floats per environment
+#define ENV_OBSERVED_ASTEROIDS 16	// the nearest ones, nearest first
+#define ENV_SHIP_FEATURES 6			// x, y, sin(rotation), cos(rotation), health, can shoot
+#define ENV_ASTEROID_FEATURES 5		// dx, dy from the ship, vx, vy, level + 1 (0 = empty slot)
+#define ENV_OBSERVATION_SIZE (ENV_SHIP_FEATURES + ENV_OBSERVED_ASTEROIDS * ENV_ASTEROID_FEATURES)
+
+class BatchEnvironment
+{
+	/*
+	Many independent copies of the game stepped in lockstep, one tick per step() call.
+	State lives in flat arrays indexed by environment, inputs and outputs are contiguous
+	arrays with one entry (or one observation row) per environment. Environments are
+	handed to the worker threads in chunks; every environment has its own random
+	generator, so results do not depend on the number of threads.
+	A finished episode (no health left or ENV_MAX_EPISODE_TICKS) is reset inside step():
+	its done flag is set and its observation already belongs to the new episode.
+	The rules are GameRules, the ones Player, Asteroid and Game play by, with the game's hit boxes,
+	contacts and asteroid bounces. Nothing renders, so no QualityGovernor holds spawns back: a hit
+	always spawns while there is room in the ENV_MAX_ASTEROIDS slots, as in a game at full quality
+	*/
+public:
+	BatchEnvironment(const int _numOfEnvs, const int _numOfThreads = 0, const std::uint32_t _seed = 1);
+	~BatchEnvironment();
+private:
+	int numOfEnvs;
+	std::uint32_t seed;
+
+	// Ship, one entry per environment
+	std::vector<float> shipX, shipY, shipRotation;
+	std::vector<int> health, score, reloadTicks, thrustTicks, episodeTicks, episodes;
+	std::vector<CounterRandom> random;		// asteroid rolls
+
+	// Asteroids and bullets, ENV_MAX_ASTEROIDS / ENV_MAX_BULLETS slots per environment,
+	// asteroids fill the first numOfAsteroids slots (they never disappear, like in the game)
+	std::vector<float> asteroidX, asteroidY, asteroidSpeed, asteroidDirectionX, asteroidDirectionY; // as in Asteroid
+	std::vector<std::uint8_t> asteroidLevel;
+	std::vector<std::uint8_t> asteroidTouching;	// ship contact, damage only when it begins
+	std::vector<int> numOfAsteroids;
+	std::vector<float> bulletX, bulletY, bulletAngle;
+	std::vector<std::uint8_t> bulletActive;
+
+	// Outputs
+	std::vector<float> observations;
+	std::vector<float> rewards;
+	std::vector<std::uint8_t> dones;
+
+	// Workers
+	const std::uint8_t* actions = nullptr;
+	std::vector<std::thread> workers;
+	std::mutex workMutex;
+	std::condition_variable workCondition;
+	std::condition_variable doneCondition;
+	int stepId = 0;
+	int workersDone = 0;
+	bool stopWorkers = false;
+	std::atomic<int> nextChunk{ 0 };
+	AsteroidSolver solver; // of the calling thread, every worker has its own
+
+public:
+	void reset();
+	void step(const std::uint8_t* _actions);
+
+	// G&S
+	int getNumOfEnvs() const;
+	const float* getObservations() const;	// numOfEnvs x ENV_OBSERVATION_SIZE
+	const float* getRewards() const;		// score gained in the last step
+	const std::uint8_t* getDones() const;
+	int getEpisodes(const int env) const;	// finished episodes of an environment
+
+	// Steps ENV_BENCHMARK_ENVS environments with random actions and prints the ticks per second.
+	// Arguments: [envs] [steps] [threads]
+	static int runBenchmark(int argc, char* argv[]);
+
+private:
+	void workerLoop();
+	void stepChunks(AsteroidSolver& threadSolver);
+	void stepEnv(const int env, const std::uint8_t action, AsteroidSolver& threadSolver);
+	void bounceAsteroids(const int env, AsteroidSolver& threadSolver);
+	void resetEnv(const int env);
+	void initializeAsteroid(const int env, const int slot, const int level);
+	void addAsteroid(const int env, const int level, const float x, const float y);
+	void observe(const int env);
+};
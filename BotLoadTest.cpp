@@ -0,0 +1,143 @@
+#include "BotLoadTest.h"
+#include "Autopilot.h"
+#include "SimulationCore.h"
+#include "TimerWheel.h"
+#include "GameRules.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	struct Bots
+	{
+		std::vector<float> x, y, rotation;
+		std::vector<int> reloadTicks, thrustTicks;
+		std::vector<std::uint8_t> touching;
+		long long contacts = 0;
+
+		Bots(const int numOfBots)
+		{
+			for (int i{ 0 }; i < numOfBots; i++) // on a grid over the screen, all facing up
+			{
+				const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numOfBots))));
+				x.push_back(SIM_SCREEN_SIZE * (i % side + 0.5f) / side);
+				y.push_back(SIM_SCREEN_SIZE * (i / side + 0.5f) / side);
+			}
+			rotation.assign(numOfBots, 0.f);
+			reloadTicks.assign(numOfBots, 0);
+			thrustTicks.assign(numOfBots, 0);
+			touching.assign(numOfBots, 0);
+		}
+
+		void countContact(const AsteroidIndex& index, const int bot)
+		{
+			/*
+			Function counts the ticks on which the bot starts touching an asteroid
+			*/
+			Neighbour nearest;
+			bool touches = index.findNearest(x[bot], y[bot], 1, &nearest) == 1 &&
+				std::sqrt(nearest.distanceSquared) < nearest.asteroid->radius + BOT_SHIP_RADIUS;
+			if (touches && !touching[bot])
+				contacts++;
+			touching[bot] = touches;
+		}
+	};
+}
+
+int BotLoadTest::run(int argc, char* argv[])
+{
+	/*
+	Function steps a SimWorld field and, every tick, rebuilds the asteroid index and lets one autopilot
+	decide for every bot. Bots move like Player (GameRules::steerShip), their shots only count.
+	A second set of bots that never moves gives the number of contacts to compare the dodging against
+	*/
+	int numOfBots = BOT_LOAD_TEST_BOTS;
+	int steps = BOT_LOAD_TEST_STEPS;
+	SimScene scene;
+	scene.numOfAsteroids = BOT_LOAD_TEST_ASTEROIDS;
+	scene.numOfBullets = 0;
+	try
+	{
+		if (argc > 0) numOfBots = std::stoi(argv[0]);
+		if (argc > 1) steps = std::stoi(argv[1]);
+		if (argc > 2) scene.numOfAsteroids = std::stoi(argv[2]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bot-load-test [bots] [steps] [asteroids]\n";
+		return 1;
+	}
+
+	SimulationCore<GridCollision, FloatIntegration> core{ scene };
+	AsteroidIndex index;
+	Autopilot autopilot;
+	Bots bots{ numOfBots };
+	Bots idleBots{ numOfBots };
+	long long modes[NUMBER_OF_AUTOPILOT_MODES] = {};
+	long long shots = 0;
+	double indexMs = 0, decideMs = 0;
+	const float dt = SIM_TICK_MS;
+
+	for (int step{ 0 }; step < steps; step++)
+	{
+		core.step(dt);
+		const SimWorld& world = core.getWorld();
+
+		auto start = std::chrono::steady_clock::now();
+		index.clear();
+		for (int i{ 0 }; i < world.getNumOfAsteroids(); i++)
+			index.insert({ world.asteroidX[i], world.asteroidY[i], world.asteroidSpeed[i] * world.asteroidDirectionX[i],
+				world.asteroidSpeed[i] * world.asteroidDirectionY[i], world.asteroidRadius[i], i });
+		index.build();
+		auto built = std::chrono::steady_clock::now();
+
+		for (int i{ 0 }; i < numOfBots; i++)
+		{
+			PlayerInput input;
+			ShipState ship{ bots.x[i], bots.y[i], bots.rotation[i], BOT_SHIP_RADIUS, bots.reloadTicks[i] == 0 };
+			modes[autopilot.decide(index, ship, input)]++;
+
+			ShipControls controls;
+			controls.rotateLeft = input.rotateLeft ? 1.f : 0.f;
+			controls.rotateRight = input.rotateRight ? 1.f : 0.f;
+			controls.thrust = input.thrust ? 1.f : 0.f;
+			sf::Vector2f position(bots.x[i], bots.y[i]);
+			GameRules::steerShip(position, bots.rotation[i], controls, bots.thrustTicks[i] * dt, dt, false);
+			bots.x[i] = position.x;
+			bots.y[i] = position.y;
+			bots.thrustTicks[i] = input.thrust ? bots.thrustTicks[i] + 1 : 0;
+			if (bots.reloadTicks[i] > 0)
+				bots.reloadTicks[i]--;
+			else if (input.fire)
+			{
+				shots++;
+				bots.reloadTicks[i] = msToTicks(RULES_RELOAD_MS);
+			}
+		}
+		decideMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - built).count();
+		indexMs += std::chrono::duration<double, std::milli>(built - start).count();
+
+		for (int i{ 0 }; i < numOfBots; i++)
+		{
+			bots.countContact(index, i);
+			idleBots.countContact(index, i);
+		}
+	}
+
+	const long long decisions = static_cast<long long>(numOfBots) * steps;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << numOfBots << " bots, " << scene.numOfAsteroids << " asteroids, " << steps << " steps\n";
+	std::cout << "  index build     " << indexMs / steps << " ms per step\n";
+	std::cout << "  decisions       " << decideMs / steps << " ms per step, " << 1e6 * decideMs / std::max(decisions, 1LL) << " ns per bot\n";
+	std::cout << "  tick budget     " << 100.0 * (indexMs + decideMs) / steps / SIM_TICK_MS << "% of " << SIM_TICK_MS << " ms\n";
+	std::cout << std::setprecision(1);
+	std::cout << "  modes           idle " << 100.0 * modes[AUTOPILOT_IDLE] / decisions << "%, hunt " << 100.0 * modes[AUTOPILOT_HUNT] / decisions
+		<< "%, dodge " << 100.0 * modes[AUTOPILOT_DODGE] / decisions << "%\n";
+	std::cout << "  shots           " << shots << "\n";
+	std::cout << "  contacts        " << bots.contacts << " (" << idleBots.contacts << " for bots that do not move)\n";
+	return 0;
+}
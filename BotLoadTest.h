@@ -0,0 +1,13 @@
+#pragma once
+
+#define BOT_LOAD_TEST_BOTS 300
+#define BOT_LOAD_TEST_STEPS 3600		// one minute of game time
+#define BOT_LOAD_TEST_ASTEROIDS 100
+#define BOT_SHIP_RADIUS 15.f
+
+namespace BotLoadTest
+{
+	// Flies many autopilot ships through one simulated asteroid field and prints what the queries cost.
+	// Arguments: [bots] [steps] [asteroids]
+	int run(int argc, char* argv[]);
+}
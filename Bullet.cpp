@@ -5,7 +5,7 @@ Bullet::Bullet(const sf::Texture& _texture)
 texture{ _texture }
 {
 	setTexture(texture);
-	scale(sf::Vector2f(0.15f, 0.15f));
+	scale(sf::Vector2f(RULES_BULLET_SCALE, RULES_BULLET_SCALE));
 }
 
 void Bullet::intialize(const float _angle, const sf::Vector2f& startPosition)
@@ -14,7 +14,7 @@ void Bullet::intialize(const float _angle, const sf::Vector2f& startPosition)
 	Function saves the angle at which the bullet was shot and its startingPosition
 	*/
 	angle = _angle;
-	rotate(angle);
+	setRotation(angle);
 	setPosition(startPosition);
 }
 
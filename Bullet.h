@@ -1,13 +1,16 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include "MemoryTracker.h"
+#include "GameRules.h"
 
-class Bullet : public sf::Sprite
+class Bullet : public sf::Sprite, public Tracked<MEMORY_ENTITIES>
 {
 private:
 	sf::Texture texture;
 public:
 	float angle{};
+	int id{}; // contact slot, set once by the Player
 public:
 	Bullet(const sf::Texture& _texture);
 	void intialize(const float _angle, const sf::Vector2f& startPosition);
@@ -0,0 +1,410 @@
+#include "ContactManager.h"
+#include "SimWorld.h"
+#include "SimulationPolicies.h"
+#include "TimerWheel.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+
+void ContactManager::reserve(const int maxProbes, const int maxTargets)
+{
+	/*
+	Function sizes everything for the worst case: a probe's list and the jumpers never hold a target twice,
+	so a tick has at most maxProbes * maxTargets candidates, contacts and events of each tick
+	*/
+	const size_t maxPairs = static_cast<size_t>(maxProbes) * maxTargets;
+	if (static_cast<int>(probes.size()) < maxProbes)
+		probes.resize(maxProbes);
+	for (Probe& probe : probes)
+		probe.nearby.reserve(maxTargets);
+	for (auto* values : { &targetX, &targetY, &targetRadius, &anchorX, &anchorY, &anchorRadius })
+		values->reserve(maxTargets);
+	jumper.reserve(maxTargets);
+	targetCell.reserve(maxTargets);
+	cellTargets.reserve(maxTargets);
+	cellStart.reserve(CONTACT_MAX_GRID_CELLS * CONTACT_MAX_GRID_CELLS + 1);
+	jumpers.reserve(maxTargets);
+	candidates.reserve(maxPairs);
+	previousPairs.reserve(maxPairs);
+	currentPairs.reserve(maxPairs);
+	events.reserve(2 * maxPairs); // every contact of the last tick ends and every one of this tick begins
+}
+
+void ContactManager::clear()
+{
+	previousPairs.clear();
+	currentPairs.clear();
+	events.clear();
+	for (Probe& probe : probes)
+		probe.present = probe.listValid = false;
+	rebuildNeeded = true;
+}
+
+void ContactManager::setNumOfTargets(const int count)
+{
+	if (count < numOfTargets)
+		rebuildNeeded = true; // lists and jumpers may hold the slots that went away
+	numOfTargets = count;
+	targetX.resize(count);
+	targetY.resize(count);
+	targetRadius.resize(count);
+	jumper.resize(count, 0);
+}
+
+void ContactManager::setProbe(const int slot, const float x, const float y, const float radius)
+{
+	if (slot >= static_cast<int>(probes.size()))
+		probes.resize(slot + 1);
+	Probe& probe = probes[slot];
+	probe.present = true;
+	probe.x = x;
+	probe.y = y;
+	probe.radius = radius;
+}
+
+void ContactManager::removeTarget(const int target, const int last)
+{
+	/*
+	Function follows a swap and pop of the caller's targets between two updates: the contacts of target
+	end without an event and those of last are renamed, the lists hold both slots so all are rebuilt
+	*/
+	int kept = 0;
+	for (std::uint64_t pair : previousPairs)
+	{
+		const int pairTarget = static_cast<int>(pair & 0xffffffffu);
+		if (pairTarget == target)
+			continue;
+		if (pairTarget == last)
+			pair = (pair & ~static_cast<std::uint64_t>(0xffffffffu)) | static_cast<std::uint32_t>(target);
+		previousPairs[kept++] = pair;
+	}
+	previousPairs.resize(kept);
+	std::sort(previousPairs.begin(), previousPairs.end());
+	rebuildNeeded = true;
+}
+
+// Candidates
+
+void ContactManager::collectCandidates()
+{
+	/*
+	Function finds the targets that moved too far for the lists (jumpers), then takes every present
+	probe's list, rebuilt if the probe moved too far, and the jumpers as the pairs to test
+	*/
+	const float halfSkin = CONTACT_SKIN / 2;
+	if (rebuildNeeded)
+		rebuildAll();
+	for (int j{ 0 }; j < numOfTargets; j++)
+	{
+		if (jumper[j])
+			continue;
+		bool jumped = j >= numOfAnchored; // new since the rebuild
+		if (!jumped)
+		{
+			const float dx = targetX[j] - anchorX[j];
+			const float dy = targetY[j] - anchorY[j];
+			jumped = dx * dx + dy * dy > halfSkin * halfSkin || targetRadius[j] > anchorRadius[j];
+		}
+		if (jumped)
+		{
+			jumper[j] = 1;
+			jumpers.push_back(j);
+		}
+	}
+	if (static_cast<int>(jumpers.size()) > CONTACT_MAX_JUMPERS)
+		rebuildAll();
+
+	candidates.clear();
+	for (int p{ 0 }; p < static_cast<int>(probes.size()); p++)
+	{
+		Probe& probe = probes[p];
+		if (!probe.present)
+			continue;
+		const float dx = probe.x - probe.anchorX;
+		const float dy = probe.y - probe.anchorY;
+		if (!probe.listValid || dx * dx + dy * dy > halfSkin * halfSkin || probe.radius > probe.anchorRadius)
+			buildList(probe);
+		for (int j : probe.nearby)
+			if (!jumper[j])
+				candidates.push_back({ p, j });
+		for (int j : jumpers)
+			candidates.push_back({ p, j });
+	}
+}
+
+void ContactManager::rebuildAll()
+{
+	/*
+	Function anchors every target where it is now and sorts the anchors into a grid (counting sort),
+	there are no jumpers afterwards and every list has to be built again
+	*/
+	anchorX.assign(targetX.begin(), targetX.end());
+	anchorY.assign(targetY.begin(), targetY.end());
+	anchorRadius.assign(targetRadius.begin(), targetRadius.end());
+	numOfAnchored = numOfTargets;
+	std::fill(jumper.begin(), jumper.end(), 0);
+	jumpers.clear();
+	for (Probe& probe : probes)
+		probe.listValid = false;
+	rebuildNeeded = false;
+	numOfRebuilds++;
+
+	float maxX = 0.f, maxY = 0.f;
+	gridMinX = gridMinY = 0.f;
+	maxAnchorRadius = 0.f;
+	if (numOfTargets > 0)
+	{
+		gridMinX = *std::min_element(anchorX.begin(), anchorX.end());
+		gridMinY = *std::min_element(anchorY.begin(), anchorY.end());
+		maxX = *std::max_element(anchorX.begin(), anchorX.end());
+		maxY = *std::max_element(anchorY.begin(), anchorY.end());
+		maxAnchorRadius = *std::max_element(anchorRadius.begin(), anchorRadius.end());
+	}
+	cellSize = std::max({ CONTACT_SKIN + 2 * maxAnchorRadius, (maxX - gridMinX) / CONTACT_MAX_GRID_CELLS, (maxY - gridMinY) / CONTACT_MAX_GRID_CELLS });
+	cellsX = std::min(CONTACT_MAX_GRID_CELLS, static_cast<int>((maxX - gridMinX) / cellSize) + 1);
+	cellsY = std::min(CONTACT_MAX_GRID_CELLS, static_cast<int>((maxY - gridMinY) / cellSize) + 1);
+
+	cellStart.assign(cellsX * cellsY + 1, 0);
+	targetCell.resize(numOfTargets);
+	for (int j{ 0 }; j < numOfTargets; j++)
+	{
+		const int cx = std::min(cellsX - 1, static_cast<int>((anchorX[j] - gridMinX) / cellSize));
+		const int cy = std::min(cellsY - 1, static_cast<int>((anchorY[j] - gridMinY) / cellSize));
+		targetCell[j] = cy * cellsX + cx;
+		cellStart[targetCell[j] + 1]++;
+	}
+	for (int c{ 0 }; c < cellsX * cellsY; c++)
+		cellStart[c + 1] += cellStart[c];
+	cellTargets.resize(numOfTargets);
+	for (int j{ numOfTargets - 1 }; j >= 0; j--) // backwards, so a cell lists its targets in order
+		cellTargets[--cellStart[targetCell[j] + 1]] = j;
+	for (int c{ 0 }; c < cellsX * cellsY; c++) // every end moved back to its start, so they belong one cell earlier
+		cellStart[c] = cellStart[c + 1];
+	cellStart[cellsX * cellsY] = numOfTargets;
+}
+
+void ContactManager::buildList(Probe& probe)
+{
+	/*
+	Function lists the targets anchored within the skin of the probe, from the cells around it.
+	Until the list is built again the probe moves at most half the skin and a target that is not
+	a jumper at most half the skin from its anchor, so a target left out cannot reach the probe
+	*/
+	probe.anchorX = probe.x;
+	probe.anchorY = probe.y;
+	probe.anchorRadius = probe.radius;
+	probe.nearby.clear();
+	probe.listValid = true;
+	if (numOfAnchored == 0)
+		return;
+
+	const float reach = probe.radius + maxAnchorRadius + CONTACT_SKIN;
+	const int firstX = std::max(0, static_cast<int>(std::floor((probe.x - reach - gridMinX) / cellSize)));
+	const int lastX = std::min(cellsX - 1, static_cast<int>(std::floor((probe.x + reach - gridMinX) / cellSize)));
+	const int firstY = std::max(0, static_cast<int>(std::floor((probe.y - reach - gridMinY) / cellSize)));
+	const int lastY = std::min(cellsY - 1, static_cast<int>(std::floor((probe.y + reach - gridMinY) / cellSize)));
+	for (int cy{ firstY }; cy <= lastY; cy++)
+		for (int cx{ firstX }; cx <= lastX; cx++)
+		{
+			const int cell = cy * cellsX + cx;
+			for (int k{ cellStart[cell] }; k < cellStart[cell + 1]; k++)
+			{
+				const int j = cellTargets[k];
+				const float targetReach = probe.radius + anchorRadius[j] + CONTACT_SKIN;
+				const float dx = anchorX[j] - probe.x;
+				const float dy = anchorY[j] - probe.y;
+				if (!jumper[j] && dx * dx + dy * dy < targetReach * targetReach)
+					probe.nearby.push_back(j);
+			}
+		}
+}
+
+// Events
+
+void ContactManager::finishTick()
+{
+	/*
+	Function compares the overlaps of this tick with the last tick's, both sorted, so the cost
+	follows the number of contacts, not the number of bodies
+	*/
+	std::sort(currentPairs.begin(), currentPairs.end());
+	events.clear();
+	size_t i = 0, k = 0;
+	while (i < previousPairs.size() || k < currentPairs.size())
+	{
+		std::uint64_t pair;
+		contactPhase phase;
+		if (k == currentPairs.size() || (i < previousPairs.size() && previousPairs[i] < currentPairs[k]))
+		{
+			pair = previousPairs[i++];
+			phase = CONTACT_END;
+		}
+		else if (i == previousPairs.size() || currentPairs[k] < previousPairs[i])
+		{
+			pair = currentPairs[k++];
+			phase = CONTACT_BEGIN;
+		}
+		else
+		{
+			pair = currentPairs[k++];
+			i++;
+			phase = CONTACT_STAY;
+		}
+		events.push_back({ phase, static_cast<int>(pair >> 32), static_cast<int>(pair & 0xffffffffu) });
+	}
+	std::swap(previousPairs, currentPairs);
+
+	for (Probe& probe : probes)
+	{
+		if (!probe.present)
+			probe.listValid = false; // it may come back anywhere
+		probe.present = false;
+	}
+}
+
+// G&S
+const TrackedVector<ContactEvent, MEMORY_COLLISION>& ContactManager::getEvents() const
+{
+	return events;
+}
+
+int ContactManager::getNumOfContacts() const
+{
+	return static_cast<int>(previousPairs.size());
+}
+
+int ContactManager::getNumOfTests() const
+{
+	return static_cast<int>(candidates.size());
+}
+
+int ContactManager::getNumOfRebuilds() const
+{
+	return numOfRebuilds;
+}
+
+// Snapshot
+
+void ContactManager::saveState(StateWriter& writer) const
+{
+	writer.write(static_cast<std::uint32_t>(previousPairs.size()));
+	for (std::uint64_t pair : previousPairs)
+		writer.write(pair);
+}
+
+void ContactManager::loadState(StateReader& reader)
+{
+	clear();
+	const std::uint32_t count = reader.read<std::uint32_t>();
+	for (std::uint32_t c{ 0 }; c < count && reader.good(); c++)
+		previousPairs.push_back(reader.read<std::uint64_t>());
+}
+
+// Broadphase
+
+void ContactManager::boundingCircle(const sf::FloatRect& bounds, float& x, float& y, float& radius)
+{
+	x = bounds.left + bounds.width / 2;
+	y = bounds.top + bounds.height / 2;
+	radius = 0.5f * std::sqrt(bounds.width * bounds.width + bounds.height * bounds.height);
+}
+
+// Benchmark
+
+int ContactManager::runBenchmark(int argc, char* argv[])
+{
+	SimScene scene;
+	scene.numOfAsteroids = CONTACT_BENCHMARK_ASTEROIDS;
+	scene.numOfBullets = 32;
+	int ticks = CONTACT_BENCHMARK_TICKS;
+	try
+	{
+		if (argc > 0) scene.numOfAsteroids = std::stoi(argv[0]);
+		if (argc > 1) ticks = std::stoi(argv[1]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-contacts [asteroids] [ticks]\n";
+		return 1;
+	}
+
+	SimWorld world{ scene };
+	const int numOfBullets = world.getNumOfBullets();
+	ContactManager contacts;
+	contacts.reserve(numOfBullets, world.maxAsteroids);
+	std::vector<std::uint64_t> brutePairs, managedPairs;
+	brutePairs.reserve(numOfBullets * 4);
+	managedPairs.reserve(numOfBullets * 4);
+	std::vector<std::uint8_t> hit(world.maxAsteroids);
+	double managedSeconds = 0, bruteSeconds = 0;
+	long long managedTests = 0, bruteTests = 0, begins = 0, mismatches = 0;
+
+	for (int tick{ 0 }; tick < ticks; tick++)
+	{
+		FloatIntegration::integrate(world, SIM_TICK_MS);
+		world.updateBounds();
+		const int n = world.getNumOfAsteroids();
+
+		auto start = std::chrono::steady_clock::now();
+		contacts.setNumOfTargets(n);
+		for (int a{ 0 }; a < n; a++)
+			boundingCircle(world.asteroidBounds[a], contacts.targetX[a], contacts.targetY[a], contacts.targetRadius[a]);
+		for (int b{ 0 }; b < numOfBullets; b++)
+		{
+			float x, y, radius;
+			boundingCircle(world.bulletBounds[b], x, y, radius);
+			contacts.setProbe(b, x, y, radius);
+		}
+		contacts.update([&](const int b, const int a) { return GameRules::overlaps(world.bulletBounds[b], world.asteroidBounds[a], false); });
+		managedSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		managedTests += contacts.getNumOfTests();
+
+		// every pair, the way the game did it before
+		start = std::chrono::steady_clock::now();
+		brutePairs.clear();
+		for (int b{ 0 }; b < numOfBullets; b++)
+			for (int a{ 0 }; a < n; a++)
+				if (GameRules::overlaps(world.bulletBounds[b], world.asteroidBounds[a], false))
+					brutePairs.push_back(static_cast<std::uint64_t>(b) << 32 | static_cast<std::uint32_t>(a));
+		bruteSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		bruteTests += static_cast<long long>(numOfBullets) * n;
+
+		managedPairs.clear();
+		for (const ContactEvent& event : contacts.getEvents())
+			if (event.phase != CONTACT_END)
+				managedPairs.push_back(static_cast<std::uint64_t>(event.probe) << 32 | static_cast<std::uint32_t>(event.target));
+		if (managedPairs != brutePairs)
+			mismatches++;
+
+		// a bullet is spent by the first asteroid it touches, an asteroid breaks once per tick
+		// and the last one that broke spawns a small one, like Game::checkForCollision
+		std::fill(hit.begin(), hit.begin() + n, 0);
+		int spentBullet = -1;
+		int deadAsteroid = -1;
+		for (const ContactEvent& event : contacts.getEvents())
+		{
+			if (event.phase != CONTACT_BEGIN || event.probe == spentBullet)
+				continue;
+			spentBullet = event.probe;
+			if (!hit[event.target])
+			{
+				hit[event.target] = 1;
+				world.hitAsteroid(event.target);
+				deadAsteroid = event.target;
+				begins++;
+			}
+			world.fireBullet(event.probe);
+		}
+		if (deadAsteroid != -1)
+			world.spawnFragment(deadAsteroid);
+	}
+
+	std::cout << world.getNumOfAsteroids() << " asteroids, " << numOfBullets << " bullets, " << ticks << " ticks, "
+		<< begins << " hits\n";
+	std::cout << "contact manager: " << 1e6 * managedSeconds / ticks << " us and " << managedTests / ticks
+		<< " tests per tick, " << contacts.getNumOfRebuilds() << " full rebuilds\n";
+	std::cout << "every pair:      " << 1e6 * bruteSeconds / ticks << " us and " << bruteTests / ticks << " tests per tick\n";
+	std::cout << (mismatches == 0 ? "same contacts every tick\n" : "CONTACTS DIFFER\n");
+	return mismatches == 0 ? 0 : 1;
+}
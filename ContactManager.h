@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "MemoryTracker.h"
+#include "Snapshot.h"
+#include <vector>
+#include <cstdint>
+
+#define CONTACT_SKIN 32.f				// margin of the nearby lists, px: probes and targets may each drift half of it
+#define CONTACT_MAX_JUMPERS 64			// targets tested against every probe before the targets are anchored again
+#define CONTACT_MAX_GRID_CELLS 256		// per side of the anchor grid
+#define CONTACT_BENCHMARK_ASTEROIDS 2000
+#define CONTACT_BENCHMARK_TICKS 2000
+
+enum contactPhase
+{
+	CONTACT_BEGIN,
+	CONTACT_STAY,
+	CONTACT_END,
+	NUMBER_OF_CONTACT_PHASES
+};
+
+struct ContactEvent
+{
+	contactPhase phase;
+	int probe;
+	int target;
+};
+
+class ContactManager
+{
+	/*
+	Keeps the overlaps between a few probes (ships, bullets) and many targets (asteroids) from one tick
+	to the next and reports their changes as begin, stay and end events. Every probe has a list of the
+	targets anchored within CONTACT_SKIN of it, only those are tested, and the list lasts until the probe
+	has moved half the skin. Targets are anchored on a grid where they were at the last rebuild, one that
+	has moved farther than half the skin (wrapped, respawned, pushed apart) is a jumper and is tested
+	against every probe until the next rebuild. Probes and targets are slots, a slot has to stay
+	the same object for as long as it is in contact
+	*/
+public:
+	// Targets, filled in by the caller (bounding circles) before update()
+	TrackedVector<float, MEMORY_COLLISION> targetX, targetY, targetRadius;
+
+private:
+	struct Probe
+	{
+		bool present = false;	// set this tick
+		bool listValid = false;
+		float x = 0.f, y = 0.f, radius = 0.f;
+		float anchorX = 0.f, anchorY = 0.f, anchorRadius = 0.f;
+		TrackedVector<int, MEMORY_COLLISION> nearby;
+	};
+	struct Candidate
+	{
+		int probe, target;
+	};
+
+	std::vector<Probe> probes;
+	int numOfTargets = 0;
+	int numOfAnchored = 0;
+	bool rebuildNeeded = true; // targets went away or the contacts were loaded
+	TrackedVector<float, MEMORY_COLLISION> anchorX, anchorY, anchorRadius;
+	float maxAnchorRadius = 0.f;
+	float gridMinX = 0.f, gridMinY = 0.f, cellSize = 1.f;
+	int cellsX = 1, cellsY = 1;
+	TrackedVector<int, MEMORY_COLLISION> cellStart;
+	TrackedVector<int, MEMORY_COLLISION> cellTargets;	// anchored targets grouped by cell
+	TrackedVector<int, MEMORY_COLLISION> targetCell;
+	TrackedVector<std::uint8_t, MEMORY_COLLISION> jumper;
+	TrackedVector<int, MEMORY_COLLISION> jumpers;
+	TrackedVector<Candidate, MEMORY_COLLISION> candidates;
+	TrackedVector<std::uint64_t, MEMORY_COLLISION> previousPairs; // probe << 32 | target, sorted
+	TrackedVector<std::uint64_t, MEMORY_COLLISION> currentPairs;
+	TrackedVector<ContactEvent, MEMORY_COLLISION> events;
+	int numOfRebuilds = 0;
+
+public:
+	void reserve(const int maxProbes, const int maxTargets); // ticks within these do not allocate, however many pairs overlap
+	void clear(); // no contacts, as at the start of a game
+	void setNumOfTargets(const int count);
+	void setProbe(const int slot, const float x, const float y, const float radius); // present this tick
+	void removeTarget(const int target, const int last); // target is gone, the target in slot last moved into its slot
+
+	// Tests the candidate pairs with overlaps(probe, target) and turns the result into events
+	template<class Narrowphase>
+	void update(Narrowphase overlaps)
+	{
+		collectCandidates();
+		currentPairs.clear();
+		for (const Candidate& candidate : candidates)
+			if (overlaps(candidate.probe, candidate.target))
+				currentPairs.push_back(static_cast<std::uint64_t>(candidate.probe) << 32 | static_cast<std::uint32_t>(candidate.target));
+		finishTick();
+	}
+
+	// G&S
+	const TrackedVector<ContactEvent, MEMORY_COLLISION>& getEvents() const; // sorted by probe, then target
+	int getNumOfContacts() const;
+	int getNumOfTests() const; // narrowphase tests of the last update
+	int getNumOfRebuilds() const; // anchorings of every target so far
+
+	// Snapshot, the contacts only: the lists are rebuilt after loading
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
+
+	// Circle around a bounding box, everything GameRules::overlaps can report lies within it
+	static void boundingCircle(const sf::FloatRect& bounds, float& x, float& y, float& radius);
+
+	// Flies SimWorld bullets through its asteroids, compares contacts and tests with testing every pair.
+	// Arguments: [asteroids] [ticks]
+	static int runBenchmark(int argc, char* argv[]);
+
+private:
+	void collectCandidates();
+	void rebuildAll();
+	void buildList(Probe& probe);
+	void finishTick();
+};
@@ -0,0 +1,68 @@
+#include "CounterRandom.h"
+
+#define COUNTER_RANDOM_GOLDEN 0x9e3779b97f4a7c15ull // 2^64 / golden ratio, the SplitMix64 increment
+
+static std::uint64_t mix(std::uint64_t z)
+{
+	/*
+	SplitMix64 finalizer, every input bit affects every output bit
+	*/
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+static std::uint64_t makeKey(const std::uint64_t seed, const std::uint64_t stream)
+{
+	return mix(mix(seed) ^ (stream * 0xd1b54a32d192ed03ull + COUNTER_RANDOM_GOLDEN));
+}
+
+CounterRandom::CounterRandom(const std::uint64_t seed, const std::uint64_t stream)
+	:
+	key{ makeKey(seed, stream) }
+{
+}
+
+std::uint64_t CounterRandom::at(const std::uint64_t seed, const std::uint64_t stream, const std::uint64_t index)
+{
+	return mix(makeKey(seed, stream) + COUNTER_RANDOM_GOLDEN * (index + 1));
+}
+
+std::uint64_t CounterRandom::next()
+{
+	counter++;
+	return mix(key + COUNTER_RANDOM_GOLDEN * counter);
+}
+
+float CounterRandom::nextFloat()
+{
+	return static_cast<float>(next() >> 40) * (1.f / 16777216.f); // exact, 24 bits fit a float
+}
+
+float CounterRandom::nextFloat(const float min, const float max)
+{
+	return min + (max - min) * nextFloat();
+}
+
+int CounterRandom::nextInt(const int min, const int max)
+{
+	/*
+	Function scales 32 random bits to the range with integers only
+	*/
+	const std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min + 1);
+	return min + static_cast<int>(((next() >> 32) * range) >> 32);
+}
+
+// Snapshot
+
+void CounterRandom::saveState(StateWriter& writer) const
+{
+	writer.write(key);
+	writer.write(counter);
+}
+
+void CounterRandom::loadState(StateReader& reader)
+{
+	key = reader.read<std::uint64_t>();
+	counter = reader.read<std::uint64_t>();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Snapshot.h"
+#include <cstdint>
+
+class CounterRandom
+{
+	/*
+	Counter-based generator in the style of SplitMix64: the n-th number of a stream is a hash
+	of its key (seed and stream id) and n. A stream is only two integers, so every entity or
+	thread can have its own, they never share state, and a seed gives the same bits with every
+	compiler and on every machine. Floats are made from integer bits, not from library calls
+	*/
+public:
+	CounterRandom(const std::uint64_t seed = 0, const std::uint64_t stream = 0);
+private:
+	std::uint64_t key;
+	std::uint64_t counter = 0;
+public:
+	static std::uint64_t at(const std::uint64_t seed, const std::uint64_t stream, const std::uint64_t index); // any number of any stream
+	std::uint64_t next();
+	float nextFloat(); // [0, 1), 24 bits
+	float nextFloat(const float min, const float max);
+	int nextInt(const int min, const int max); // both included
+
+	// Snapshot
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
+};
@@ -0,0 +1,111 @@
+#include "FixedMath.h"
+#include <cmath>
+
+#define FIXED_QUARTER_STEPS (FIXED_TRIG_STEPS / 4)
+#define FIXED_TABLE_BITS 30 // precision the table is computed with
+#define FIXED_HALF_PI 1686629713ll // pi / 2 with FIXED_TABLE_BITS fraction bits
+
+namespace
+{
+	bool enabled = false;
+
+	struct SineTable
+	{
+		fixed quarter[FIXED_QUARTER_STEPS + 1]; // 0 to 90 degrees
+
+		SineTable()
+		{
+			/*
+			Taylor series with integers only, so the table has the same bits wherever it is built
+			*/
+			for (int i{ 0 }; i <= FIXED_QUARTER_STEPS; i++)
+			{
+				const std::int64_t x = FIXED_HALF_PI * i / FIXED_QUARTER_STEPS;
+				const std::int64_t x2 = x * x / (1ll << FIXED_TABLE_BITS);
+				std::int64_t term = x;
+				std::int64_t sum = x;
+				for (int n{ 1 }; term != 0; n++)
+				{
+					term = -term * x2 / (1ll << FIXED_TABLE_BITS) / ((2 * n) * (2 * n + 1));
+					sum += term;
+				}
+				const int shift = FIXED_TABLE_BITS - FIXED_TRIG_BITS;
+				quarter[i] = static_cast<fixed>((sum + (1ll << (shift - 1))) >> shift);
+			}
+		}
+
+		fixed sine(const int step) const
+		{
+			const int index = step & (FIXED_TRIG_STEPS - 1);
+			const int within = index % FIXED_QUARTER_STEPS;
+			switch (index / FIXED_QUARTER_STEPS)
+			{
+			case 0: return quarter[within];
+			case 1: return quarter[FIXED_QUARTER_STEPS - within];
+			case 2: return -quarter[within];
+			default: return -quarter[FIXED_QUARTER_STEPS - within];
+			}
+		}
+	};
+
+	const SineTable& getTable()
+	{
+		static const SineTable table; // built on first use
+		return table;
+	}
+
+	int toStep(const float degrees)
+	{
+		return static_cast<int>(std::lround(degrees * (FIXED_TRIG_STEPS / 360.f)));
+	}
+
+	fixed scale(const fixed length, const fixed trig)
+	{
+		return static_cast<fixed>((static_cast<std::int64_t>(length) * trig + (1ll << (FIXED_TRIG_BITS - 1))) >> FIXED_TRIG_BITS);
+	}
+}
+
+void FixedMath::setEnabled(const bool _enabled)
+{
+	enabled = _enabled;
+}
+
+bool FixedMath::isEnabled()
+{
+	return enabled;
+}
+
+fixed FixedMath::toFixed(const float value)
+{
+	return static_cast<fixed>(std::lround(value * FIXED_ONE));
+}
+
+float FixedMath::toFloat(const fixed value)
+{
+	return static_cast<float>(value) * (1.f / FIXED_ONE);
+}
+
+fixed FixedMath::sinDegrees(const float degrees)
+{
+	return getTable().sine(toStep(degrees));
+}
+
+fixed FixedMath::cosDegrees(const float degrees)
+{
+	return getTable().sine(toStep(degrees) + FIXED_QUARTER_STEPS);
+}
+
+sf::Vector2f FixedMath::movePolar(const sf::Vector2f position, const float degrees, const float length)
+{
+	const fixed step = toFixed(length);
+	return sf::Vector2f(
+		toFloat(toFixed(position.x) + scale(step, sinDegrees(degrees))),
+		toFloat(toFixed(position.y) - scale(step, cosDegrees(degrees))));
+}
+
+sf::Vector2f FixedMath::moveBy(const sf::Vector2f position, const sf::Vector2f offset)
+{
+	return sf::Vector2f(
+		toFloat(toFixed(position.x) + toFixed(offset.x)),
+		toFloat(toFixed(position.y) + toFixed(offset.y)));
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include <cstdint>
+
+#define FIXED_FRACTION_BITS 8				// 1/256 px, positions below 32768 px are exact in a float
+#define FIXED_ONE (1 << FIXED_FRACTION_BITS)
+#define FIXED_TRIG_STEPS 4096				// sine table entries per full turn
+#define FIXED_TRIG_BITS 16					// sine values are 1/65536 steps
+
+typedef std::int32_t fixed;
+
+namespace FixedMath
+{
+	/*
+	Optional fixed-point movement (--fixed-point). Positions still live in the sprites' floats,
+	but every step is rounded to the 1/256 px grid and added as integers, and directions come
+	from a sine table built with integer arithmetic instead of std::sin/std::cos. Together with
+	CounterRandom this makes a game bit-identical across compilers and machines
+	*/
+	void setEnabled(const bool enabled);
+	bool isEnabled();
+
+	fixed toFixed(const float value);	// rounded to the nearest step
+	float toFloat(const fixed value);	// exact
+	fixed sinDegrees(const float degrees); // FIXED_TRIG_BITS fraction bits
+	fixed cosDegrees(const float degrees);
+
+	// Position after a move of length towards degrees (0 points up, like the sprites), on the fixed grid
+	sf::Vector2f movePolar(const sf::Vector2f position, const float degrees, const float length);
+	// Position after a move by offset, on the fixed grid
+	sf::Vector2f moveBy(const sf::Vector2f position, const sf::Vector2f offset);
+}
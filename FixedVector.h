@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cassert>
+
+template <class T, int Capacity>
+class FixedVector
+{
+	/*
+	Vector with inline storage for at most Capacity elements, it never allocates.
+	Meant for small lists of pointers or plain values that change every tick
+	*/
+private:
+	T items[Capacity]{};
+	int count = 0;
+
+public:
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+	void push_back(const T& item)
+	{
+		assert(count < Capacity);
+		items[count++] = item;
+	}
+
+	void pop_back()
+	{
+		assert(count > 0);
+		count--;
+	}
+
+	iterator erase(iterator position)
+	{
+		/*
+		Function removes one element and keeps the order of the rest
+		*/
+		for (iterator it{ position }; it + 1 < end(); it++)
+			*it = *(it + 1);
+		count--;
+		return position;
+	}
+
+	void clear() { count = 0; }
+
+	// G&S
+	T& back() { return items[count - 1]; }
+	const T& back() const { return items[count - 1]; }
+	T& at(const int index) { assert(index >= 0 && index < count); return items[index]; }
+	T& operator[](const int index) { return items[index]; }
+	const T& operator[](const int index) const { return items[index]; }
+	int size() const { return count; }
+	bool empty() const { return count == 0; }
+	bool full() const { return count == Capacity; }
+
+	iterator begin() { return items; }
+	iterator end() { return items + count; }
+	const_iterator begin() const { return items; }
+	const_iterator end() const { return items + count; }
+};
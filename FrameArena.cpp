@@ -0,0 +1,54 @@
+#include "FrameArena.h"
+
+FrameArena::FrameArena(const std::size_t _capacity, const memoryTag _tag)
+	:
+	capacity{ _capacity },
+	tag{ _tag }
+{
+	memory = static_cast<std::uint8_t*>(MemoryTracker::allocate(capacity, tag));
+}
+
+FrameArena::~FrameArena()
+{
+	MemoryTracker::deallocate(memory, capacity, tag);
+}
+
+void* FrameArena::allocate(const std::size_t size, const std::size_t alignment)
+{
+	std::size_t start = (used + alignment - 1) / alignment * alignment;
+	if (start + size > capacity)
+	{
+		overflows++;
+		return nullptr;
+	}
+	used = start + size;
+	if (used > peak)
+		peak = used;
+	return memory + start;
+}
+
+void FrameArena::reset()
+{
+	used = 0;
+}
+
+// G&S
+std::size_t FrameArena::getCapacity() const
+{
+	return capacity;
+}
+
+std::size_t FrameArena::getUsed() const
+{
+	return used;
+}
+
+std::size_t FrameArena::getPeak() const
+{
+	return peak;
+}
+
+int FrameArena::getOverflows() const
+{
+	return overflows;
+}
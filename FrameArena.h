@@ -0,0 +1,49 @@
+#pragma once
+
+#include "MemoryTracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+class FrameArena
+{
+	/*
+	Bump allocator for scratch memory that only lives until the end of a frame.
+	The block is allocated once, allocate() moves a pointer forward and reset()
+	frees everything at once. Nothing is destructed, so only plain types go in
+	*/
+public:
+	FrameArena(const std::size_t _capacity, const memoryTag _tag);
+	~FrameArena();
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+private:
+	std::uint8_t* memory;
+	std::size_t capacity;
+	std::size_t used = 0;
+	std::size_t peak = 0;
+	int overflows = 0;
+	memoryTag tag;
+
+public:
+	void* allocate(const std::size_t size, const std::size_t alignment); // nullptr when the arena is full
+	void reset();
+
+	template <typename T>
+	T* allocate(const int count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+		T* items = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		if (items)
+			for (int i{ 0 }; i < count; i++)
+				new (&items[i]) T();
+		return items;
+	}
+
+	// G&S
+	std::size_t getCapacity() const;
+	std::size_t getUsed() const;
+	std::size_t getPeak() const;	// most bytes used in one frame
+	int getOverflows() const;		// allocations refused because the arena was full
+};
@@ -0,0 +1,222 @@
+#include "FrameCapture.h"
+#include <filesystem>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+FrameCapture::FrameCapture(const int _width, const int _height, const captureFormat _format, const std::string& _outputPath, const bool _ownTarget)
+	:
+	width{ _width }, height{ _height },
+	format{ _format },
+	outputPath{ _outputPath }
+{
+	if (_ownTarget && !target.create(width, height))
+	{
+		throw std::exception();
+	}
+
+	// Preallocate the pool, the game thread never allocates pixel memory after this point
+	buffers.resize(NUM_OF_CAPTURE_BUFFERS);
+	for (int i{ 0 }; i < NUM_OF_CAPTURE_BUFFERS; i++)
+	{
+		buffers[i].pixels.resize(static_cast<size_t>(width) * height * 4);
+		freeBuffers.push_back(i);
+	}
+
+	if (format == CAPTURE_PNG)
+	{
+		std::filesystem::create_directories(outputPath);
+	}
+	else
+	{
+		rawStream.open(outputPath + ".rgba", std::ios::binary);
+		if (!rawStream)
+		{
+			throw std::exception();
+		}
+	}
+
+	// A raw stream has to be written in order, so it only gets a single worker
+	int numOfWorkers = (format == CAPTURE_RAW) ? 1 : NUM_OF_CAPTURE_WORKERS;
+	for (int i{ 0 }; i < numOfWorkers; i++)
+		workers.emplace_back(&FrameCapture::workerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+	stop();
+}
+
+sf::RenderTarget& FrameCapture::getTarget()
+{
+	return target;
+}
+
+const sf::Texture& FrameCapture::getTexture() const
+{
+	return target.getTexture();
+}
+
+void FrameCapture::captureFrame()
+{
+	/*
+	Function finishes the current frame and reads its pixels straight into a pooled buffer
+	(Texture::copyToImage would allocate a new image every frame), the workers flip the rows.
+	It never waits for an encoder, if every buffer is still in use the frame is dropped
+	*/
+	target.display();
+
+	int index = acquireBuffer();
+	if (index == -1)
+		return;
+
+	if (!target.setActive(true))
+	{
+		droppedFrames++;
+		std::lock_guard<std::mutex> lock(queueMutex);
+		freeBuffers.push_back(index);
+		return;
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffers[index].pixels.data());
+	buffers[index].bottomUp = true;
+	submitBuffer(index);
+}
+
+void FrameCapture::captureFrame(const sf::Uint8* pixels)
+{
+	/*
+	Same as captureFrame() for frames that are already in memory (software renderer)
+	*/
+	int index = acquireBuffer();
+	if (index == -1)
+		return;
+
+	std::memcpy(buffers[index].pixels.data(), pixels, buffers[index].pixels.size());
+	buffers[index].bottomUp = false;
+	submitBuffer(index);
+}
+
+int FrameCapture::acquireBuffer()
+{
+	int frameNumber = frameCounter++;
+
+	int index = -1;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (!freeBuffers.empty())
+		{
+			index = freeBuffers.back();
+			freeBuffers.pop_back();
+		}
+	}
+	if (index == -1) // encoders fell behind
+	{
+		droppedFrames++;
+		return -1;
+	}
+
+	buffers[index].frameNumber = frameNumber;
+	return index;
+}
+
+void FrameCapture::submitBuffer(const int index)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		readyBuffers.push_back(index);
+	}
+	queueCondition.notify_one();
+}
+
+void FrameCapture::stop()
+{
+	/*
+	Function lets the workers encode every frame that is still queued and joins them
+	*/
+	if (workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopWorkers = true;
+	}
+	queueCondition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+	workers.clear();
+
+	if (rawStream.is_open())
+		rawStream.close();
+
+	std::cout << "Capture: " << encodedFrames << " frames encoded, " << droppedFrames << " frames dropped\n";
+	if (format == CAPTURE_RAW)
+		std::cout << "Capture: raw stream is " << width << "x" << height << " rgba, one frame per simulated frame\n";
+}
+
+void FrameCapture::workerLoop()
+{
+	/*
+	Function waits for filled buffers, encodes them and gives them back to the pool
+	*/
+	while (true)
+	{
+		int index;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] { return stopWorkers || !readyBuffers.empty(); });
+			if (readyBuffers.empty()) // stopWorkers && nothing left to encode
+				return;
+			index = readyBuffers.front();
+			readyBuffers.pop_front();
+		}
+
+		encodeFrame(buffers[index]);
+		encodedFrames++;
+
+		std::lock_guard<std::mutex> lock(queueMutex);
+		freeBuffers.push_back(index);
+	}
+}
+
+void FrameCapture::encodeFrame(FrameBuffer& frame)
+{
+	if (frame.bottomUp) // in place, the buffer belongs to this worker until it is encoded
+	{
+		const size_t rowBytes = static_cast<size_t>(width) * 4;
+		for (int top{ 0 }, bottom{ height - 1 }; top < bottom; top++, bottom--)
+			std::swap_ranges(frame.pixels.begin() + top * rowBytes, frame.pixels.begin() + (top + 1) * rowBytes, frame.pixels.begin() + bottom * rowBytes);
+		frame.bottomUp = false;
+	}
+
+	if (format == CAPTURE_RAW)
+	{
+		rawStream.write(reinterpret_cast<const char*>(frame.pixels.data()), frame.pixels.size());
+		return;
+	}
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "frame_%06d.png", frame.frameNumber);
+
+	sf::Image image;
+	image.create(width, height, frame.pixels.data());
+	if (!image.saveToFile(outputPath + "/" + fileName))
+		std::cerr << "Error saving " << fileName << "\n";
+}
+
+int FrameCapture::getCapturedFrames() const
+{
+	return frameCounter;
+}
+
+int FrameCapture::getEncodedFrames() const
+{
+	return encodedFrames;
+}
+
+int FrameCapture::getDroppedFrames() const
+{
+	return droppedFrames;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <fstream>
+#include <string>
+
+#define NUM_OF_CAPTURE_BUFFERS 8
+#define NUM_OF_CAPTURE_WORKERS 2
+
+// Capture Format
+enum captureFormat
+{
+	CAPTURE_PNG,	// one png file per frame
+	CAPTURE_RAW,	// a single raw RGBA video stream
+	NUMBER_OF_CAPTURE_FORMATS
+};
+
+class FrameCapture
+{
+public:
+	FrameCapture(const int _width, const int _height, const captureFormat _format, const std::string& _outputPath, const bool _ownTarget = true);
+	~FrameCapture();
+private:
+
+	struct FrameBuffer
+	{
+		std::vector<sf::Uint8> pixels;
+		int frameNumber = 0;
+		bool bottomUp = false;	// rows as OpenGL reads them, the worker flips them
+	};
+
+	// General
+	int width, height;
+	captureFormat format;
+	std::string outputPath;
+	sf::RenderTexture target; // not created when frames come from a CPU framebuffer
+
+	// Buffer Pool
+	std::vector<FrameBuffer> buffers;
+	std::vector<int> freeBuffers;	// indexes of buffers the game thread can fill
+	std::deque<int> readyBuffers;	// indexes of buffers waiting to be encoded
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+
+	// Workers
+	std::vector<std::thread> workers;
+	std::ofstream rawStream;
+	bool stopWorkers = false;
+
+	// Statistics
+	int frameCounter = 0;
+	std::atomic<int> encodedFrames{ 0 };
+	std::atomic<int> droppedFrames{ 0 };
+
+public:
+	sf::RenderTarget& getTarget();
+	const sf::Texture& getTexture() const;
+	void captureFrame();
+	void captureFrame(const sf::Uint8* pixels);
+	void stop();
+
+	// G&S
+	int getCapturedFrames() const;
+	int getEncodedFrames() const;
+	int getDroppedFrames() const;
+
+private:
+	int acquireBuffer();
+	void submitBuffer(const int index);
+	void workerLoop();
+	void encodeFrame(FrameBuffer& frame);
+};
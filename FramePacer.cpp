@@ -0,0 +1,175 @@
+#include "FramePacer.h"
+#include <SFML/System.hpp>
+#include <thread>
+#include <cmath>
+#include <iomanip>
+#include <algorithm>
+
+// Timing Window
+
+void TimingWindow::add(const float sample)
+{
+	samples[next] = sample;
+	next = (next + 1) % PACER_WINDOW;
+	count = std::min(count + 1, PACER_WINDOW);
+}
+
+TimingStats TimingWindow::getStats() const
+{
+	TimingStats stats{ 0.f, 0.f, 0.f, count };
+	if (count == 0)
+		return stats;
+
+	for (int i{ 0 }; i < count; i++)
+	{
+		stats.mean += samples[i];
+		stats.max = std::max(stats.max, samples[i]);
+	}
+	stats.mean /= count;
+	for (int i{ 0 }; i < count; i++)
+		stats.deviation += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+	stats.deviation = std::sqrt(stats.deviation / count);
+	return stats;
+}
+
+// Frame Pacer
+
+FramePacer::FramePacer(const float _frameMs)
+	:
+	frameMs{ _frameMs }
+{
+}
+
+void FramePacer::waitForFrame()
+{
+	/*
+	Function blocks until the next frame is due
+	*/
+	Clock::time_point now = Clock::now();
+	if (!started)
+	{
+		deadline = now;
+		started = true;
+	}
+	else if (vsync)
+		deadline = lastPresent + fromMs(frameMs - workMs - PACER_VSYNC_SAFETY_MS);
+	else
+	{
+		deadline += fromMs(frameMs);
+		if (now - deadline > fromMs(frameMs)) // a long frame, start over instead of rushing frames to catch up
+			deadline = now;
+	}
+
+	if (deadline <= now)
+		return;
+
+	// sleep through most of the wait, the sleep may wake up late
+	Clock::time_point wakeUp = deadline - fromMs(spinMs);
+	if (wakeUp > now)
+	{
+		sf::sleep(sf::microseconds(static_cast<sf::Int64>(toMs(wakeUp - now) * 1000.f))); // raises the timer resolution on Windows, sleep_for does not
+		float overshoot = toMs(Clock::now() - wakeUp);
+		if (overshoot > spinMs)
+			spinMs = overshoot;
+		else
+			spinMs = std::max(PACER_MIN_SPIN_MS, spinMs + PACER_SPIN_DECAY * (overshoot - spinMs));
+	}
+
+	while (Clock::now() < deadline)
+		std::this_thread::yield();
+
+	wakeErrors.add(toMs(Clock::now() - deadline));
+}
+
+void FramePacer::inputConsumed(const std::uint64_t timestamp)
+{
+	/*
+	Function keeps the earliest transition consumed since the last present, the timestamp is on the same steady clock
+	*/
+	Clock::time_point time{ std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(timestamp)) };
+	if (!inputPending || time < inputTime)
+		inputTime = time;
+	inputPending = true;
+}
+
+void FramePacer::framePresented(const float frameWorkMs)
+{
+	Clock::time_point now = Clock::now();
+	if (lastPresent != Clock::time_point())
+		frameIntervals.add(toMs(now - lastPresent));
+	lastPresent = now;
+
+	if (inputPending)
+	{
+		latencies.add(toMs(now - inputTime));
+		inputPending = false;
+	}
+
+	// the estimate jumps up at once and comes down slowly, so one quick frame does not cause a missed blank
+	if (frameWorkMs > workMs)
+		workMs = frameWorkMs;
+	else
+		workMs += PACER_WORK_DECAY * (frameWorkMs - workMs);
+}
+
+void FramePacer::printReport(std::ostream& out) const
+{
+	const char* names[3] = { "wake error", "frame interval", "input latency" };
+	TimingStats stats[3] = { getWakeErrors(), getFrameIntervals(), getLatencies() };
+
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << "frame pacing (" << (vsync ? "vsync" : "sleep + spin") << ", last " << PACER_WINDOW << " frames, ms)\n";
+	out << std::left << std::setw(16) << "" << std::right << std::setw(10) << "mean"
+		<< std::setw(10) << "deviation" << std::setw(10) << "max" << "\n";
+	out << std::fixed << std::setprecision(3);
+	for (int i{ 0 }; i < 3; i++)
+	{
+		out << std::left << std::setw(16) << names[i] << std::right << std::setw(10) << stats[i].mean
+			<< std::setw(10) << stats[i].deviation << std::setw(10) << stats[i].max << "\n";
+	}
+	out << "spin margin " << spinMs << " ms\n";
+	out.flags(flags);
+	out.precision(precision);
+}
+
+// G&S
+void FramePacer::setVsync(const bool _vsync)
+{
+	vsync = _vsync;
+}
+
+bool FramePacer::getVsync() const
+{
+	return vsync;
+}
+
+TimingStats FramePacer::getWakeErrors() const
+{
+	return wakeErrors.getStats();
+}
+
+TimingStats FramePacer::getFrameIntervals() const
+{
+	return frameIntervals.getStats();
+}
+
+TimingStats FramePacer::getLatencies() const
+{
+	return latencies.getStats();
+}
+
+float FramePacer::getSpinMs() const
+{
+	return spinMs;
+}
+
+float FramePacer::toMs(const Clock::duration duration)
+{
+	return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+FramePacer::Clock::duration FramePacer::fromMs(const float ms)
+{
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(ms));
+}
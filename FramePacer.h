@@ -0,0 +1,83 @@
+#pragma once
+
+#include "QualityGovernor.h"
+#include <chrono>
+#include <ostream>
+
+#define PACER_WINDOW 240				// frames the statistics are taken over
+#define PACER_INITIAL_SPIN_MS 2.f		// spin before the deadline until the sleep overshoot is known
+#define PACER_MIN_SPIN_MS 0.25f
+#define PACER_SPIN_DECAY 0.02f			// how fast the spin margin shrinks after sleeps that woke early enough
+#define PACER_WORK_DECAY 0.02f			// how fast the frame work estimate comes down after slow frames
+#define PACER_VSYNC_SAFETY_MS 1.5f		// with vsync the frame is started this much earlier than the work needs
+
+struct TimingStats
+{
+	float mean;
+	float deviation;
+	float max;
+	int count;
+};
+
+class TimingWindow
+{
+	/*
+	The last PACER_WINDOW samples of a duration in ms
+	*/
+private:
+	float samples[PACER_WINDOW]{};
+	int next = 0;
+	int count = 0;
+public:
+	void add(const float sample);
+	TimingStats getStats() const;
+};
+
+class FramePacer
+{
+	/*
+	Starts every frame at its deadline on the steady clock: it sleeps until shortly before it
+	and spins the rest of the way, the spin margin follows how late the sleeps of this system wake up.
+	Without vsync deadlines are one frame apart. With vsync the display paces the frames, the pacer
+	instead delays the start of a frame until just enough time is left to finish it before
+	the next vertical blank, so input is read as late as possible.
+	The time from a key transition the simulation consumed to presenting the frame that shows it is measured
+	*/
+public:
+	FramePacer(const float _frameMs = FRAME_BUDGET_MS);
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	float frameMs;
+	bool vsync = false;
+	bool started = false;
+	bool inputPending = false;
+	Clock::time_point deadline;
+	Clock::time_point lastPresent;
+	Clock::time_point inputTime;
+	float spinMs = PACER_INITIAL_SPIN_MS;
+	float workMs = 0.f; // slowest recent frame, decaying
+
+	TimingWindow wakeErrors;		// frame start - deadline
+	TimingWindow frameIntervals;	// present to present
+	TimingWindow latencies;			// key transition to the present of the frame that showed it
+
+public:
+	void waitForFrame();
+	void inputConsumed(const std::uint64_t timestamp); // a key transition (InputQueue::now() microseconds) the simulation used
+	void framePresented(const float frameWorkMs); // right after the window was displayed
+
+	void printReport(std::ostream& out) const;
+
+	// G&S
+	void setVsync(const bool _vsync);
+	bool getVsync() const;
+	TimingStats getWakeErrors() const;
+	TimingStats getFrameIntervals() const;
+	TimingStats getLatencies() const;
+	float getSpinMs() const;
+
+private:
+	static float toMs(const Clock::duration duration);
+	static Clock::duration fromMs(const float ms);
+};
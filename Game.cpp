@@ -1,67 +1,280 @@
 #include "Game.h"
+#include "FixedMath.h"
+#include "Telemetry.h"
+#include "AllocationHook.h"
 #include <iostream>
+#include <cstdio>
+#include <cassert>
+#include <functional>
 
 
-Game::Game(const int _width, const int _height )
+Game::Game(const int _width, const int _height, const GameOptions& _options)
 	: 
 	width{_width}, height{_height},
+	options{ _options },
 	currentAppState{ STATE_MENU }
 {
-	// Create a Non Resizable window
-	window = new sf::RenderWindow(sf::VideoMode(_width, _height), "Asteroids Game" , sf::Style::Titlebar | sf::Style::Close);
-	window->setFramerateLimit(FPS);
+	if (!options.headless)
+	{
+		// Create a Non Resizable window
+		window = new sf::RenderWindow(sf::VideoMode(_width, _height), "Asteroids Game", sf::Style::Titlebar | sf::Style::Close);
+		window->setVerticalSyncEnabled(options.vsync); // frames are paced by the FramePacer, not setFramerateLimit's coarse sleep
+		pacer.setVsync(options.vsync);
+	}
+
+	if (options.capture)
+	{
+		frameCapture = new FrameCapture(_width, _height, options.captureRaw ? CAPTURE_RAW : CAPTURE_PNG, options.captureOutput, !options.softwareRenderer);
+	}
+
+	if (options.softwareRenderer)
+	{
+		renderer = new SoftwareRenderBackend(_width, _height);
+		if (window) windowTexture.create(_width, _height);
+	}
+	else
+	{
+		// draw into the capture texture, the window or (headless) an offscreen texture
+		sf::RenderTarget* renderTarget = window;
+		if (frameCapture)
+			renderTarget = &frameCapture->getTarget();
+		else if (options.headless)
+		{
+			headlessTarget.create(_width, _height);
+			renderTarget = &headlessTarget;
+		}
+		renderer = new SfmlRenderBackend(*renderTarget);
+	}
+
+	if (options.telemetry)
+	{
+		Telemetry::start(options.telemetryFile);
+		Telemetry::registerThread();
+	}
 
 	// Try to Load necessary Files
 	loadTextures();
+	const int poolSize = std::max(ASTEROID_POOL_SIZE, 2 * options.numOfAsteroids); // room for every asteroid to split once
+	asteroidPool = new AsteroidPool(asteroidTextureLevel0, asteroidTextureLevel1, poolSize);
+	asteroidSolver = new AsteroidSolver(options.solverThreads);
+	asteroidSolver->reserve(poolSize);
+	asteroids.reserve(poolSize);
+	asteroidIndex.reserve(poolSize);
+	contacts.reserve(1 + NUMBER_OF_BULLETS, poolSize);
+	asteroidBounds.reserve(poolSize);
+	const size_t stateBytes = SNAPSHOT_RESERVED_STATE_BYTES * (poolSize / ASTEROID_POOL_SIZE + 1);
+	stateBuffer.reserve(stateBytes);
+	snapshots.reserveState(stateBytes);
 	loadAudio();
+	if (window && options.music) soundtrack.load(); // nobody listens to headless runs
 	setupMainWindow();
+	setupOverlay();
+	setupText();
+	governor.setEnabled(options.qualityGovernor);
+	showOverlay = options.overlay;
+
+	if (!options.replayFile.empty())
+	{
+		if (!replayPlayer.open(options.replayFile))
+			throw std::exception();
+		replaying = true;
+		options.fixedPoint = options.fixedPoint || (replayPlayer.getFlags() & REPLAY_FLAG_FIXED_POINT);
+		options.preciseCollision = (replayPlayer.getFlags() & REPLAY_FLAG_PRECISE_COLLISION) != 0;
+	}
+	governor.setPreciseCollision(options.preciseCollision);
+	FixedMath::setEnabled(options.fixedPoint);
+	if (replaying || !options.recordReplayFile.empty())
+		governor.setEnabled(false); // quality levels change collisions and spawns, replays are recorded and played at full quality
+	if (window && !options.autopilot && !replaying)
+		inputThread = new InputThread(inputQueue);
+	if (!options.metricsName.empty() && !metrics.create(options.metricsName))
+		std::cerr << "Metrics could not be published to shared memory " << options.metricsName << "\n";
+	if (!options.leaderboardHost.empty() && !replaying) // a replayed game was submitted when it was played
+		leaderboard = new LeaderboardClient(options.leaderboardHost, options.leaderboardPort);
+
+	if (options.headless) // nobody is there to press Play
+	{
+		setupGame();
+		currentAppState = STATE_GAME;
+	}
+
+	if (!options.snapshotFile.empty())
+	{
+		if (!gameStarted) setupGame();
+		if (!loadSnapshotFile(options.snapshotFile))
+			throw std::exception();
+		currentAppState = STATE_GAME;
+	}
 }
 
 Game::~Game()
 {
+	delete inputThread;
+	delete leaderboard; // results not delivered yet stay in the outbox for the next start
+	delete renderer;
+	delete frameCapture; // finishes encoding queued frames
 	delete window;
 	deallocateMemory();
+	delete asteroidPool;
+	delete asteroidSolver;
+	MemoryTracker::release(MEMORY_AUDIO, audioBytes);
+	if (options.memoryReport)
+		MemoryTracker::printReport(std::cout);
+	if (options.pacingReport)
+		pacer.printReport(std::cout);
+	Telemetry::stop();
 }
 
 // Rendering
 
 void Game::deallocateMemory()
 {
+	/*
+	Function deletes the player and returns the asteroids to the pool,
+	the game has to be set up again before it is simulated or drawn
+	*/
+	scripts.clear();
 	delete player;
+	player = nullptr;
 	for (auto* asteroid : asteroids)
 	{
-		delete asteroid;
+		asteroidPool->release(asteroid);
 	}
-	asteroids.clear();
+	asteroids.clear(); // keeps its capacity for the next game
+	gameStarted = false;
 }
 
 void Game::run()
 {
 	/*
 	Function contains the Main Game Loop()
-	it takes care of Game Logic
+	it takes care of Game Logic, the game is simulated in fixed SIM_TICK_MS ticks
+	and drawn once per frame, so game play does not depend on the frame rate.
+	The wait for the next frame comes first, so input is read right before it is simulated
 	*/
 
 	sf::Clock clock;
-	while (window->isOpen())
+	float accumulator = 0.f;
+	while (isRunning())
 	{
-		float dt = clock.restart().asMilliseconds(); // restarts the timer and returns the time since last restart
-		if(currentAppState == STATE_GAME) isGameOver();
-		checkForCollision();
-		render(dt); // pass dt, to render function to ensure Frame Indepented Game Play
-	
+		if (window) pacer.waitForFrame(); // headless runs are not paced by a display
+
+		float frameTime = clock.restart().asMicroseconds() / 1000.f; // restarts the timer and returns the time since last restart
+		std::uint64_t frameTimestamp = InputQueue::now();
+		frameWorkClock.restart();
+		frameArena.reset();
+		averageFrameTime += 0.1f * (frameTime - averageFrameTime);
+		Telemetry::record(TELEMETRY_FRAME, 0.f, 0.f, frameTime); // measured, headless this is the work of the last frame
+		if (options.headless) frameTime = SIM_TICK_MS; // headless runs are not paced by a display
+
+		if (window)
+		{
+			handleUserInput();
+			soundtrack.update(currentAppState == STATE_GAME ? TRACK_GAME : TRACK_MENU, frameTime);
+		}
+		std::uint64_t inputDone = InputQueue::now();
+
+#ifndef NDEBUG
+		const bool checkAllocations = currentAppState == STATE_GAME && !rewinding && gameTick > ALLOCATION_WARMUP_TICKS;
+		long long allocationsBefore = AllocationHook::getThreadAllocations();
+#endif
+		accumulator += std::min(frameTime, MAX_FRAME_MS);
+		while (accumulator >= SIM_TICK_MS)
+		{
+			// the tick ends where the simulated time does, later key transitions wait for the next frame
+			tickEndTime = frameTimestamp - static_cast<std::uint64_t>((accumulator - SIM_TICK_MS) * 1000.f);
+			simulate();
+			metrics.add(METRIC_TICKS, 1);
+			accumulator -= SIM_TICK_MS;
+		}
+		std::uint64_t simulateDone = InputQueue::now();
+
+		render();
+#ifndef NDEBUG
+		// pools, lists, the snapshot ring and the text batch are allocated up front, the ticks and
+		// the drawing of a frame of a warmed up game do not touch the heap (a game that just ended may)
+		assert(!checkAllocations || currentAppState != STATE_GAME || AllocationHook::getThreadAllocations() == allocationsBefore);
+#endif
+		if (metrics.isOpen())
+			publishMetrics(frameTime, frameTimestamp, inputDone, simulateDone);
+
+		if (frameTime > FRAME_SPIKE_MS && currentAppState == STATE_GAME && snapshots.latest(stateBuffer))
+			dumpSnapshot(stateBuffer, gameTick);
+		frameNumber++;
 	}
 }
 
-void Game::render(const float dt)
+void Game::simulate()
+{
+	/*
+	Function advances the game by one tick
+	*/
+	timerWheel.advance();
+	Telemetry::setTick(timerWheel.getNow());
+
+	if (inputThread) // transitions are consumed in every state, so the held keys stay known
+	{
+		const std::uint64_t tickLength = static_cast<std::uint64_t>(SIM_TICK_MS * 1000.f);
+		std::uint64_t transition = inputQueue.collectTick(std::max(tickStartTime, tickEndTime - tickLength), tickEndTime, keyboardInput);
+		if (transition != 0)
+			pacer.inputConsumed(transition); // latency is measured from the key, not from when the frame polled events
+		tickStartTime = tickEndTime;
+	}
+
+	if (currentAppState != STATE_GAME || rewinding || !player)
+		return;
+
+	handleGameInput(SIM_TICK_MS);
+	updateGame(SIM_TICK_MS);
+	checkForCollision();
+	scripts.tick();
+	recordSnapshot();
+	isGameOver();
+}
+
+void Game::runRenderBenchmark()
+{
+	/*
+	Function simulates the game for options.renderBenchmarkFrames frames
+	and prints how long drawing them took
+	*/
+	if (!gameStarted) setupGame();
+	currentAppState = STATE_GAME;
+
+	sf::Clock clock;
+	sf::Int64 renderTime = 0;
+	for (int i{ 0 }; i < options.renderBenchmarkFrames && currentAppState == STATE_GAME; i++)
+	{
+		simulate();
+		clock.restart();
+		frameArena.reset();
+		render();
+		renderTime += clock.getElapsedTime().asMicroseconds();
+		frameNumber++;
+	}
+
+	double msPerFrame = renderTime / 1000.0 / std::max(frameNumber, 1);
+	std::cout << (options.softwareRenderer ? "software" : "sfml") << " renderer: " << frameNumber << " frames, "
+		<< msPerFrame << " ms per frame (" << 1000.0 / msPerFrame << " fps), " << asteroids.size() << " asteroids\n";
+}
+
+bool Game::isRunning()
+{
+	if (quitRequested)
+		return false;
+	if (options.headless)
+		return frameNumber < options.headlessFrames;
+	return window->isOpen();
+}
+
+void Game::render()
 {
 	/*
 	Function calls the appropriate draw member function which 
 	corresponds to the Current Application State
 	*/
-	handleUserInput(dt);
-
-	window->clear();
+	renderer->clear();
+	textBatch.clear();
 
 	switch (currentAppState)
 	{
@@ -69,26 +282,75 @@ void Game::render(const float dt)
 		drawMenuWindow();
 		break;
 	case STATE_GAME:
-		drawGameWindow(dt);
+		drawGameWindow();
 		break;
 	case STATE_SCORELIST:
 		drawScoreWindow();
 		break;
 	}
 
-	window->display();
+	if (showOverlay)
+		drawOverlay();
+
+	// all text at once, on top of the scene
+	textBatch.draw(*renderer);
+
+	present();
 }
 
-void Game::handleUserInput(const float dt)
+void Game::present()
+{
+	/*
+	Function hands the finished frame to the capture workers (if capturing)
+	and shows it in the window (if there is one)
+	*/
+	renderer->display();
+	float frameWork = frameWorkClock.getElapsedTime().asMicroseconds() / 1000.f; // without the wait for the display
+	governor.addFrame(frameWork);
+
+	if (const sf::Uint8* pixels = renderer->getPixels()) // the frame is already in memory
+	{
+		if (frameCapture)
+			frameCapture->captureFrame(pixels);
+		if (window)
+		{
+			windowTexture.update(pixels);
+			window->clear();
+			window->draw(sf::Sprite(windowTexture));
+		}
+	}
+	else if (frameCapture)
+	{
+		frameCapture->captureFrame();
+		if (window)
+		{
+			window->clear();
+			window->draw(sf::Sprite(frameCapture->getTexture()));
+		}
+	}
+	if (window)
+	{
+		window->display();
+		pacer.framePresented(frameWork);
+	}
+}
+
+void Game::handleUserInput()
 {
 	/*
 	Function takes care of User Input, it modifies the state of the Game Object
-	the meaning of specific key events changes based on the current Application State
+	the meaning of specific key events changes based on the current Application State.
+	Keys held during the game are read every tick by handleGameInput
 	*/
 	while (window->pollEvent(event))
 	{
 		if (event.type == sf::Event::Closed)
 			window->close();
+
+		if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::F3)
+			showOverlay = !showOverlay;
+		if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::F4)
+			MemoryTracker::printReport(std::cout);
 		
 		switch (currentAppState)
 		{
@@ -97,7 +359,7 @@ void Game::handleUserInput(const float dt)
 
 			if (event.type == event.KeyReleased)
 			{
-				keyPressedSound.play(); 
+				playSound(keyPressedSound); 
 				switch (event.key.code)
 				{
 				case sf::Keyboard::Up:
@@ -119,7 +381,7 @@ void Game::handleUserInput(const float dt)
 		case STATE_SCORELIST:
 			if (event.type == event.KeyReleased)
 			{
-				keyPressedSound.play();
+				playSound(keyPressedSound);
 
 				switch (event.key.code)
 				{
@@ -136,31 +398,88 @@ void Game::handleUserInput(const float dt)
 		}
 	}// Event Loop()
 
-	if (currentAppState == STATE_GAME)
-	{
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left))
-			player->rotatePlayer(dt, -1); // rotatePlayer in negative direction
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right))
-			player->rotatePlayer(dt, +1); // rotatePlayer in positive direction
+	// Holding Backspace rewinds the game one tick per frame, releasing it resumes from there
+	// replays have no way back in time, so rewinding is off while one is recorded or played
+	rewinding = currentAppState == STATE_GAME && !replaying && !replayRecorder.isOpen()
+		&& sf::Keyboard::isKeyPressed(sf::Keyboard::BackSpace) && rewindTo(gameTick - 1);
+}
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
+void Game::handleGameInput(const float dt)
+{
+	/*
+	Function applies the input of this tick (a replay, the autopilot or the keys) to the player,
+	rotation and thrust last as long as the key was held in the tick, a tap fires even when it was released again
+	*/
+	TickInput input;
+	if (replaying)
+	{
+		if (!replayPlayer.read(gameTick, input))
 		{
-			if (player->currentState == STATE_STATIONARY) // if player just pressed the Up Arrow Key
-			{
-				player->startRocketThrustTimer(); // start the thrust timer
-				accelerationSound.play();
-			}
-			player->movePlayer(dt);
+			finishReplay("Replay ended");
+			return;
 		}
-		else
-			player->slowDown();
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space) && !player->readyBullets.empty())
+	}
+	else if (options.autopilot)
+	{
+		PlayerInput decided = getAutopilotInput();
+		const bool controls[NUMBER_OF_INPUT_CONTROLS] = { decided.rotateLeft, decided.rotateRight, decided.thrust, decided.fire };
+		for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
 		{
-			player->shootBullet();
-			shotSound.play();
+			input.held[c] = controls[c] ? 1.f : 0.f;
+			input.down[c] = controls[c];
 		}
-	}// currentAppState == STATE_GAME
+	}
+	else if (inputThread)
+		input = keyboardInput;
+	else // nobody is at the keyboard in headless runs
+		return;
+	replayRecorder.record(gameTick, input);
+
+	if (input.held[INPUT_ROTATE_LEFT] > 0.f)
+		player->rotatePlayer(dt * input.held[INPUT_ROTATE_LEFT], -1); // rotatePlayer in negative direction
+	if (input.held[INPUT_ROTATE_RIGHT] > 0.f)
+		player->rotatePlayer(dt * input.held[INPUT_ROTATE_RIGHT], +1); // rotatePlayer in positive direction
+
+	if (input.held[INPUT_THRUST] > 0.f)
+	{
+		bool engineStarts = player->currentState == STATE_STATIONARY;
+		if (engineStarts) // if player just pressed the Up Arrow Key
+		{
+			player->startRocketThrustTimer(); // start the thrust timer
+			playSound(accelerationSound);
+		}
+		player->movePlayer(dt * input.held[INPUT_THRUST]);
+		particles.emitThrust(player->getPosition().x, player->getPosition().y, player->getRotation(), engineStarts,
+			governor.getEffectsScale() * (engineStarts ? 1.f : input.held[INPUT_THRUST]));
+	}
+	else
+		player->slowDown();
+	if (input.down[INPUT_FIRE] && !player->readyBullets.empty())
+	{
+		player->shootBullet();
+		playSound(shotSound);
+	}
+}
 
+PlayerInput Game::getAutopilotInput()
+{
+	/*
+	Function indexes the asteroids and lets the autopilot pick the controls for this tick
+	*/
+	asteroidIndex.clear();
+	for (int i{ 0 }; i < static_cast<int>(asteroids.size()); i++)
+	{
+		sf::Vector2f velocity = asteroids[i]->getVelocity();
+		asteroidIndex.insert({ asteroids[i]->getPosition().x, asteroids[i]->getPosition().y, velocity.x, velocity.y,
+			asteroids[i]->getGlobalBounds().width / 2, i });
+	}
+	asteroidIndex.build();
+
+	ShipState ship{ player->getPosition().x, player->getPosition().y, player->getRotation(),
+		player->getGlobalBounds().width / 2, player->canShoot() };
+	PlayerInput input;
+	autopilot.decide(asteroidIndex, ship, input);
+	return input;
 }
 
 void Game::menuMoveUp()
@@ -231,6 +550,7 @@ void Game::setupMainWindow()
 	for (int i{ 0 }; i < NUM_OF_MAIN_WINDOW_COMPONENTS; i++)
 	{
 		menuComponents[i].setFont(font);
+		menuComponents[i].setCharacterSize(TEXT_CHARACTER_SIZE);
 		switch (i)
 		{
 		case 0:
@@ -261,6 +581,7 @@ void Game::setupScoreWindow()
 	for (int i{ 0 }; i < NUM_OF_SCORE_WINDOW_COMPONENTS; i++)
 	{
 		scoreComponents[i].setFont(font);
+		scoreComponents[i].setCharacterSize(TEXT_CHARACTER_SIZE);
 		if(i==0) 
 			scoreComponents[i].setString("Top Scores:");
 		else if (i > 0 && i < NUM_OF_SCORE_COMPONENTS + 1)
@@ -287,14 +608,30 @@ void Game::setupGame()
 	Function creates all game objects: the player (that creates bullets) and the
 	asteroids, it also creates the game window components
 	*/
-	player = new Player(playerTexture, bulletTexture);
-
-	for (int i{ 0 }; i < NUM_OF_ASTEROIDS; i++)
-		asteroids.push_back(new Asteroid(asteroidTextureLevel0 , asteroidTextureLevel1));
+	deallocateMemory(); // a game still running is freed, not leaked
+
+	// a replay starts from the same seed as the game it recorded, only the first game is recorded
+	gameSeed = replaying ? replayPlayer.getSeed() : static_cast<std::uint32_t>(InputQueue::now());
+	numOfSpawns = 0;
+	contacts.clear();
+	if (!replaying && !options.recordReplayFile.empty() && replayRecorder.getNumOfRecords() == 0 && !replayRecorder.isOpen())
+		replayRecorder.open(options.recordReplayFile, gameSeed, (options.fixedPoint ? REPLAY_FLAG_FIXED_POINT : 0) | (options.preciseCollision ? REPLAY_FLAG_PRECISE_COLLISION : 0));
+
+	player = new Player(playerTexture, bulletTexture, timerWheel);
+	gameTick = 0;
+	snapshots.clear();
+	particles.clear();
+
+	wave = 0;
+	waveSpawned = false;
+	waveStartTick = 0;
+	numOfWaveAsteroids = 0;
+	scripts.start(levelScript(false));
 	
 	for (int i{ 0 }; i < NUM_OF_GAME_WINDOW_COMPONENTS; i++)
 	{
 		gameComponents[i].setFont(font);
+		gameComponents[i].setCharacterSize(TEXT_CHARACTER_SIZE);
 		if (i == 0)
 		{
 			gameComponents[i].setString("Lives: " + std::to_string(player->getHealth()));
@@ -311,7 +648,126 @@ void Game::setupGame()
 
 }
 
+Asteroid* Game::spawnAsteroid(const int level)
+{
+	/*
+	Function takes an asteroid from the pool with the next random stream of the game,
+	so what it does depends only on the seed and how many asteroids came before it
+	*/
+	return asteroidPool->acquire(CounterRandom(gameSeed, numOfSpawns++), level);
+}
+
+Script Game::levelScript(const bool resumed)
+{
+	/*
+	Function is the flow of a game: the starting field of asteroids, then waves of faster ones
+	coming in from a ring around the screen, each WAVE_DELAY_MS after the last was cleared.
+	Its progress is kept in members, so a loaded snapshot resumes it on the same tick
+	*/
+	if (!resumed)
+	{
+		for (int i{ 0 }; i < options.numOfAsteroids; i++)
+		{
+			asteroids.push_back(spawnAsteroid(1));
+			Telemetry::record(TELEMETRY_SPAWN, asteroids.back()->getPosition().x, asteroids.back()->getPosition().y, 1.f);
+		}
+	}
+
+	auto ticksDone = [this]() { return gameTick + (scripts.isTicking() ? 1 : 0); }; // gameTick counts the tick being simulated once it is recorded
+	for (;;)
+	{
+		if (!waveSpawned)
+		{
+			co_await scripts.waitTicks(std::max(0, waveStartTick + static_cast<int>(msToTicks(WAVE_DELAY_MS)) - ticksDone()));
+			spawnWave(++wave);
+			waveSpawned = true;
+		}
+		if (numOfWaveAsteroids > 0) // none when the pool or the governor had no room
+			co_await scripts.waitFor(waveCleared);
+		waveSpawned = false;
+		waveStartTick = ticksDone();
+	}
+}
+
+void Game::spawnWave(const int number)
+{
+	/*
+	Function puts the asteroids of a wave on a ring around the screen, all heading for its centre.
+	Directions come from the fixed-point sine table, so waves are the same on every machine
+	*/
+	const int size = WAVE_FIRST_SIZE + WAVE_GROWTH * (number - 1);
+	const float speed = WAVE_SPEED + WAVE_SPEEDUP * (number - 1);
+	const float radius = std::max(width, height) / 2.f + WAVE_RING_MARGIN;
+	Asteroid* asteroid = nullptr;
+	for (int i{ 0 }; i < size && governor.allowsSpawn(static_cast<int>(asteroids.size())) && (asteroid = spawnAsteroid(1)); i++)
+	{
+		const float degrees = 360.f * i / size;
+		const sf::Vector2f outwards(
+			FixedMath::sinDegrees(degrees) / static_cast<float>(1 << FIXED_TRIG_BITS),
+			-FixedMath::cosDegrees(degrees) / static_cast<float>(1 << FIXED_TRIG_BITS));
+		asteroid->setPosition(width / 2.f + radius * outwards.x, height / 2.f + radius * outwards.y);
+		asteroid->setVelocity(-speed * outwards);
+		asteroid->setExpendable(true);
+		asteroids.push_back(asteroid);
+		numOfWaveAsteroids++;
+		Telemetry::record(TELEMETRY_SPAWN, asteroid->getPosition().x, asteroid->getPosition().y, 1.f);
+	}
+}
+
+void Game::removeAsteroid(const int index)
+{
+	/*
+	Function returns an expendable asteroid to the pool, the last asteroid takes its index
+	*/
+	asteroidPool->release(asteroids[index]);
+	const int last = static_cast<int>(asteroids.size()) - 1;
+	asteroids[index] = asteroids[last];
+	asteroids.pop_back();
+	contacts.removeTarget(index, last);
+	if (--numOfWaveAsteroids == 0)
+		waveCleared.raise();
+}
+
+void Game::setupOverlay()
+{
+	/*
+	Function creates the debug overlay (F3), it shows frame times, pacing, input latency and the current quality level
+	*/
+	overlayText.setFont(font);
+	overlayText.setCharacterSize(OVERLAY_CHARACTER_SIZE);
+	overlayText.setFillColor(sf::Color::Yellow);
+	overlayText.setPosition(sf::Vector2f(4.f, static_cast<float>(height) - 74.f));
+}
+
+void Game::setupText()
+{
+	/*
+	Function rasterizes every character at every size the game draws text in before the first frame,
+	text drawn later never waits for the font or uploads a texture
+	*/
+	const unsigned characterSizes[] = { TEXT_CHARACTER_SIZE, OVERLAY_CHARACTER_SIZE };
+	if (!textBatch.prewarm(font, characterSizes, 2))
+	{
+		throw std::exception();
+	}
+	renderer->prepareTexture(textBatch.getAtlas());
+	renderer->reserveDrawCalls(SOFTWARE_RESERVED_COMMANDS + asteroidPool->getSize() + PARTICLE_BUDGET + TEXT_BATCH_MAX_GLYPHS);
+}
+
 // Draw
+static void setTextString(sf::Text& text, sf::String& string, const char* characters)
+{
+	/*
+	Function fills string one character at a time, unlike sf::String(const char*) this
+	reuses its capacity, and only hands it to text when it changed
+	*/
+	string.clear();
+	for (const char* character{ characters }; *character != '\0'; character++)
+		string += sf::String(static_cast<sf::Uint32>(static_cast<unsigned char>(*character)));
+	if (string != text.getString())
+		text.setString(string);
+}
+
 void Game::drawMenuWindow()
 {
 	/*
@@ -319,7 +775,7 @@ void Game::drawMenuWindow()
 	*/
 	for (auto& menuComponent : menuComponents)
 	{
-		window->draw(menuComponent);
+		textBatch.add(menuComponent);
 	}
 }
 
@@ -331,77 +787,223 @@ void Game::drawScoreWindow()
 
 	for (auto& scoreComponent : scoreComponents)
 	{
-		window->draw(scoreComponent);
+		textBatch.add(scoreComponent);
 	}
 }
 
-void Game::drawGameWindow(const float dt)
+void Game::drawGameWindow()
 {
 	/*
 	Function draws all Game Window components
 	and all Game Objects
 	*/
+	if (!player) // game over, nothing to draw until the next setupGame
+		return;
+
+	bool relayoutHud = governor.allowsHudRelayout(frameNumber);
+	char* line = frameArena.allocate<char>(HUD_LINE_LENGTH);
 	for (int i{ 0 }; i < NUM_OF_GAME_WINDOW_COMPONENTS; i++)
 	{
-		if (i == 0)
-			gameComponents[i].setString("Lives: " + std::to_string(player->getHealth()));
+		if (i == 0 && relayoutHud && line)
+		{
+			std::snprintf(line, HUD_LINE_LENGTH, "Lives: %d", player->getHealth());
+			setTextString(gameComponents[i], gameStrings[i], line);
+		}
 
-		if (i == 1)
-			gameComponents[i].setString("Score: " + std::to_string(player->getScore()));
+		if (i == 1 && relayoutHud && line)
+		{
+			std::snprintf(line, HUD_LINE_LENGTH, "Score: %d", player->getScore());
+			setTextString(gameComponents[i], gameStrings[i], line);
+		}
 
-		window->draw(gameComponents[i]);
+		textBatch.add(gameComponents[i]);
 	}
 
+	// draw Particles, under the ships and asteroids
+	particles.buildVertices();
+	renderer->drawVertices(particles.getVertices(), particles.getNumOfVertices(), sf::Quads);
+
 	// draw player
-	window->draw(*player);
+	renderer->drawSprite(*player);
 
 	// draw Bullets 
-	if ( !player->movingBullets.empty() ) // if there are any bullets flying around
-	{
-		player->moveBullets(dt);
-		for(auto* bullet : player->movingBullets)
-			window->draw(*bullet);
-	}
+	for(auto* bullet : player->movingBullets)
+		renderer->drawSprite(*bullet);
 
 	// draw Asteroids
 	for (auto* asteroid : asteroids)
+		renderer->drawSprite(*asteroid);
+}
+
+void Game::drawOverlay()
+{
+	if (frameNumber % HUD_REFRESH_FRAMES == 0)
 	{
-		asteroid->moveAsteroid(dt);
-		window->draw(*asteroid);
+		long long liveBytes = 0;
+		for (int i{ 0 }; i < NUMBER_OF_MEMORY_TAGS; i++)
+			liveBytes += MemoryTracker::getStats(static_cast<memoryTag>(i)).liveBytes;
+
+		char* line = frameArena.allocate<char>(OVERLAY_LINE_LENGTH);
+		if (line)
+		{
+			TimingStats intervals = pacer.getFrameIntervals();
+			TimingStats latencies = pacer.getLatencies();
+			std::snprintf(line, OVERLAY_LINE_LENGTH, "%.0f fps  frame %.2f ms / %.2f ms budget\nquality %d: %s\n"
+				"pacing +-%.3f ms  input latency %.2f ms (max %.2f)\nmemory %lld KB, frame arena peak %zu B (F4 report)",
+				1000.f / std::max(averageFrameTime, 0.001f), governor.getAverageFrameTime(), governor.getBudget(),
+				static_cast<int>(governor.getLevel()), governor.getLevelName(), intervals.deviation, latencies.mean, latencies.max,
+				liveBytes / 1024, frameArena.getPeak());
+			setTextString(overlayText, overlayString, line);
+		}
 	}
+	textBatch.add(overlayText);
 }
 
 // Game Logic
 
+void Game::updateGame(const float dt)
+{
+	/*
+	Function moves all Game Objects by one tick
+	*/
+	if ( !player->movingBullets.empty() ) // if there are any bullets flying around
+		player->moveBullets(dt);
+
+	for (auto* asteroid : asteroids)
+		asteroid->moveAsteroid(dt);
+	resolveAsteroidCollisions();
+
+	particles.update(dt);
+}
+
+void Game::resolveAsteroidCollisions()
+{
+	/*
+	Function lets the asteroids bounce off each other, only asteroids the solver
+	moved are written back, so the others keep their exact speed and direction
+	*/
+	const int n = static_cast<int>(asteroids.size());
+	asteroidSolver->resize(n);
+	for (int i{ 0 }; i < n; i++)
+	{
+		sf::Vector2f position = asteroids[i]->getPosition();
+		sf::Vector2f velocity = asteroids[i]->getVelocity();
+		asteroidSolver->x[i] = position.x;
+		asteroidSolver->y[i] = position.y;
+		asteroidSolver->vx[i] = velocity.x;
+		asteroidSolver->vy[i] = velocity.y;
+		asteroidSolver->radius[i] = asteroids[i]->getRadius();
+		asteroidSolver->inverseMass[i] = 1.f / asteroids[i]->getMass();
+	}
+
+	asteroidSolver->solve();
+	if (asteroidSolver->getNumOfContacts() == 0)
+		return;
+
+	for (int i{ 0 }; i < n; i++)
+	{
+		sf::Vector2f position = asteroids[i]->getPosition();
+		sf::Vector2f velocity = asteroids[i]->getVelocity();
+		if (asteroidSolver->x[i] != position.x || asteroidSolver->y[i] != position.y)
+			asteroids[i]->setPosition(asteroidSolver->x[i], asteroidSolver->y[i]);
+		if (asteroidSolver->vx[i] != velocity.x || asteroidSolver->vy[i] != velocity.y)
+			asteroids[i]->setVelocity(sf::Vector2f(asteroidSolver->vx[i], asteroidSolver->vy[i]));
+	}
+}
+
 void Game::checkForCollision()
 {
 	/*
 	Function checks for collision between Player and all Asteroids
-	and collision between currently moving bullets and all Asteroids
+	and collision between currently moving bullets and all Asteroids.
+	Only contacts that begin this tick count: the ship loses one life per asteroid it runs into,
+	a bullet is spent on the first asteroid it touches and an asteroid breaks once per tick.
+	A small wave asteroid that is hit is gone, the last wave asteroid raises waveCleared
 	*/
-	int index = 0;
 	int deadAsteroidIndex = -1;
+	bool precise = governor.usesPreciseCollision();
 
-	for (auto* asteroid : asteroids)
+	contacts.setNumOfTargets(static_cast<int>(asteroids.size()));
+	asteroidBounds.resize(asteroids.size());
+	for (int i{ 0 }; i < static_cast<int>(asteroids.size()); i++)
 	{
-		player->playerCollides(asteroid);
+		asteroidBounds[i] = GameRules::asteroidBounds(asteroids[i]->getPosition());
+		ContactManager::boundingCircle(asteroidBounds[i], contacts.targetX[i], contacts.targetY[i], contacts.targetRadius[i]);
+	}
+
+	std::array<sf::FloatRect, 1 + NUMBER_OF_BULLETS> probeBounds{};
+	std::array<Bullet*, 1 + NUMBER_OF_BULLETS> probeBullets{};
+	float x, y, radius;
+	probeBounds[0] = GameRules::shipBounds(player->getPosition(), player->getRotation());
+	ContactManager::boundingCircle(probeBounds[0], x, y, radius);
+	contacts.setProbe(0, x, y, radius);
+	for (int i{ 0 }; i < player->movingBullets.size(); i++)
+	{
+		Bullet* bullet = player->movingBullets[i];
+		probeBounds[1 + bullet->id] = GameRules::bulletBounds(bullet->getPosition(), bullet->angle);
+		ContactManager::boundingCircle(probeBounds[1 + bullet->id], x, y, radius);
+		contacts.setProbe(1 + bullet->id, x, y, radius);
+		probeBullets[1 + bullet->id] = bullet;
+	}
 
+	contacts.update([&](const int probe, const int target) { return GameRules::overlaps(probeBounds[probe], asteroidBounds[target], precise); });
+
+	std::array<bool, 1 + NUMBER_OF_BULLETS> spentBullets{};
+	std::array<int, NUMBER_OF_BULLETS> brokenAsteroids{};
+	int numOfBroken = 0;
+	std::array<int, NUMBER_OF_BULLETS> removedAsteroids{};
+	int numOfRemoved = 0;
+	for (const ContactEvent& event : contacts.getEvents())
+	{
+		if (event.phase != CONTACT_BEGIN)
+			continue;
+		if (event.probe == 0)
+		{
+			player->takeDamage();
+			continue;
+		}
+
+		Bullet* bullet = probeBullets[event.probe];
+		if (spentBullets[event.probe])
+			continue; // already hit another asteroid this tick
+		spentBullets[event.probe] = true;
+		if (std::find(brokenAsteroids.begin(), brokenAsteroids.begin() + numOfBroken, event.target) != brokenAsteroids.begin() + numOfBroken)
+		{
+			player->spendBullet(bullet); // the asteroid already broke, the bullet still hit it
+			continue;
+		}
+
+		Asteroid* asteroid = asteroids[event.target];
 		int levelBeforeCollisionCheck = asteroid->getLevel();
-		if (!player->movingBullets.empty()) // if there are any bullets flying around
-			player->bulletCollides(asteroid);
-		if (asteroid->getLevel() != levelBeforeCollisionCheck) // if level of asteroid changed, collision accured, so we save the asteroid we want to destroy -> generate new ones
+		player->bulletHits(bullet, asteroid);
+		brokenAsteroids[numOfBroken++] = event.target;
+		if (asteroid->isExpendable() && levelBeforeCollisionCheck == 0)
+			removedAsteroids[numOfRemoved++] = event.target;
+		else
 		{
-			deadAsteroidIndex = index;
-			largeExplosion.play();
+			asteroid->downSize();
+			deadAsteroidIndex = event.target; // save the asteroid we want to destroy -> generate new ones
 		}
-		index++;
+		playSound(largeExplosion);
+		particles.emitExplosion(asteroid->getPosition().x, asteroid->getPosition().y, levelBeforeCollisionCheck, governor.getEffectsScale());
 	}
-	if (deadAsteroidIndex != -1) // if asteroid was just destroyed
+	Asteroid* newAsteroid = nullptr;
+	if (deadAsteroidIndex != -1 && governor.allowsSpawn(static_cast<int>(asteroids.size())) && (newAsteroid = spawnAsteroid(0))) // if asteroid was just destroyed
 	{
-		asteroids.push_back(new Asteroid(asteroidTextureLevel0,asteroidTextureLevel1,0)); // create another asteroid
+		asteroids.push_back(newAsteroid); // create another asteroid
 		asteroids.back()->setPosition(asteroids[deadAsteroidIndex]->getPosition()); 
+		if (asteroids[deadAsteroidIndex]->isExpendable()) // both halves of a wave asteroid belong to the wave
+		{
+			asteroids.back()->setExpendable(true);
+			numOfWaveAsteroids++;
+		}
+		Telemetry::record(TELEMETRY_SPAWN, asteroids.back()->getPosition().x, asteroids.back()->getPosition().y, 0.f);
 		deadAsteroidIndex = -1;
 	}
+
+	std::sort(removedAsteroids.begin(), removedAsteroids.begin() + numOfRemoved, std::greater<int>()); // highest first, so the indices left stay valid
+	for (int i{ 0 }; i < numOfRemoved; i++)
+		removeAsteroid(removedAsteroids[i]);
 }
 
 void Game::isGameOver()
@@ -412,6 +1014,17 @@ void Game::isGameOver()
 	*/
 	if (player->getHealth() <= 0)
 	{
+		Telemetry::record(TELEMETRY_GAME_OVER, 0.f, 0.f, static_cast<float>(player->getScore()));
+
+		if (replaying)
+			finishReplay("Replay game over");
+		else if (replayRecorder.isOpen())
+		{
+			replayRecorder.close();
+			std::cout << "Replay of " << replayRecorder.getNumOfRecords() << " ticks saved to " << options.recordReplayFile << "\n";
+		}
+		if (leaderboard)
+			leaderboard->submit(options.playerName, player->getScore()); // only queued, the sender thread does the rest
 
 		if (scoreArray.empty()) // if user has not opened the score window yet
 			getScoreList();
@@ -441,7 +1054,180 @@ void Game::isGameOver()
 		// If Game Over Deallocate Memory and switch the game state
 		deallocateMemory();
 		currentAppState = STATE_MENU;
+
+		if (options.headless) // keep recording, start the next round right away
+		{
+			setupGame();
+			currentAppState = STATE_GAME;
+		}
+	}
+}
+
+// Snapshots
+
+void Game::saveSnapshot(std::vector<std::uint8_t>& state)
+{
+	/*
+	Function serializes the whole game state (player, bullets, asteroids) into state
+	*/
+	StateWriter writer(state);
+	writer.write(static_cast<std::uint16_t>(SNAPSHOT_VERSION));
+	writer.write(gameTick);
+	writer.write(gameSeed);
+	writer.write(numOfSpawns);
+	writer.write(wave);
+	writer.write(static_cast<std::uint8_t>(waveSpawned));
+	writer.write(waveStartTick);
+	writer.write(static_cast<std::uint32_t>(asteroids.size()));
+	player->saveState(writer);
+	for (auto* asteroid : asteroids)
+		asteroid->saveState(writer);
+	contacts.saveState(writer);
+}
+
+bool Game::loadSnapshot(const std::vector<std::uint8_t>& state)
+{
+	/*
+	Function restores a state written by saveSnapshot, taking asteroids from the pool or returning them as needed
+	*/
+	StateReader reader(state);
+	if (reader.read<std::uint16_t>() != SNAPSHOT_VERSION)
+		return false;
+	int tick = reader.read<int>();
+	std::uint32_t seed = reader.read<std::uint32_t>();
+	std::uint32_t spawns = reader.read<std::uint32_t>();
+	int savedWave = reader.read<int>();
+	bool savedWaveSpawned = reader.read<std::uint8_t>() != 0;
+	int savedWaveStartTick = reader.read<int>();
+	size_t numOfAsteroids = reader.read<std::uint32_t>();
+	if (!reader.good() || numOfAsteroids > static_cast<size_t>(asteroidPool->getSize()))
+		return false;
+
+	while (asteroids.size() > numOfAsteroids)
+	{
+		asteroidPool->release(asteroids.back());
+		asteroids.pop_back();
 	}
+	while (asteroids.size() < numOfAsteroids)
+		asteroids.push_back(asteroidPool->acquire(CounterRandom())); // its stream is loaded below
+
+	player->loadState(reader);
+	for (auto* asteroid : asteroids)
+		asteroid->loadState(reader);
+	contacts.loadState(reader);
+
+	gameTick = tick;
+	gameSeed = seed;
+	numOfSpawns = spawns;
+
+	// the level script cannot be saved, it starts again from its progress
+	wave = savedWave;
+	waveSpawned = savedWaveSpawned;
+	waveStartTick = savedWaveStartTick;
+	numOfWaveAsteroids = static_cast<int>(std::count_if(asteroids.begin(), asteroids.end(), [](const Asteroid* asteroid) { return asteroid->isExpendable(); }));
+	scripts.clear();
+	scripts.start(levelScript(true));
+	return reader.good();
+}
+
+bool Game::rewindTo(const int tick)
+{
+	/*
+	Function puts the game back to a tick still held in the snapshot buffer,
+	newer snapshots are dropped so the game resumes from there
+	*/
+	if (!snapshots.restore(tick, stateBuffer))
+		return false;
+	if (!loadSnapshot(stateBuffer))
+		return false;
+	snapshots.dropAfter(tick);
+	return true;
+}
+
+int Game::getGameTick()
+{
+	return gameTick;
+}
+
+// Metrics
+
+void Game::publishMetrics(const float frameTime, const std::uint64_t frameStart, const std::uint64_t inputDone, const std::uint64_t simulateDone)
+{
+	/*
+	Function stages the counters and gauges of the frame and publishes them to the shared memory segment,
+	the timestamps are InputQueue::now() microseconds at the start of the frame and after each phase
+	*/
+	const std::uint64_t renderDone = InputQueue::now();
+	long long liveBytes = 0;
+	for (int i{ 0 }; i < NUMBER_OF_MEMORY_TAGS; i++)
+		liveBytes += MemoryTracker::getStats(static_cast<memoryTag>(i)).liveBytes;
+
+	metrics.add(METRIC_FRAMES, 1);
+	metrics.set(METRIC_FPS, 1000.f / std::max(averageFrameTime, 0.001f));
+	metrics.set(METRIC_FRAME_MS, frameTime);
+	metrics.set(METRIC_INPUT_MS, (inputDone - frameStart) / 1000.0);
+	metrics.set(METRIC_SIMULATE_MS, (simulateDone - inputDone) / 1000.0);
+	metrics.set(METRIC_RENDER_MS, (renderDone - simulateDone) / 1000.0);
+	metrics.set(METRIC_ASTEROIDS, static_cast<double>(asteroids.size()));
+	metrics.set(METRIC_BULLETS, player ? player->movingBullets.size() : 0);
+	metrics.set(METRIC_SCORE, player ? player->getScore() : 0);
+	metrics.set(METRIC_HEAP_BYTES, static_cast<double>(liveBytes));
+	metrics.publish(renderDone);
+}
+
+// Quality Governor
+
+const QualityGovernor& Game::getQualityGovernor()
+{
+	return governor;
+}
+
+void Game::recordSnapshot()
+{
+	gameTick++;
+	saveSnapshot(stateBuffer);
+	snapshots.push(gameTick, stateBuffer);
+}
+
+void Game::finishReplay(const char* reason)
+{
+	/*
+	Function reports where the replay stopped, the score shows whether it went through the same game
+	*/
+	if (quitRequested)
+		return;
+	std::cout << reason << " at tick " << gameTick << ", score " << player->getScore() << ", health " << player->getHealth() << "\n";
+	quitRequested = true;
+}
+
+void Game::dumpSnapshot(const std::vector<std::uint8_t>& state, const int tick)
+{
+	/*
+	Function saves the exact game state of a slow frame, it can be replayed with --snapshot
+	*/
+	std::string fileName = "snapshot_tick" + std::to_string(tick) + ".bin";
+	std::ofstream fileOut{ fileName, std::ios::binary };
+	if (!fileOut)
+	{
+		std::cerr << "Error opening " << fileName << "\n";
+	}
+	else
+	{
+		fileOut.write(reinterpret_cast<const char*>(state.data()), state.size());
+		std::cerr << "Frame spike at tick " << tick << ", state saved to " << fileName << "\n";
+	}
+}
+
+bool Game::loadSnapshotFile(const std::string& fileName)
+{
+	std::ifstream fileIn{ fileName, std::ios::binary };
+	if (!fileIn)
+	{
+		std::cerr << "Error opening " << fileName << "\n";
+		return false;
+	}
+	stateBuffer.assign(std::istreambuf_iterator<char>(fileIn), std::istreambuf_iterator<char>());
+	return loadSnapshot(stateBuffer);
 }
 
 // File I/0
@@ -516,6 +1302,20 @@ void Game::loadAudio()
 	}
 	largeExplosion.setBuffer(buffer4);
 
+	for (const sf::SoundBuffer* buffer : { &buffer1, &buffer2, &buffer3, &buffer4 })
+		audioBytes += static_cast<std::size_t>(buffer->getSampleCount()) * sizeof(sf::Int16);
+	MemoryTracker::account(MEMORY_AUDIO, audioBytes);
+
+}
+
+void Game::playSound(sf::Sound& sound)
+{
+	/*
+	Function plays a sound effect, each has one voice, so one still playing is cut off and counted as dropped
+	*/
+	if (sound.getStatus() == sf::Sound::Playing)
+		metrics.add(METRIC_DROPPED_VOICES, 1);
+	sound.play();
 }
 
 void Game::loadTextures()
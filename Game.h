@@ -1,6 +1,27 @@
 #pragma once
 
 #include "Player.h"
+#include "GameOptions.h"
+#include "FrameCapture.h"
+#include "Snapshot.h"
+#include "TimerWheel.h"
+#include "QualityGovernor.h"
+#include "SfmlRenderBackend.h"
+#include "SoftwareRenderBackend.h"
+#include "Autopilot.h"
+#include "AsteroidPool.h"
+#include "FrameArena.h"
+#include "FramePacer.h"
+#include "InputQueue.h"
+#include "Replay.h"
+#include "ParticleSystem.h"
+#include "AsteroidSolver.h"
+#include "LeaderboardClient.h"
+#include "Soundtrack.h"
+#include "ContactManager.h"
+#include "Script.h"
+#include "LiveMetrics.h"
+#include "TextBatch.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <fstream>
@@ -13,20 +34,41 @@
 #define NUM_OF_SCORE_COMPONENTS 3
 #define NUM_OF_SCORE_WINDOW_COMPONENTS 5
 #define NUM_OF_GAME_WINDOW_COMPONENTS 2
-#define NUM_OF_ASTEROIDS 6
+#define FRAME_SPIKE_MS 50 // frames slower than this dump the game state
+#define MAX_FRAME_MS 250.f // longer frames (debugger, window drag) do not try to catch up
+#define FRAME_ARENA_BYTES (16 * 1024) // per frame scratch memory
+#define HUD_LINE_LENGTH 32
+#define OVERLAY_LINE_LENGTH 256
+#define TEXT_CHARACTER_SIZE 30 // menus, scores and HUD
+#define OVERLAY_CHARACTER_SIZE 14
+#define WAVE_DELAY_MS 3000.f // from the start or a cleared wave to the next wave
+#define WAVE_FIRST_SIZE 8 // asteroids of the first wave
+#define WAVE_GROWTH 4 // more asteroids in each following wave
+#define WAVE_SPEED 0.3f // px per ms of the first wave
+#define WAVE_SPEEDUP 0.03f // faster in each following wave
+#define WAVE_RING_MARGIN 60.f // px outside the screen the ring starts
+#define ALLOCATION_WARMUP_TICKS (2 * FPS) // ticks of a new game whose frames may still allocate (first sounds played)
 
 class Game
 {
 public:
-	Game(const int _width, const int _height);
+	Game(const int _width, const int _height, const GameOptions& _options = GameOptions());
 	~Game();
 private:
 	
 	// Components
 	int width; int height;
-	sf::RenderWindow* window = nullptr;
+	GameOptions options;
+	sf::RenderWindow* window = nullptr; // nullptr in headless runs
+	RenderBackend* renderer = nullptr;
+	FrameCapture* frameCapture = nullptr;
+	sf::RenderTexture headlessTarget;
+	sf::Texture windowTexture; // shows software rendered frames in the window
+	int frameNumber = 0;
+	FramePacer pacer{ 1000.f / FPS };
 	sf::Event event;
 	sf::Font font;
+	TextBatch textBatch; // every text of a frame, drawn at once
 
 	// Audio
 	sf::SoundBuffer buffer1;
@@ -37,6 +79,8 @@ private:
 	sf::Sound accelerationSound;
 	sf::SoundBuffer buffer4;
 	sf::Sound largeExplosion;
+	Soundtrack soundtrack; // streamed, not loaded like the effects
+	std::size_t audioBytes = 0; // samples of the buffers, charged to MEMORY_AUDIO
 
 	// Application State
 
@@ -56,25 +100,95 @@ private:
 
 	// Score
 	sf::Text scoreComponents[NUM_OF_SCORE_WINDOW_COMPONENTS];
-	std::vector<std::string> scoreArray;
+	TrackedVector<std::string, MEMORY_TEXT> scoreArray;
 
 	// Game
+	TimerWheel timerWheel;
 	bool gameStarted = false;
 	Player* player = nullptr;
-	std::vector<Asteroid*> asteroids;
+	AsteroidPool* asteroidPool = nullptr; // created once the textures are loaded
+	AsteroidSolver* asteroidSolver = nullptr;
+	ContactManager contacts; // probe 0 is the ship, 1 + Bullet::id the bullets, targets are asteroid indices
+	TrackedVector<sf::FloatRect, MEMORY_COLLISION> asteroidBounds; // GameRules hit boxes of this tick
+	std::uint32_t gameSeed = 0;		// every random number of a game comes from it
+	std::uint32_t numOfSpawns = 0;	// spawned asteroid n draws from stream n of gameSeed
+	TrackedVector<Asteroid*, MEMORY_ENTITIES> asteroids;
+
+	// Level, the game flow is a script (levelScript) driven by the simulation tick
+	ScriptSignal waveCleared;
+	ScriptScheduler scripts; // after the signals its scripts wait for, so it is destroyed first
+	int wave = 0;				// last wave spawned
+	bool waveSpawned = false;	// and not cleared yet
+	int waveStartTick = 0;		// ticks done when the wait for the next wave started
+	int numOfWaveAsteroids = 0;	// expendable asteroids left
 	sf::Text gameComponents[NUM_OF_GAME_WINDOW_COMPONENTS];
+	sf::String gameStrings[NUM_OF_GAME_WINDOW_COMPONENTS]; // keep their capacity, so HUD updates do not allocate
+	FrameArena frameArena{ FRAME_ARENA_BYTES, MEMORY_TEXT };
 	sf::Texture playerTexture;
 	sf::Texture bulletTexture;
 	sf::Texture asteroidTextureLevel0;
 	sf::Texture asteroidTextureLevel1;
+	ParticleSystem particles;
+
+	// Input, key transitions are timestamped by the input thread and cut into ticks
+	InputQueue inputQueue;
+	InputThread* inputThread = nullptr; // only when someone is at the keyboard
+	TickInput keyboardInput;
+	std::uint64_t tickStartTime = 0;
+	std::uint64_t tickEndTime = 0;
+
+	// Replays
+	ReplayRecorder replayRecorder;
+	ReplayPlayer replayPlayer;
+	bool replaying = false;
+	bool quitRequested = false;
+
+	// Leaderboard
+	LeaderboardClient* leaderboard = nullptr; // only with --leaderboard
+
+	// Monitoring
+	LiveMetrics metrics; // only published with --metrics
+
+	// Autopilot
+	Autopilot autopilot;
+	AsteroidIndex asteroidIndex;
+
+	// Quality Governor and Overlay
+	QualityGovernor governor;
+	sf::Clock frameWorkClock;
+	float averageFrameTime = FRAME_BUDGET_MS;
+	bool showOverlay = false;
+	sf::Text overlayText;
+	sf::String overlayString;
+
+	// Snapshots
+	int gameTick = 0;
+	bool rewinding = false;
+	SnapshotBuffer snapshots{ SNAPSHOT_SECONDS * FPS };
+	std::vector<std::uint8_t> stateBuffer;
 
 public:
 	void run();
+	void runRenderBenchmark();
 	void deallocateMemory();
+
+	// Snapshots
+	void saveSnapshot(std::vector<std::uint8_t>& state);
+	bool loadSnapshot(const std::vector<std::uint8_t>& state);
+	bool rewindTo(const int tick);
+	int getGameTick();
+
+	// Quality Governor
+	const QualityGovernor& getQualityGovernor();
 private:
 	// Render
-	void render(const float dt);
-	void handleUserInput(const float dt);
+	bool isRunning();
+	void simulate();
+	void render();
+	void present();
+	void handleUserInput();
+	void handleGameInput(const float dt);
+	PlayerInput getAutopilotInput();
 	void menuMoveUp();
 	void menuMoveDown();
 	void switchAppState();
@@ -82,18 +196,27 @@ private:
 private:
 	// Draw
 	void drawMenuWindow();
-	void drawGameWindow(const float dt);
+	void drawGameWindow();
 	void drawScoreWindow();
+	void drawOverlay();
 
 private:
 	// Setup
 	void setupGame();
+	Asteroid* spawnAsteroid(const int level);
+	Script levelScript(const bool resumed);
+	void spawnWave(const int number);
+	void removeAsteroid(const int index);
 	void setupMainWindow();
 	void setupScoreWindow();
+	void setupOverlay();
+	void setupText();
 
 private:
 	// Game Logic
+	void updateGame(const float dt);
 	void checkForCollision();
+	void resolveAsteroidCollisions();
 	void isGameOver();
 
 	// File I/O
@@ -101,5 +224,11 @@ private:
 	void loadTextures();
 	void saveScore();
 	void loadAudio();
+	void playSound(sf::Sound& sound);
+	void recordSnapshot();
+	void publishMetrics(const float frameTime, const std::uint64_t frameStart, const std::uint64_t inputDone, const std::uint64_t simulateDone);
+	void finishReplay(const char* reason);
+	void dumpSnapshot(const std::vector<std::uint8_t>& state, const int tick);
+	bool loadSnapshotFile(const std::string& fileName);
 };
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+
+#define NUM_OF_ASTEROIDS 6
+#define LEADERBOARD_DEFAULT_PORT 8080
+
+struct GameOptions
+{
+	// Headless runs have no window and simulate a fixed number of frames
+	bool headless = false;
+	int headlessFrames = 600;
+
+	// Gameplay Capture
+	bool capture = false;
+	bool captureRaw = false; // PNG sequence by default
+	std::string captureOutput = "capture";
+
+	// Rendering
+	bool softwareRenderer = false; // CPU rasterizer instead of SFML, no GPU needed
+	int renderBenchmarkFrames = 0; // > 0 only times drawing the game scene
+
+	// The ship plays itself
+	bool autopilot = false;
+
+	// Snapshots
+	std::string snapshotFile; // start the game from a dumped snapshot
+
+	// Replays
+	std::string recordReplayFile;	// record the input of the first game
+	std::string replayFile;			// play a recorded game instead of reading the keyboard
+
+	// Determinism
+	bool fixedPoint = false; // fixed-point movement and table trigonometry, bit-identical on every machine
+
+	// Quality Governor and Overlay
+	bool qualityGovernor = true;
+	bool preciseCollision = false; // circles after the bounding boxes, while quality is above coarse collision
+	bool overlay = false;
+
+	// Frame Pacing
+	bool vsync = false;			// the display paces frames, the pacer only starts them as late as possible
+	bool pacingReport = false;	// print pacing and input latency statistics when the game closes
+
+	// Asteroids
+	int numOfAsteroids = NUM_OF_ASTEROIDS;	// at the start of a game, thousands make the high density mode
+	int solverThreads = 1;	// asteroid collision solver, 0 uses every core
+
+	// Music
+	bool music = false; // stream the soundtrack, its files are not shipped with the game
+
+	// Memory
+	bool memoryReport = false; // print memory use per subsystem when the game closes
+
+	// Leaderboard
+	std::string leaderboardHost;			// results are submitted in the background when set
+	unsigned short leaderboardPort = LEADERBOARD_DEFAULT_PORT;
+	std::string playerName = "anonymous";
+
+	// Monitoring
+	std::string metricsName; // shared memory segment the live metrics are published to, none when empty
+
+	// Telemetry
+	bool telemetry = false;
+	std::string telemetryFile = "telemetry.bin";
+};
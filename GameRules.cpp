@@ -0,0 +1,187 @@
+#include "GameRules.h"
+#include "FixedMath.h"
+#include <cmath>
+
+ShipControls ShipControls::fromAction(const std::uint8_t action)
+{
+	ShipControls controls;
+	controls.rotateLeft = (action & ENV_ROTATE_LEFT) ? 1.f : 0.f;
+	controls.rotateRight = (action & ENV_ROTATE_RIGHT) ? 1.f : 0.f;
+	controls.thrust = (action & ENV_THRUST) ? 1.f : 0.f;
+	controls.fire = (action & ENV_FIRE) != 0;
+	return controls;
+}
+
+static sf::FloatRect spriteBounds(const sf::Vector2f position, const float rotation, const sf::Vector2f scale, const sf::Vector2f origin, const sf::Vector2f size)
+{
+	/*
+	Function returns what sf::Sprite::getGlobalBounds gives for a texture of size drawn with this transform
+	*/
+	sf::Transformable transformable;
+	transformable.setOrigin(origin);
+	transformable.setScale(scale);
+	transformable.setRotation(rotation);
+	transformable.setPosition(position);
+	return transformable.getTransform().transformRect(sf::FloatRect(0.f, 0.f, size.x, size.y));
+}
+
+// Ship
+
+float GameRules::rotateShip(const float rotation, const float dt, const int direction)
+{
+	float angle = std::fmod(rotation + direction * RULES_SHIP_ROTATION_SPEED * dt, 360.f);
+	return angle < 0 ? angle + 360.f : angle;
+}
+
+float GameRules::shipSpeed(const float dt, const float thrustMs, const bool firstThrust)
+{
+	/*
+	Function returns how far the ship moves in dt. The speed is a function of thrustMs, the time since
+	the thrust started: a boost that falls linearly from RULES_BOOST_MAX to RULES_BOOST_MIN over
+	RULES_BOOST_MS roughly models the thrust of a rocket taking off
+	*/
+	float speed = RULES_SHIP_SPEED * dt;
+	if (thrustMs < RULES_BOOST_MS || firstThrust)
+	{
+		if (thrustMs != 0)
+		{
+			const float slope = (RULES_BOOST_MAX - RULES_BOOST_MIN) / (0.0f - RULES_BOOST_MS);
+			speed += RULES_BOOST_MAX + slope * thrustMs;
+		}
+	}
+	return speed;
+}
+
+sf::Vector2f GameRules::moveShip(const sf::Vector2f position, const float rotation, const float distance, const bool fixedPoint)
+{
+	/*
+	Function moves the ship distance in the direction it points to and wraps it around the screen
+	*/
+	sf::Vector2f moved;
+	if (fixedPoint)
+		moved = FixedMath::movePolar(position, rotation, distance); // table trigonometry, integer steps
+	else
+		moved = position + sf::Vector2f(distance * sin(rotation * 3.14159265 / 180), -distance * cos(rotation * 3.14159265 / 180));
+
+	if (moved.x > RULES_SHIP_WRAP_MAX)			moved.x = 0;
+	else if (moved.x < RULES_SHIP_WRAP_MIN)		moved.x = RULES_SCREEN_SIZE;
+	else if (moved.y > RULES_SHIP_WRAP_MAX)		moved.y = 0;
+	else if (moved.y < RULES_SHIP_WRAP_MIN)		moved.y = RULES_SCREEN_SIZE;
+	return moved;
+}
+
+void GameRules::steerShip(sf::Vector2f& position, float& rotation, const ShipControls& controls, const float thrustMs, const float dt, const bool fixedPoint)
+{
+	/*
+	Function turns the ship for as long as each rotation was held, then moves it for as long as the
+	thrust was held. The caller keeps thrustMs: 0 on the tick the thrust starts
+	*/
+	if (controls.rotateLeft > 0.f)
+		rotation = rotateShip(rotation, dt * controls.rotateLeft, -1);
+	if (controls.rotateRight > 0.f)
+		rotation = rotateShip(rotation, dt * controls.rotateRight, +1);
+	if (controls.thrust > 0.f)
+		position = moveShip(position, rotation, shipSpeed(dt * controls.thrust, thrustMs), fixedPoint);
+}
+
+// Bullets
+
+sf::Vector2f GameRules::moveBullet(const sf::Vector2f position, const float angle, const float dt, const bool fixedPoint)
+{
+	const float distance = RULES_BULLET_SPEED * dt;
+	if (fixedPoint)
+		return FixedMath::movePolar(position, angle, distance);
+	return position + sf::Vector2f(distance * sin(angle * 3.14159265 / 180), -distance * cos(angle * 3.14159265 / 180));
+}
+
+bool GameRules::isOffScreen(const sf::Vector2f position)
+{
+	return position.x > RULES_SCREEN_SIZE || position.x < 0 || position.y > RULES_SCREEN_SIZE || position.y < 0;
+}
+
+// Asteroids
+
+void GameRules::rollAsteroid(const int level, CounterRandom& random, float& speed, sf::Vector2f& direction, sf::Vector2f& position)
+{
+	/*
+	Function picks the motion of an asteroid of level: both direction components in [0, 1], a faster
+	small one, a large one anywhere on the screen whose rare slow direction is made ten times faster
+	*/
+	direction.x = random.nextFloat();
+	direction.y = random.nextFloat();
+	if (level == 0)
+	{
+		speed = random.nextFloat(0.35f, 0.40f);
+		return;
+	}
+	speed = random.nextFloat(0.15f, 0.25f);
+	position.x = random.nextFloat(0.0f, RULES_SCREEN_SIZE);
+	position.y = random.nextFloat(0.0f, RULES_SCREEN_SIZE);
+	if (direction.x < 0.02f && direction.y < 0.1f)
+		speed = 10 * speed;
+}
+
+sf::Vector2f GameRules::moveAsteroid(const sf::Vector2f position, const float speed, const sf::Vector2f direction, const float dt, const bool fixedPoint)
+{
+	/*
+	Function moves the asteroid by speed * direction (px per ms) and wraps it around a field larger than the screen
+	*/
+	sf::Vector2f moved = fixedPoint ? FixedMath::moveBy(position, dt * speed * direction) : position + dt * speed * direction;
+
+	if (moved.x > RULES_ASTEROID_WRAP_MAX)			moved.x = 0;
+	else if (moved.x < RULES_ASTEROID_WRAP_MIN)		moved.x = RULES_SCREEN_SIZE;
+	else if (moved.y > RULES_ASTEROID_WRAP_MAX)		moved.y = 0;
+	else if (moved.y < RULES_ASTEROID_WRAP_MIN)		moved.y = RULES_SCREEN_SIZE;
+	return moved;
+}
+
+int GameRules::hitScore(const int level)
+{
+	if (level == 1)
+		return 2;
+	else if (level == 0)
+		return 1;
+	return 0;
+}
+
+float GameRules::asteroidMass(const int level)
+{
+	return level == 1 ? ASTEROID_MASS_LARGE : ASTEROID_MASS_SMALL;
+}
+
+// Hit Boxes
+
+sf::FloatRect GameRules::shipBounds(const sf::Vector2f position, const float rotation)
+{
+	return spriteBounds(position, rotation, sf::Vector2f(RULES_SHIP_SCALE_X, RULES_SHIP_SCALE_Y),
+		sf::Vector2f(RULES_SHIP_ORIGIN, RULES_SHIP_ORIGIN), sf::Vector2f(RULES_SHIP_TEXTURE_SIZE, RULES_SHIP_TEXTURE_SIZE));
+}
+
+sf::FloatRect GameRules::bulletBounds(const sf::Vector2f position, const float angle)
+{
+	return spriteBounds(position, angle, sf::Vector2f(RULES_BULLET_SCALE, RULES_BULLET_SCALE),
+		sf::Vector2f(0.f, 0.f), sf::Vector2f(RULES_BULLET_TEXTURE_WIDTH, RULES_BULLET_TEXTURE_HEIGHT));
+}
+
+sf::FloatRect GameRules::asteroidBounds(const sf::Vector2f position)
+{
+	return spriteBounds(position, 0.f, sf::Vector2f(RULES_ASTEROID_SCALE, RULES_ASTEROID_SCALE),
+		sf::Vector2f(0.f, 0.f), sf::Vector2f(RULES_ASTEROID_TEXTURE_WIDTH, RULES_ASTEROID_TEXTURE_HEIGHT));
+}
+
+bool GameRules::overlaps(const sf::FloatRect& bounds1, const sf::FloatRect& bounds2, const bool precise)
+{
+	/*
+	Function tests the bounding boxes, and when precise the circles averaged from them,
+	which are accurate for roughly circular sprites
+	*/
+	if (!bounds1.intersects(bounds2))
+		return false;
+	if (!precise)
+		return true;
+	float radius1 = (bounds1.width + bounds1.height) / 4;
+	float radius2 = (bounds2.width + bounds2.height) / 4;
+	float dx = (bounds1.left + bounds1.width / 2) - (bounds2.left + bounds2.width / 2);
+	float dy = (bounds1.top + bounds1.height / 2) - (bounds2.top + bounds2.height / 2);
+	return dx * dx + dy * dy < (radius1 + radius2) * (radius1 + radius2);
+}
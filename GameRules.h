@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "CounterRandom.h"
+#include <cstdint>
+
+// Field, px
+#define RULES_SCREEN_SIZE 800.f
+#define RULES_SHIP_WRAP_MIN -50.f			// a ship further out comes back at the opposite edge of the screen
+#define RULES_SHIP_WRAP_MAX 850.f
+#define RULES_ASTEROID_WRAP_MIN -200.f		// asteroids fly further out before they come back
+#define RULES_ASTEROID_WRAP_MAX 1000.f
+#define ASTEROID_POOL_SIZE 256				// most asteroids a game can have at once, the high density mode gets twice its start count
+
+// Ship
+#define INTIAL_PLAYER_HEALTH 3
+#define NUMBER_OF_BULLETS 5
+#define RULES_SHIP_ROTATION_SPEED 0.25f		// degrees per ms
+#define RULES_SHIP_SPEED 0.35				// px per ms
+#define RULES_BOOST_MS 800.f				// the take off boost fades out over the first 800 ms of thrust
+#define RULES_BOOST_MAX 6.f					// px per tick added when the thrust starts
+#define RULES_BOOST_MIN 1.f					// px per tick added at the end of the boost
+#define RULES_RELOAD_MS 150.f
+#define RULES_BULLET_SPEED 0.40f			// px per ms
+
+// Asteroids
+#define ASTEROID_MASS_LARGE 4.f				// twice the radius of a small one, so four times its mass
+#define ASTEROID_MASS_SMALL 1.f
+
+// Hit boxes are the bounding boxes of the sprites: the textures in assets at the scale they are drawn with
+#define RULES_SHIP_TEXTURE_SIZE 2236.f		// player.png, square
+#define RULES_SHIP_SCALE_X 0.015f
+#define RULES_SHIP_SCALE_Y 0.025f
+#define RULES_SHIP_ORIGIN (400.f + RULES_SHIP_TEXTURE_SIZE / 2) // the ship turns around a point 400 texels right of and below the centre
+#define RULES_ASTEROID_TEXTURE_WIDTH 1308.f	// asteroid_level1.png, a small asteroid keeps the texture rectangle of the large one
+#define RULES_ASTEROID_TEXTURE_HEIGHT 1191.f
+#define RULES_ASTEROID_SCALE 0.060f
+#define RULES_BULLET_TEXTURE_WIDTH 41.f		// bullet.png
+#define RULES_BULLET_TEXTURE_HEIGHT 39.f
+#define RULES_BULLET_SCALE 0.15f
+
+// Action bits, the same controls as PlayerInput
+enum envAction
+{
+	ENV_ROTATE_LEFT = 1,
+	ENV_ROTATE_RIGHT = 2,
+	ENV_THRUST = 4,
+	ENV_FIRE = 8
+};
+
+struct ShipControls
+{
+	float rotateLeft = 0.f;		// share of the tick the control was held
+	float rotateRight = 0.f;
+	float thrust = 0.f;
+	bool fire = false;			// pressed in the tick
+
+	static ShipControls fromAction(const std::uint8_t action); // envAction bits, held for the whole tick
+};
+
+namespace GameRules
+{
+	/*
+	The rules of the game on plain values: how ships, bullets and asteroids move and wrap, how an
+	asteroid is rolled, scored and weighed, and the hit boxes everything collides with. Player,
+	Asteroid and Game apply them to their sprites, BatchEnvironment, SimWorld, NetServer and NetClient
+	to their own arrays, so every simulation plays the same game. fixedPoint moves on the FixedMath grid
+	*/
+
+	// Ship
+	float rotateShip(const float rotation, const float dt, const int direction); // degrees in [0, 360), like sf::Transformable
+	float shipSpeed(const float dt, const float thrustMs, const bool firstThrust = false); // px this tick, thrustMs since the thrust started
+	sf::Vector2f moveShip(const sf::Vector2f position, const float rotation, const float distance, const bool fixedPoint);
+	// One tick of controls: rotation, then thrust. Firing and reloading are up to the caller
+	void steerShip(sf::Vector2f& position, float& rotation, const ShipControls& controls, const float thrustMs, const float dt, const bool fixedPoint);
+
+	// Bullets
+	sf::Vector2f moveBullet(const sf::Vector2f position, const float angle, const float dt, const bool fixedPoint);
+	bool isOffScreen(const sf::Vector2f position); // a bullet there is gone
+
+	// Asteroids
+	void rollAsteroid(const int level, CounterRandom& random, float& speed, sf::Vector2f& direction, sf::Vector2f& position); // a large one is also placed anew
+	sf::Vector2f moveAsteroid(const sf::Vector2f position, const float speed, const sf::Vector2f direction, const float dt, const bool fixedPoint);
+	int hitScore(const int level);
+	float asteroidMass(const int level);
+
+	// Hit boxes
+	sf::FloatRect shipBounds(const sf::Vector2f position, const float rotation);
+	sf::FloatRect bulletBounds(const sf::Vector2f position, const float angle);
+	sf::FloatRect asteroidBounds(const sf::Vector2f position);
+	bool overlaps(const sf::FloatRect& bounds1, const sf::FloatRect& bounds2, const bool precise); // boxes, then circles when precise
+}
@@ -0,0 +1,105 @@
+#include "InputQueue.h"
+#include <chrono>
+#include <algorithm>
+
+// Input Queue
+
+bool InputQueue::push(const InputEvent& event)
+{
+	std::uint32_t currentHead = head.load(std::memory_order_relaxed);
+	if (currentHead - tail.load(std::memory_order_acquire) == INPUT_QUEUE_SIZE)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	events[currentHead & (INPUT_QUEUE_SIZE - 1)] = event;
+	head.store(currentHead + 1, std::memory_order_release);
+	return true;
+}
+
+std::uint64_t InputQueue::collectTick(const std::uint64_t tickStart, const std::uint64_t tickEnd, TickInput& input)
+{
+	/*
+	Function works out for how much of [tickStart, tickEnd) every control was held,
+	transitions at or after tickEnd stay queued for the next tick
+	*/
+	std::uint64_t heldTime[NUMBER_OF_INPUT_CONTROLS]{};
+	for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
+		input.down[c] = held[c];
+
+	std::uint64_t cursor = tickStart;
+	std::uint64_t firstTransition = 0;
+	std::uint32_t currentTail = tail.load(std::memory_order_relaxed);
+	std::uint32_t currentHead = head.load(std::memory_order_acquire);
+	while (currentTail != currentHead)
+	{
+		const InputEvent& event = events[currentTail & (INPUT_QUEUE_SIZE - 1)];
+		if (event.timestamp >= tickEnd)
+			break;
+
+		std::uint64_t time = std::max(event.timestamp, cursor);
+		for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
+			if (held[c]) heldTime[c] += time - cursor;
+		cursor = time;
+
+		if (firstTransition == 0)
+			firstTransition = event.timestamp;
+		held[event.control] = event.pressed;
+		if (event.pressed)
+			input.down[event.control] = true;
+		currentTail++;
+	}
+	tail.store(currentTail, std::memory_order_release);
+
+	const std::uint64_t tickLength = tickEnd > tickStart ? tickEnd - tickStart : 1;
+	for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
+	{
+		if (held[c]) heldTime[c] += tickEnd - cursor;
+		input.held[c] = static_cast<float>(heldTime[c]) / tickLength; // exactly 1 when held the whole tick
+	}
+	return firstTransition;
+}
+
+int InputQueue::getDropped() const
+{
+	return dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t InputQueue::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Input Thread
+
+InputThread::InputThread(InputQueue& _queue)
+	:
+	queue{ _queue },
+	thread{ &InputThread::run, this }
+{
+}
+
+InputThread::~InputThread()
+{
+	running = false;
+	thread.join();
+}
+
+void InputThread::run()
+{
+	const sf::Keyboard::Key keys[NUMBER_OF_INPUT_CONTROLS] = { sf::Keyboard::Left, sf::Keyboard::Right, sf::Keyboard::Up, sf::Keyboard::Space };
+	bool pressed[NUMBER_OF_INPUT_CONTROLS]{};
+
+	while (running)
+	{
+		std::uint64_t timestamp = InputQueue::now();
+		for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
+		{
+			bool isPressed = sf::Keyboard::isKeyPressed(keys[c]);
+			// a transition that did not fit the full ring is seen again and retried on the next poll
+			if (isPressed != pressed[c] && queue.push({ timestamp, static_cast<std::uint8_t>(c), isPressed }))
+				pressed[c] = isPressed;
+		}
+		sf::sleep(sf::microseconds(INPUT_POLL_US));
+	}
+}
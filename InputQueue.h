@@ -0,0 +1,75 @@
+#pragma once
+
+#include <SFML/Window.hpp>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+#define INPUT_QUEUE_SIZE 256	// key transitions, power of two
+#define INPUT_POLL_US 500		// keyboard poll interval of the input thread
+
+// Input Control, the keys held during the game
+enum inputControl
+{
+	INPUT_ROTATE_LEFT,
+	INPUT_ROTATE_RIGHT,
+	INPUT_THRUST,
+	INPUT_FIRE,
+	NUMBER_OF_INPUT_CONTROLS
+};
+
+struct InputEvent
+{
+	std::uint64_t timestamp;	// microseconds, InputQueue::now()
+	std::uint8_t control;		// inputControl
+	bool pressed;
+};
+
+// What the controls did during one simulation tick
+struct TickInput
+{
+	float held[NUMBER_OF_INPUT_CONTROLS]{};	// fraction of the tick the control was held, 0 - 1
+	bool down[NUMBER_OF_INPUT_CONTROLS]{};	// held at any moment of the tick, so taps between frames count
+};
+
+class InputQueue
+{
+	/*
+	Single producer (the input thread), single consumer (the simulation) ring of timestamped key transitions.
+	The consumer side keeps which controls are held and cuts the transitions into ticks,
+	so a key press takes effect at the point of the tick where it happened
+	*/
+private:
+	InputEvent events[INPUT_QUEUE_SIZE];
+	alignas(64) std::atomic<std::uint32_t> head{ 0 }; // written by the producer
+	alignas(64) std::atomic<std::uint32_t> tail{ 0 }; // written by the consumer
+	std::atomic<int> dropped{ 0 };
+	bool held[NUMBER_OF_INPUT_CONTROLS]{};
+
+public:
+	bool push(const InputEvent& event);
+
+	// Consumes the transitions before tickEnd, earlier ones than tickStart count at its start.
+	// Returns the timestamp of the first transition consumed, 0 when there was none
+	std::uint64_t collectTick(const std::uint64_t tickStart, const std::uint64_t tickEnd, TickInput& input);
+
+	int getDropped() const;
+	static std::uint64_t now(); // microseconds on the steady clock
+};
+
+class InputThread
+{
+	/*
+	Polls the keyboard every INPUT_POLL_US and pushes every change of a game control into the queue,
+	so transitions are timestamped to well under a frame and taps shorter than a frame are not lost
+	*/
+public:
+	InputThread(InputQueue& _queue);
+	~InputThread();
+private:
+	InputQueue& queue;
+	std::atomic<bool> running{ true };
+	std::thread thread;
+
+	void run();
+};
@@ -0,0 +1,179 @@
+#include "LeaderboardClient.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+
+LeaderboardClient::LeaderboardClient(const std::string& _host, const unsigned short _port, const std::string& _outboxFile)
+	:
+	host{ _host },
+	port{ _port },
+	outboxFile{ _outboxFile },
+	random{ std::random_device{}() ^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) }
+{
+	loadOutbox();
+	numOfPending = static_cast<int>(outbox.size());
+	nextAttempt = std::chrono::steady_clock::now();
+	sender = std::thread(&LeaderboardClient::senderLoop, this);
+}
+
+LeaderboardClient::~LeaderboardClient()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	condition.notify_all();
+	sender.join();
+}
+
+void LeaderboardClient::submit(const std::string& player, const int score)
+{
+	/*
+	Function queues a result for the sender thread, it never touches the disk or the network
+	*/
+	LeaderboardEntry entry;
+	entry.score = score;
+	entry.time = static_cast<std::int64_t>(std::time(nullptr));
+	entry.player = player.empty() ? "anonymous" : player;
+	std::replace(entry.player.begin(), entry.player.end(), ' ', '_'); // one line per result, separated by spaces
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		char id[17];
+		std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(random()));
+		entry.id = id;
+		incoming.push_back(std::move(entry));
+		numOfPending++;
+	}
+	condition.notify_one();
+}
+
+void LeaderboardClient::senderLoop()
+{
+	/*
+	Function moves new results into the outbox (and its file), then posts the outbox a batch at a time
+	whenever the backoff allows it. New results wait LEADERBOARD_BATCH_DELAY_MS for company
+	*/
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (!incoming.empty())
+		{
+			outbox.insert(outbox.end(), incoming.begin(), incoming.end());
+			incoming.clear();
+			lock.unlock();
+			saveOutbox();
+			lock.lock();
+			nextAttempt = std::max(nextAttempt, now + std::chrono::milliseconds(LEADERBOARD_BATCH_DELAY_MS));
+			continue; // more may have arrived meanwhile
+		}
+		if (stop)
+			return;
+		if (outbox.empty())
+		{
+			condition.wait(lock, [this] { return stop || !incoming.empty(); });
+			continue;
+		}
+		if (now < nextAttempt)
+		{
+			condition.wait_until(lock, nextAttempt, [this] { return stop || !incoming.empty(); });
+			continue;
+		}
+
+		const size_t size = std::min<size_t>(outbox.size(), LEADERBOARD_BATCH_SIZE);
+		std::vector<LeaderboardEntry> batch(outbox.begin(), outbox.begin() + size);
+		lock.unlock();
+		const bool delivered = post(batch);
+		if (delivered)
+		{
+			outbox.erase(outbox.begin(), outbox.begin() + size);
+			saveOutbox();
+		}
+		lock.lock();
+
+		if (delivered)
+		{
+			numOfDelivered += size;
+			numOfPending -= static_cast<int>(size);
+			retryMs = LEADERBOARD_RETRY_MIN_MS;
+			nextAttempt = std::chrono::steady_clock::now(); // the rest of the outbox goes right away
+		}
+		else
+		{
+			numOfFailures++;
+			std::uniform_int_distribution<int> jitter(0, retryMs / 4); // clients that failed together do not retry together
+			nextAttempt = std::chrono::steady_clock::now() + std::chrono::milliseconds(retryMs + jitter(random));
+			retryMs = std::min(retryMs * 2, LEADERBOARD_RETRY_MAX_MS);
+		}
+	}
+}
+
+bool LeaderboardClient::post(const std::vector<LeaderboardEntry>& batch)
+{
+	/*
+	Function posts a batch, one result per line: id score time player.
+	Only a 200 answer confirms the batch, the service ignores ids it already has
+	*/
+	std::ostringstream body;
+	for (const LeaderboardEntry& entry : batch)
+		body << entry.id << " " << entry.score << " " << entry.time << " " << entry.player << "\n";
+
+	sf::Http http(host, port);
+	sf::Http::Request request("/scores", sf::Http::Request::Post, body.str());
+	request.setField("Content-Type", "text/plain");
+	sf::Http::Response response = http.sendRequest(request, sf::milliseconds(LEADERBOARD_TIMEOUT_MS));
+	return response.getStatus() == sf::Http::Response::Ok;
+}
+
+// Outbox
+
+void LeaderboardClient::loadOutbox()
+{
+	std::ifstream fileIn{ outboxFile };
+	LeaderboardEntry entry;
+	while (fileIn >> entry.id >> entry.score >> entry.time >> entry.player)
+		outbox.push_back(entry);
+}
+
+void LeaderboardClient::saveOutbox()
+{
+	/*
+	Function rewrites the outbox file through a temporary file, so a crash leaves the old or the new outbox
+	*/
+	const std::string temporaryFile = outboxFile + ".tmp";
+	{
+		std::ofstream fileOut{ temporaryFile, std::ios::trunc };
+		if (!fileOut)
+		{
+			std::cerr << "Error opening " << temporaryFile << "\n";
+			return;
+		}
+		for (const LeaderboardEntry& entry : outbox)
+			fileOut << entry.id << " " << entry.score << " " << entry.time << " " << entry.player << "\n";
+	}
+	std::remove(outboxFile.c_str()); // rename does not replace files on Windows
+	if (std::rename(temporaryFile.c_str(), outboxFile.c_str()) != 0)
+		std::cerr << "Error writing " << outboxFile << "\n";
+}
+
+// G&S
+int LeaderboardClient::getNumOfPending() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return numOfPending;
+}
+
+long long LeaderboardClient::getNumOfDelivered() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return numOfDelivered;
+}
+
+long long LeaderboardClient::getNumOfFailures() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return numOfFailures;
+}
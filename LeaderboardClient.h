@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <cstdint>
+
+#define LEADERBOARD_OUTBOX "assets\\leaderboard_outbox.txt"
+#define LEADERBOARD_BATCH_SIZE 32				// results per request
+#define LEADERBOARD_BATCH_DELAY_MS 500			// a new result waits this long for others to share its request
+#define LEADERBOARD_TIMEOUT_MS 2000
+#define LEADERBOARD_RETRY_MIN_MS 1000			// first retry, doubled after every failure
+#define LEADERBOARD_RETRY_MAX_MS (5 * 60 * 1000)
+
+// Result of one game as it is sent. The id is made once, when the game ends, so the service
+// can tell a retried result from a new one
+struct LeaderboardEntry
+{
+	std::string id;
+	int score = 0;
+	std::int64_t time = 0; // seconds since the epoch
+	std::string player;
+};
+
+class LeaderboardClient
+{
+	/*
+	Sends game results to the leaderboard service on a thread of its own. submit() only queues
+	the result; the thread writes it to the outbox file first, so results survive a crash or an
+	unreachable service, then posts them in batches. Failed requests are retried with exponential
+	backoff, and a result leaves the outbox only once the service has confirmed it
+	*/
+public:
+	LeaderboardClient(const std::string& _host, const unsigned short _port, const std::string& _outboxFile = LEADERBOARD_OUTBOX);
+	~LeaderboardClient(); // waits for a request in flight, what was not delivered stays in the outbox
+	LeaderboardClient(const LeaderboardClient&) = delete;
+	LeaderboardClient& operator=(const LeaderboardClient&) = delete;
+private:
+	std::string host;
+	unsigned short port;
+	std::string outboxFile;
+
+	// Shared with the game thread
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<LeaderboardEntry> incoming;
+	bool stop = false;
+	std::mt19937_64 random;
+	int numOfPending = 0;
+	long long numOfDelivered = 0;
+	long long numOfFailures = 0;
+
+	// Sender thread only
+	std::vector<LeaderboardEntry> outbox;
+	std::chrono::steady_clock::time_point nextAttempt;
+	int retryMs = LEADERBOARD_RETRY_MIN_MS;
+	std::thread sender;
+
+public:
+	void submit(const std::string& player, const int score); // returns right away
+
+	// G&S
+	int getNumOfPending() const;		// submitted or loaded from the outbox, not confirmed yet
+	long long getNumOfDelivered() const;
+	long long getNumOfFailures() const;	// failed requests
+
+private:
+	void senderLoop();
+	bool post(const std::vector<LeaderboardEntry>& batch);
+	void loadOutbox();
+	void saveOutbox();
+};
@@ -0,0 +1,294 @@
+#include "LeaderboardServer.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <charconv>
+
+LeaderboardServer::LeaderboardServer(const float _failureRate, const bool _verbose)
+	:
+	failureRate{ _failureRate },
+	verbose{ _verbose }
+{
+}
+
+LeaderboardServer::~LeaderboardServer()
+{
+	stop();
+}
+
+bool LeaderboardServer::start(const unsigned short port)
+{
+	if (listener.listen(port) != sf::Socket::Done)
+	{
+		std::cerr << "Error listening on TCP port " << port << "\n";
+		return false;
+	}
+	listener.setBlocking(false); // accept polls, so stop() is noticed
+	stopping = false;
+	server = std::thread(&LeaderboardServer::serveLoop, this);
+	return true;
+}
+
+void LeaderboardServer::stop()
+{
+	stopping = true;
+	if (server.joinable())
+		server.join();
+	listener.close();
+}
+
+void LeaderboardServer::serveLoop()
+{
+	while (!stopping)
+	{
+		sf::TcpSocket socket;
+		if (listener.accept(socket) != sf::Socket::Done)
+		{
+			sf::sleep(sf::milliseconds(5));
+			continue;
+		}
+		socket.setBlocking(true);
+		handleConnection(socket);
+		socket.disconnect();
+	}
+}
+
+void LeaderboardServer::handleConnection(sf::TcpSocket& socket)
+{
+	/*
+	Function reads one HTTP request (headers, then Content-Length bytes of body) and answers it,
+	a Content-Length that is not a number or does not fit LEADERBOARD_MAX_REQUEST_BYTES gets a 400
+	*/
+	std::string request;
+	size_t headerEnd = std::string::npos;
+	size_t contentLength = 0;
+	char buffer[4096];
+	std::size_t received;
+	while (request.size() < LEADERBOARD_MAX_REQUEST_BYTES)
+	{
+		if (headerEnd == std::string::npos && (headerEnd = request.find("\r\n\r\n")) != std::string::npos)
+		{
+			std::string headers = request.substr(0, headerEnd);
+			std::transform(headers.begin(), headers.end(), headers.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			size_t field = headers.find("content-length:");
+			if (field != std::string::npos)
+			{
+				const char* value = headers.c_str() + field + 15;
+				const char* lineEnd = headers.c_str() + std::min(headers.find("\r\n", field), headers.size());
+				while (value < lineEnd && (*value == ' ' || *value == '\t'))
+					value++;
+				const char* valueEnd = lineEnd;
+				while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+					valueEnd--;
+				std::from_chars_result parsed = std::from_chars(value, valueEnd, contentLength);
+				if (parsed.ec != std::errc() || parsed.ptr != valueEnd || value == valueEnd
+					|| contentLength > LEADERBOARD_MAX_REQUEST_BYTES || headerEnd + 4 + contentLength > LEADERBOARD_MAX_REQUEST_BYTES)
+					return respond(socket, 400, "");
+			}
+		}
+		if (headerEnd != std::string::npos && request.size() >= headerEnd + 4 + contentLength)
+			break;
+		if (socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Done)
+			return;
+		request.append(buffer, received);
+	}
+	if (headerEnd == std::string::npos || request.size() < headerEnd + 4 + contentLength)
+		return respond(socket, 400, "");
+
+	std::istringstream requestLine{ request.substr(0, request.find("\r\n")) };
+	std::string method, uri;
+	requestLine >> method >> uri;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		numOfRequests++;
+	}
+
+	if (method == "GET" && uri == "/scores")
+	{
+		std::ostringstream body;
+		for (const LeaderboardEntry& entry : getBest(10))
+			body << entry.score << " " << entry.player << "\n";
+		return respond(socket, 200, body.str());
+	}
+	if (method != "POST" || uri != "/scores")
+		return respond(socket, 404, "");
+
+	// failed on purpose: the service is down, or it stored the results and the answer got lost
+	std::uniform_real_distribution<float> chance(0.f, 1.f);
+	bool fail = chance(random) < failureRate;
+	bool storeFirst = chance(random) < 0.5f;
+	if (fail)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		numOfFailed++;
+	}
+	if (fail && !storeFirst)
+		return respond(socket, 503, "");
+	std::string answer = storeResults(request.substr(headerEnd + 4, contentLength));
+	respond(socket, fail ? 503 : 200, fail ? "" : answer);
+}
+
+void LeaderboardServer::respond(sf::TcpSocket& socket, const int status, const std::string& body)
+{
+	const char* reason = status == 200 ? "OK" : status == 404 ? "Not Found" : status == 503 ? "Service Unavailable" : "Bad Request";
+	std::ostringstream response;
+	response << "HTTP/1.0 " << status << " " << reason << "\r\nContent-Type: text/plain\r\nContent-Length: "
+		<< body.size() << "\r\n\r\n" << body;
+	const std::string text = response.str();
+	socket.send(text.data(), text.size());
+}
+
+std::string LeaderboardServer::storeResults(const std::string& body)
+{
+	/*
+	Function stores every result of a batch it does not have yet and answers how many were new
+	*/
+	std::istringstream lines{ body };
+	LeaderboardEntry entry;
+	int added = 0, duplicates = 0;
+	std::lock_guard<std::mutex> lock(mutex);
+	while (lines >> entry.id >> entry.score >> entry.time >> entry.player)
+	{
+		if (results.count(entry.id))
+		{
+			duplicates++;
+			continue;
+		}
+		results[entry.id] = entry;
+		added++;
+		if (verbose)
+			std::cout << entry.player << " scored " << entry.score << " (" << entry.id << ")\n";
+	}
+	numOfDuplicates += duplicates;
+	return std::to_string(added) + " added " + std::to_string(duplicates) + " known\n";
+}
+
+// G&S
+int LeaderboardServer::getNumOfResults() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return static_cast<int>(results.size());
+}
+
+long long LeaderboardServer::getNumOfRequests() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return numOfRequests;
+}
+
+long long LeaderboardServer::getNumOfDuplicates() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return numOfDuplicates;
+}
+
+long long LeaderboardServer::getNumOfFailed() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return numOfFailed;
+}
+
+std::vector<LeaderboardEntry> LeaderboardServer::getBest(const int count) const
+{
+	std::vector<LeaderboardEntry> best;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (const auto& result : results)
+			best.push_back(result.second);
+	}
+	std::sort(best.begin(), best.end(), [](const LeaderboardEntry& entry1, const LeaderboardEntry& entry2)
+	{
+		return entry1.score > entry2.score;
+	});
+	if (static_cast<int>(best.size()) > count)
+		best.resize(count);
+	return best;
+}
+
+int LeaderboardServer::run(int argc, char* argv[])
+{
+	int port = LEADERBOARD_DEFAULT_PORT;
+	float failures = 0.f;
+	try
+	{
+		if (argc > 0) port = std::stoi(argv[0]);
+		if (argc > 1) failures = std::stof(argv[1]) / 100.f;
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --leaderboard-server [port] [failure %]\n";
+		return 1;
+	}
+
+	LeaderboardServer server{ failures, true };
+	if (!server.start(static_cast<unsigned short>(port)))
+		return 1;
+	std::cout << "Leaderboard stand-in on http://localhost:" << port << "/scores\n";
+	while (true)
+		sf::sleep(sf::seconds(1.f));
+}
+
+int LeaderboardServer::runTest(int argc, char* argv[])
+{
+	int numOfResults = LEADERBOARD_TEST_RESULTS;
+	try
+	{
+		if (argc > 0) numOfResults = std::stoi(argv[0]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --leaderboard-test [results]\n";
+		return 1;
+	}
+	std::remove(LEADERBOARD_TEST_OUTBOX);
+	double slowestSubmit = 0;
+	auto submit = [&](LeaderboardClient& client, const int score)
+	{
+		auto start = std::chrono::steady_clock::now();
+		client.submit("test", score);
+		slowestSubmit = std::max(slowestSubmit, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+	};
+
+	// The service is down: results go to the outbox and stay there when the game closes
+	long long failuresWhileDown;
+	{
+		LeaderboardClient client{ "localhost", LEADERBOARD_TEST_PORT, LEADERBOARD_TEST_OUTBOX };
+		for (int i{ 0 }; i < numOfResults / 2; i++)
+			submit(client, i);
+		sf::sleep(sf::milliseconds(LEADERBOARD_BATCH_DELAY_MS + LEADERBOARD_RETRY_MIN_MS + 500));
+		failuresWhileDown = client.getNumOfFailures();
+	}
+	int inOutbox = 0;
+	{
+		std::ifstream outbox{ LEADERBOARD_TEST_OUTBOX };
+		std::string line;
+		while (std::getline(outbox, line))
+			inOutbox++;
+	}
+	std::cout << numOfResults / 2 << " results submitted while the service was down, " << failuresWhileDown
+		<< " failed requests, " << inOutbox << " results in the outbox after closing\n";
+
+	// The service is up but fails requests: the next game picks up the outbox and submits the rest
+	LeaderboardServer server{ LEADERBOARD_TEST_FAILURES };
+	if (!server.start(LEADERBOARD_TEST_PORT))
+		return 1;
+	LeaderboardClient client{ "localhost", LEADERBOARD_TEST_PORT, LEADERBOARD_TEST_OUTBOX };
+	for (int i{ numOfResults / 2 }; i < numOfResults; i++)
+		submit(client, i);
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(LEADERBOARD_TEST_SECONDS);
+	while (client.getNumOfPending() > 0 && std::chrono::steady_clock::now() < deadline)
+		sf::sleep(sf::milliseconds(50));
+
+	const bool passed = inOutbox == numOfResults / 2 && client.getNumOfPending() == 0 && server.getNumOfResults() == numOfResults;
+	std::cout << server.getNumOfRequests() << " requests, " << server.getNumOfFailed() << " failed on purpose, "
+		<< server.getNumOfDuplicates() << " results posted again\n";
+	std::cout << server.getNumOfResults() << " of " << numOfResults << " results stored once, slowest submit "
+		<< slowestSubmit << " us\n";
+	std::cout << (passed ? "passed\n" : "FAILED\n");
+	std::remove(LEADERBOARD_TEST_OUTBOX);
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "LeaderboardClient.h"
+#include "GameOptions.h"
+#include <SFML/Network.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+
+#define LEADERBOARD_MAX_REQUEST_BYTES (64 * 1024)
+#define LEADERBOARD_TEST_PORT 18080
+#define LEADERBOARD_TEST_RESULTS 100
+#define LEADERBOARD_TEST_OUTBOX "leaderboard_test_outbox.txt"
+#define LEADERBOARD_TEST_FAILURES 0.3f		// of the requests, half of them fail after the results were stored
+#define LEADERBOARD_TEST_SECONDS 60			// to deliver everything
+
+class LeaderboardServer
+{
+	/*
+	Local stand-in for the leaderboard service, for tests and offline play. Serves
+	POST /scores (the format of LeaderboardClient::post) and GET /scores (the best results)
+	on a thread of its own, one connection at a time. Results are kept by id, so a batch
+	that is posted again does not count twice. A share of the requests can be failed
+	on purpose, before or after the results are stored
+	*/
+public:
+	LeaderboardServer(const float _failureRate = 0.f, const bool _verbose = false);
+	~LeaderboardServer();
+	LeaderboardServer(const LeaderboardServer&) = delete;
+	LeaderboardServer& operator=(const LeaderboardServer&) = delete;
+private:
+	float failureRate;
+	bool verbose;
+	std::mt19937 random{ 7 };
+
+	sf::TcpListener listener;
+	std::thread server;
+	std::atomic<bool> stopping{ false };
+
+	mutable std::mutex mutex;
+	std::map<std::string, LeaderboardEntry> results; // by id
+	long long numOfRequests = 0;
+	long long numOfDuplicates = 0;
+	long long numOfFailed = 0;
+
+public:
+	bool start(const unsigned short port);
+	void stop();
+
+	// G&S
+	int getNumOfResults() const;
+	long long getNumOfRequests() const;
+	long long getNumOfDuplicates() const;	// results posted again, by retries
+	long long getNumOfFailed() const;		// requests failed on purpose
+	std::vector<LeaderboardEntry> getBest(const int count) const;
+
+	// Serves until the process is stopped.
+	// Arguments: [port] [failure %]
+	static int run(int argc, char* argv[]);
+
+	// Submits results while the service is down, restarts the client (outbox), then starts a failing
+	// stand-in and checks that every result arrives exactly once and submit() never waited.
+	// Arguments: [results]
+	static int runTest(int argc, char* argv[]);
+
+private:
+	void serveLoop();
+	void handleConnection(sf::TcpSocket& socket);
+	void respond(sf::TcpSocket& socket, const int status, const std::string& body);
+	std::string storeResults(const std::string& body);
+};
@@ -0,0 +1,367 @@
+#include "LiveMetrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<double>::is_always_lock_free,
+	"atomics in shared memory have to be lock free to work across processes");
+
+static std::uint64_t getProcessId()
+{
+#ifdef _WIN32
+	return GetCurrentProcessId();
+#else
+	return static_cast<std::uint64_t>(getpid());
+#endif
+}
+
+static std::uint64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LiveMetrics::~LiveMetrics()
+{
+	close();
+}
+
+bool LiveMetrics::create(const std::string& _name)
+{
+	/*
+	Function creates the segment (or takes over one a crashed game left) and writes its header,
+	magic is set last so a reader never sees a half written header
+	*/
+	close();
+	name = _name;
+#ifdef _WIN32
+	HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(MetricsSegment), ("Local\\" + name).c_str());
+	if (!handle)
+		return false;
+	void* view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(MetricsSegment));
+	if (!view)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	mapping = handle;
+#else
+	int file = shm_open(("/" + name).c_str(), O_CREAT | O_RDWR, 0644);
+	if (file < 0)
+		return false;
+	if (ftruncate(file, sizeof(MetricsSegment)) != 0)
+	{
+		::close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, sizeof(MetricsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	::close(file);
+	if (view == MAP_FAILED)
+		return false;
+#endif
+	segment = static_cast<MetricsSegment*>(view);
+	writer = true;
+
+	segment->magic.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	segment->version = METRICS_VERSION;
+	segment->size = sizeof(MetricsSegment);
+	segment->numOfMetrics = NUMBER_OF_METRICS;
+	segment->writerId = getProcessId();
+	for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+	{
+		std::strncpy(segment->names[i], getMetricName(static_cast<metricId>(i)), METRICS_NAME_LENGTH - 1);
+		segment->names[i][METRICS_NAME_LENGTH - 1] = '\0';
+		segment->values[i].store(0.0, std::memory_order_relaxed);
+		staged[i] = 0.0;
+	}
+	segment->sequence.store(0, std::memory_order_relaxed);
+	segment->publishTime.store(now(), std::memory_order_relaxed);
+	segment->magic.store(METRICS_MAGIC, std::memory_order_release);
+	return true;
+}
+
+bool LiveMetrics::attach(const std::string& _name)
+{
+	/*
+	Function maps a game's segment read only and checks it was written by a compatible build
+	*/
+	close();
+	name = _name;
+#ifdef _WIN32
+	HANDLE handle = OpenFileMappingA(FILE_MAP_READ, FALSE, ("Local\\" + name).c_str());
+	if (!handle)
+		return false;
+	void* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, sizeof(MetricsSegment));
+	if (!view)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	mapping = handle;
+#else
+	int file = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+	if (file < 0)
+		return false;
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(MetricsSegment)))
+	{
+		::close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, sizeof(MetricsSegment), PROT_READ, MAP_SHARED, file, 0);
+	::close(file);
+	if (view == MAP_FAILED)
+		return false;
+#endif
+	segment = static_cast<MetricsSegment*>(view);
+	writer = false;
+
+	if (segment->magic.load(std::memory_order_acquire) != METRICS_MAGIC || segment->version != METRICS_VERSION
+		|| segment->size != sizeof(MetricsSegment) || segment->numOfMetrics != NUMBER_OF_METRICS)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void LiveMetrics::close()
+{
+	if (!segment)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(segment);
+	CloseHandle(static_cast<HANDLE>(mapping));
+	mapping = nullptr;
+#else
+	munmap(segment, sizeof(MetricsSegment));
+	if (writer)
+		shm_unlink(("/" + name).c_str()); // readers keep their mapping until they close it
+#endif
+	segment = nullptr;
+	writer = false;
+}
+
+// Writer
+
+void LiveMetrics::publish(const std::uint64_t time)
+{
+	/*
+	Function copies the staged values into the segment between two increments of the sequence,
+	a reader that overlaps the copy sees an odd or a changed sequence and reads again
+	*/
+	if (!segment || !writer)
+		return;
+	const std::uint64_t sequence = segment->sequence.load(std::memory_order_relaxed);
+	segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+		segment->values[i].store(staged[i], std::memory_order_relaxed);
+	segment->publishTime.store(time, std::memory_order_relaxed);
+	segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Reader
+
+bool LiveMetrics::read(double values[NUMBER_OF_METRICS], std::uint64_t& sequence, std::uint64_t& publishTime) const
+{
+	if (!segment || segment->magic.load(std::memory_order_acquire) != METRICS_MAGIC)
+		return false;
+	for (int attempt{ 0 }; attempt < METRICS_READ_ATTEMPTS; attempt++)
+	{
+		const std::uint64_t before = segment->sequence.load(std::memory_order_acquire);
+		if (before & 1)
+			continue; // the game is writing
+		for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+			values[i] = segment->values[i].load(std::memory_order_relaxed);
+		publishTime = segment->publishTime.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (segment->sequence.load(std::memory_order_relaxed) == before)
+		{
+			sequence = before / 2; // publishes so far
+			return true;
+		}
+	}
+	return false;
+}
+
+// G&S
+bool LiveMetrics::isOpen() const
+{
+	return segment != nullptr;
+}
+
+const char* LiveMetrics::getMetricName(const metricId id)
+{
+	const char* names[NUMBER_OF_METRICS] = { "frames", "ticks", "dropped_voices", "fps", "frame_ms", "input_ms", "simulate_ms",
+		"render_ms", "asteroids", "bullets", "score", "heap_bytes" };
+	return names[id];
+}
+
+// Attach
+
+int LiveMetrics::runAttach(int argc, char* argv[])
+{
+	int interval = METRICS_ATTACH_INTERVAL_MS;
+	bool csv = false;
+	int count = 0;
+	std::string segmentName = METRICS_DEFAULT_NAME;
+	try
+	{
+		if (argc > 0) interval = std::max(1, std::stoi(argv[0]));
+		if (argc > 1) csv = std::string(argv[1]) == "csv";
+		if (argc > 2) count = std::stoi(argv[2]);
+		if (argc > 3) segmentName = argv[3];
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --metrics-attach [interval ms] [text|csv] [count] [name]\n";
+		return 1;
+	}
+
+	LiveMetrics metrics;
+	bool waiting = false;
+	bool header = false;
+	bool first = true;
+	std::uint64_t lastSequence = 0;
+	for (int printed{ 0 }; count == 0 || printed < count; )
+	{
+		if (!first)
+			std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		first = false;
+
+		if (!metrics.isOpen() && !metrics.attach(segmentName))
+		{
+			if (!waiting)
+				std::cerr << "Waiting for a game publishing " << segmentName << "\n";
+			waiting = true;
+			continue;
+		}
+		waiting = false;
+
+		double values[NUMBER_OF_METRICS];
+		std::uint64_t sequence, publishTime;
+		if (!metrics.read(values, sequence, publishTime))
+		{
+			metrics.close(); // taken over by a new game, or the game writes faster than we can read
+			continue;
+		}
+		if (sequence == lastSequence && now() - publishTime > METRICS_STALE_MS * 1000ull)
+		{
+			std::cerr << "Game stopped publishing\n";
+			metrics.close(); // a new game makes a new segment
+			continue;
+		}
+		lastSequence = sequence;
+
+		if (csv)
+		{
+			if (!header)
+			{
+				std::cout << "publish_us,sequence";
+				for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+					std::cout << "," << getMetricName(static_cast<metricId>(i));
+				std::cout << "\n";
+				header = true;
+			}
+			std::cout << publishTime << "," << sequence;
+			for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+				std::cout << "," << values[i];
+			std::cout << std::endl;
+		}
+		else
+		{
+			std::cout << "#" << sequence;
+			for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+				std::cout << "  " << getMetricName(static_cast<metricId>(i)) << " " << std::fixed << std::setprecision(i >= METRIC_FPS && i <= METRIC_RENDER_MS ? 2 : 0) << values[i];
+			std::cout << std::endl;
+		}
+		printed++;
+	}
+	return 0;
+}
+
+// Benchmark
+
+int LiveMetrics::runBenchmark(int argc, char* argv[])
+{
+	int updates = METRICS_BENCHMARK_UPDATES;
+	try
+	{
+		if (argc > 0) updates = std::stoi(argv[0]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-metrics [updates]\n";
+		return 1;
+	}
+
+	const std::string segmentName = std::string(METRICS_DEFAULT_NAME) + "Benchmark";
+	LiveMetrics writer;
+	if (!writer.create(segmentName))
+	{
+		std::cerr << "Shared memory is not available\n";
+		return 1;
+	}
+
+	// every value of a publish is the same number, a torn read mixes two
+	auto publishAll = [&writer](const int updates) -> double
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (int update{ 0 }; update < updates; update++)
+			{
+				for (int i{ 0 }; i < NUMBER_OF_METRICS; i++)
+					writer.set(static_cast<metricId>(i), update);
+				writer.publish(update);
+			}
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+	double aloneSeconds = publishAll(updates);
+
+	std::atomic<bool> done{ false };
+	long long reads = 0, failedReads = 0, tornReads = 0;
+	std::thread readerThread([&]()
+		{
+			LiveMetrics reader;
+			if (!reader.attach(segmentName))
+				return;
+			double values[NUMBER_OF_METRICS];
+			std::uint64_t sequence, publishTime;
+			while (!done.load(std::memory_order_relaxed))
+			{
+				if (!reader.read(values, sequence, publishTime))
+				{
+					failedReads++;
+					continue;
+				}
+				reads++;
+				if (std::any_of(values, values + NUMBER_OF_METRICS, [&](const double value) { return value != values[0]; }) || publishTime != values[0])
+					tornReads++;
+			}
+		});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50)); // let the reader attach
+	double readSeconds = publishAll(updates);
+	done = true;
+	readerThread.join();
+
+	std::cout << updates << " publishes of " << NUMBER_OF_METRICS << " metrics\n";
+	std::cout << "  alone " << 1e9 * aloneSeconds / updates << " ns, with a reader " << 1e9 * readSeconds / updates << " ns per publish\n";
+	std::cout << "  reader: " << reads << " reads, " << failedReads << " gave up, " << tornReads << " torn\n";
+	return tornReads == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define METRICS_DEFAULT_NAME "AsteroidsGameMetrics"	// shared memory segment, --metrics [name]
+#define METRICS_MAGIC 0x4d545341u					// "ASTM"
+#define METRICS_VERSION 1							// changes with the layout of MetricsSegment
+#define METRICS_NAME_LENGTH 24
+#define METRICS_READ_ATTEMPTS 64					// a reader gives up on a snapshot after this many torn reads
+#define METRICS_STALE_MS 2000						// a game that has not published for this long is reported stale
+#define METRICS_ATTACH_INTERVAL_MS 1000
+#define METRICS_BENCHMARK_UPDATES 10000000
+
+enum metricId
+{
+	METRIC_FRAMES,			// counters
+	METRIC_TICKS,
+	METRIC_DROPPED_VOICES,	// sounds cut off by playing them again
+	METRIC_FPS,				// gauges
+	METRIC_FRAME_MS,
+	METRIC_INPUT_MS,		// phases of the last frame
+	METRIC_SIMULATE_MS,
+	METRIC_RENDER_MS,
+	METRIC_ASTEROIDS,
+	METRIC_BULLETS,
+	METRIC_SCORE,
+	METRIC_HEAP_BYTES,		// every MemoryTracker tag
+	NUMBER_OF_METRICS
+};
+
+struct MetricsSegment
+{
+	/*
+	Layout of the shared memory, one writer (the game thread) and any number of readers.
+	The header is written before magic is set and never changes afterwards, the values are
+	protected by sequence: odd while the game writes, a read is consistent when the
+	sequence was even and the same before and after it
+	*/
+	std::atomic<std::uint32_t> magic;
+	std::uint32_t version;
+	std::uint32_t size;				// of the segment, readers of another build check it too
+	std::uint32_t numOfMetrics;
+	std::uint64_t writerId;			// process id of the game
+	char names[NUMBER_OF_METRICS][METRICS_NAME_LENGTH];
+	alignas(64) std::atomic<std::uint64_t> sequence;
+	std::atomic<std::uint64_t> publishTime; // microseconds, steady clock
+	std::atomic<double> values[NUMBER_OF_METRICS];
+};
+
+class LiveMetrics
+{
+	/*
+	Publishes the game's counters and gauges to a named shared memory segment for monitoring
+	processes (a seqlock, readers never block the game). set() and add() only touch a private
+	copy, publish() copies all of it into the segment once per frame
+	*/
+public:
+	LiveMetrics() = default;
+	~LiveMetrics();
+	LiveMetrics(const LiveMetrics&) = delete;
+	LiveMetrics& operator=(const LiveMetrics&) = delete;
+private:
+	MetricsSegment* segment = nullptr;
+	bool writer = false;
+	void* mapping = nullptr; // the mapping handle on Windows
+	std::string name;
+	double staged[NUMBER_OF_METRICS] = {};
+
+public:
+	bool create(const std::string& _name = METRICS_DEFAULT_NAME);	// the game's side, false when shared memory is not available
+	bool attach(const std::string& _name = METRICS_DEFAULT_NAME);	// a reader's side, read only
+	void close();
+
+	// Writer, inline so an update is a store
+	void set(const metricId id, const double value) { staged[id] = value; }
+	void add(const metricId id, const double value) { staged[id] += value; }
+	void publish(const std::uint64_t time); // microseconds, steady clock
+
+	// Reader, false when no consistent copy could be taken (the game keeps writing or went away)
+	bool read(double values[NUMBER_OF_METRICS], std::uint64_t& sequence, std::uint64_t& publishTime) const;
+
+	// G&S
+	bool isOpen() const;
+	static const char* getMetricName(const metricId id);
+
+	// Attaches to a running game and prints its metrics, or writes them as csv lines, every interval.
+	// Arguments: [interval ms] [text|csv] [count] [name]
+	static int runAttach(int argc, char* argv[]);
+	// Publishes with and without a reader spinning on another thread, checks that no read is torn.
+	// Arguments: [updates]
+	static int runBenchmark(int argc, char* argv[]);
+};
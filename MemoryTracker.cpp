@@ -0,0 +1,104 @@
+#include "MemoryTracker.h"
+#include <atomic>
+#include <new>
+#include <iomanip>
+
+namespace
+{
+	struct TagCounters
+	{
+		std::atomic<long long> liveBytes{ 0 };
+		std::atomic<long long> liveAllocations{ 0 };
+		std::atomic<long long> totalAllocations{ 0 };
+		std::atomic<long long> peakBytes{ 0 };
+	};
+
+	TagCounters counters[NUMBER_OF_MEMORY_TAGS];
+
+	void add(const memoryTag tag, const std::size_t size)
+	{
+		TagCounters& tagCounters = counters[tag];
+		long long live = tagCounters.liveBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed) + static_cast<long long>(size);
+		tagCounters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+		tagCounters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		long long peak = tagCounters.peakBytes.load(std::memory_order_relaxed);
+		while (live > peak && !tagCounters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+			;
+	}
+
+	void remove(const memoryTag tag, const std::size_t size)
+	{
+		counters[tag].liveBytes.fetch_sub(static_cast<long long>(size), std::memory_order_relaxed);
+		counters[tag].liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void* MemoryTracker::allocate(const std::size_t size, const memoryTag tag)
+{
+	void* pointer = ::operator new(size);
+	add(tag, size);
+	return pointer;
+}
+
+void MemoryTracker::deallocate(void* pointer, const std::size_t size, const memoryTag tag)
+{
+	if (!pointer)
+		return;
+	remove(tag, size);
+	::operator delete(pointer);
+}
+
+void MemoryTracker::account(const memoryTag tag, const std::size_t size)
+{
+	add(tag, size);
+}
+
+void MemoryTracker::release(const memoryTag tag, const std::size_t size)
+{
+	remove(tag, size);
+}
+
+MemoryStats MemoryTracker::getStats(const memoryTag tag)
+{
+	return { counters[tag].liveBytes.load(), counters[tag].liveAllocations.load(),
+		counters[tag].totalAllocations.load(), counters[tag].peakBytes.load() };
+}
+
+const char* MemoryTracker::getTagName(const memoryTag tag)
+{
+	const char* names[NUMBER_OF_MEMORY_TAGS] = { "entities", "audio", "text", "collision", "effects", "scripts" };
+	return names[tag];
+}
+
+void MemoryTracker::printReport(std::ostream& out)
+{
+	out << std::left << std::setw(12) << "memory" << std::right << std::setw(14) << "live bytes"
+		<< std::setw(12) << "live allocs" << std::setw(14) << "total allocs" << std::setw(14) << "peak bytes" << "\n";
+	for (int i{ 0 }; i < NUMBER_OF_MEMORY_TAGS; i++)
+	{
+		MemoryStats stats = getStats(static_cast<memoryTag>(i));
+		out << std::left << std::setw(12) << getTagName(static_cast<memoryTag>(i)) << std::right
+			<< std::setw(14) << stats.liveBytes << std::setw(12) << stats.liveAllocations
+			<< std::setw(14) << stats.totalAllocations << std::setw(14) << stats.peakBytes << "\n";
+	}
+}
+
+bool MemoryTracker::checkLeaks(std::ostream& out)
+{
+	/*
+	Function is called once everything should have been freed (after the Game is destroyed)
+	*/
+	bool clean = true;
+	for (int i{ 0 }; i < NUMBER_OF_MEMORY_TAGS; i++)
+	{
+		MemoryStats stats = getStats(static_cast<memoryTag>(i));
+		if (stats.liveAllocations != 0 || stats.liveBytes != 0)
+		{
+			out << "Leak: " << getTagName(static_cast<memoryTag>(i)) << " still holds " << stats.liveBytes
+				<< " bytes in " << stats.liveAllocations << " allocations\n";
+			clean = false;
+		}
+	}
+	return clean;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <ostream>
+
+// Memory Tag, the subsystem an allocation is charged to
+enum memoryTag
+{
+	MEMORY_ENTITIES,	// player, bullets, asteroids and their lists
+	MEMORY_AUDIO,		// sound buffer samples
+	MEMORY_TEXT,		// score list and text vertices
+	MEMORY_COLLISION,	// spatial indexes
+	MEMORY_EFFECTS,		// particles and their vertices
+	MEMORY_SCRIPTS,		// coroutine frames of scripts
+	NUMBER_OF_MEMORY_TAGS
+};
+
+struct MemoryStats
+{
+	long long liveBytes;
+	long long liveAllocations;
+	long long totalAllocations;
+	long long peakBytes;
+};
+
+namespace MemoryTracker
+{
+	void* allocate(const std::size_t size, const memoryTag tag);
+	void deallocate(void* pointer, const std::size_t size, const memoryTag tag);
+
+	// Memory a library allocates for us (SFML sound buffers), counted as one allocation
+	void account(const memoryTag tag, const std::size_t size);
+	void release(const memoryTag tag, const std::size_t size);
+
+	MemoryStats getStats(const memoryTag tag);
+	const char* getTagName(const memoryTag tag);
+	void printReport(std::ostream& out);
+	bool checkLeaks(std::ostream& out); // true when nothing is live any more, prints what is
+}
+
+template <memoryTag Tag>
+class Tracked
+{
+	/*
+	Base class that charges every new of the derived class to Tag
+	*/
+public:
+	static void* operator new(std::size_t size) { return MemoryTracker::allocate(size, Tag); }
+	static void operator delete(void* pointer, std::size_t size) { MemoryTracker::deallocate(pointer, size, Tag); }
+};
+
+template <class T, memoryTag Tag>
+class TaggedAllocator
+{
+	/*
+	Standard library allocator that charges container storage to Tag
+	*/
+public:
+	using value_type = T;
+	template <class U> struct rebind { using other = TaggedAllocator<U, Tag>; };
+
+	TaggedAllocator() = default;
+	template <class U> TaggedAllocator(const TaggedAllocator<U, Tag>&) {}
+
+	T* allocate(const std::size_t n) { return static_cast<T*>(MemoryTracker::allocate(n * sizeof(T), Tag)); }
+	void deallocate(T* pointer, const std::size_t n) { MemoryTracker::deallocate(pointer, n * sizeof(T), Tag); }
+
+	template <class U> bool operator==(const TaggedAllocator<U, Tag>&) const { return true; }
+	template <class U> bool operator!=(const TaggedAllocator<U, Tag>&) const { return false; }
+};
+
+template <class T, memoryTag Tag>
+using TrackedVector = std::vector<T, TaggedAllocator<T, Tag>>;
@@ -0,0 +1,349 @@
+#include "NetClient.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+NetClient::NetClient()
+{
+	packet.reserve(NET_MAX_PACKET);
+}
+
+NetClient::~NetClient()
+{
+	disconnect();
+}
+
+bool NetClient::connect(const sf::IpAddress& address, const unsigned short port)
+{
+	/*
+	Function binds a local port and asks the server for a ship, update() asks again until it is accepted
+	*/
+	if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done)
+	{
+		std::cerr << "Error binding a UDP port\n";
+		return false;
+	}
+	socket.setBlocking(false);
+	serverAddress = address;
+	serverPort = port;
+	shipId = -1;
+	return true;
+}
+
+void NetClient::disconnect()
+{
+	if (shipId == -1)
+		return;
+	StateWriter writer{ packet };
+	writer.write(static_cast<std::uint8_t>(NET_DISCONNECT));
+	socket.send(packet.data(), packet.size(), serverAddress, serverPort);
+	shipId = -1;
+}
+
+void NetClient::update(const std::uint8_t action)
+{
+	/*
+	Function reads what the server sent, then applies the input of this tick to the local ship and sends it
+	*/
+	receive();
+	ticksSinceSnapshot++;
+
+	if (shipId == -1)
+	{
+		StateWriter writer{ packet };
+		writer.write(static_cast<std::uint8_t>(NET_CONNECT));
+		writer.write(static_cast<std::uint16_t>(NET_PROTOCOL_VERSION));
+		socket.send(packet.data(), packet.size(), serverAddress, serverPort);
+		return;
+	}
+
+	inputSequence++;
+	inputs[inputSequence % NET_INPUT_BUFFER] = action;
+	predictedShip.step(action);
+	predictions[inputSequence % NET_INPUT_BUFFER] = predictedShip;
+	sendInput();
+}
+
+// Receiving
+
+void NetClient::receive()
+{
+	sf::IpAddress address;
+	unsigned short port;
+	std::size_t size;
+	while (true)
+	{
+		packet.resize(NET_MAX_PACKET);
+		if (socket.receive(packet.data(), packet.size(), size, address, port) != sf::Socket::Done)
+			break;
+		if (address != serverAddress || port != serverPort)
+			continue;
+		if (packetLoss > 0.f)
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			if ((random >> 8) * (1.f / 16777216.f) < packetLoss)
+				continue;
+		}
+		packet.resize(size);
+		bytesReceived += size;
+
+		StateReader reader{ packet };
+		const std::uint8_t type = reader.read<std::uint8_t>();
+		if (type == NET_ACCEPT && shipId == -1)
+		{
+			const int id = reader.read<std::uint8_t>();
+			const int numOfEntities = reader.read<std::uint16_t>();
+			if (!reader.good())
+				continue;
+			shipId = id;
+			baseline.assign(numOfEntities, NetEntity());
+			baselineTick = NET_NO_BASELINE;
+			view = baseline;
+		}
+		else if (type == NET_SNAPSHOT && shipId != -1)
+			handleSnapshot(reader);
+	}
+}
+
+void NetClient::handleSnapshot(StateReader& reader)
+{
+	/*
+	Function decodes a snapshot against the baseline the server chose. Old snapshots (reordered)
+	and snapshots whose baseline is no longer known are dropped
+	*/
+	const std::uint32_t tick = reader.read<std::uint32_t>();
+	const std::uint32_t snapshotBaseline = reader.read<std::uint32_t>();
+	const std::uint32_t lastInput = reader.read<std::uint32_t>();
+	if (latestTick != NET_NO_BASELINE && tick <= latestTick)
+		return;
+
+	ShipFrame& frame = shipFrames[tick % NET_SHIP_HISTORY];
+	frame.tick = tick;
+	std::fill(std::begin(frame.present), std::end(frame.present), false);
+	const int numOfShips = reader.read<std::uint8_t>();
+	for (int s{ 0 }; s < numOfShips; s++)
+	{
+		const int id = reader.read<std::uint8_t>();
+		NetShipState ship;
+		ship.read(reader);
+		if (id < NET_MAX_CLIENTS)
+		{
+			frame.present[id] = true;
+			frame.ships[id] = ship;
+		}
+	}
+
+	ReceivedSnapshot& snapshot = received[tick % NET_PENDING_SNAPSHOTS];
+	snapshot.tick = tick;
+	snapshot.baselineTick = snapshotBaseline;
+	snapshot.changes.clear();
+	const int count = reader.read<std::uint16_t>();
+	for (int c{ 0 }; c < count; c++)
+	{
+		Change change;
+		change.index = reader.read<std::uint16_t>();
+		change.entity.read(reader, tick);
+		if (change.index < baseline.size())
+			snapshot.changes.push_back(change);
+	}
+
+	if (!reader.good() || !moveBaseline(snapshotBaseline))
+	{
+		snapshot.tick = NET_NO_BASELINE;
+		snapshotsDropped++;
+		return;
+	}
+	view = baseline;
+	for (const Change& change : snapshot.changes)
+		view[change.index] = change.entity;
+	latestTick = tick;
+	ticksSinceSnapshot = 0;
+	snapshotsReceived++;
+
+	lastAppliedInput = std::max(lastAppliedInput, lastInput);
+	if (frame.present[shipId])
+		reconcile(frame.ships[shipId]);
+}
+
+bool NetClient::moveBaseline(const std::uint32_t tick)
+{
+	/*
+	Function brings the baseline to the given snapshot. The server only moves a baseline to a snapshot
+	made against it, so the snapshots from our baseline to the new one form a chain that is applied in order
+	*/
+	if (tick == baselineTick)
+		return true;
+
+	std::uint32_t chain[NET_PENDING_SNAPSHOTS];
+	int length = 0;
+	bool fromEmpty = false;
+	for (std::uint32_t t{ tick }; t != baselineTick; )
+	{
+		if (t == NET_NO_BASELINE) // the server started over from the empty world
+		{
+			fromEmpty = true;
+			break;
+		}
+		const ReceivedSnapshot& snapshot = received[t % NET_PENDING_SNAPSHOTS];
+		if (snapshot.tick != t || length == NET_PENDING_SNAPSHOTS)
+			return false;
+		chain[length++] = t;
+		t = snapshot.baselineTick;
+	}
+
+	if (fromEmpty)
+		std::fill(baseline.begin(), baseline.end(), NetEntity());
+	for (int k{ length - 1 }; k >= 0; k--)
+		for (const Change& change : received[chain[k] % NET_PENDING_SNAPSHOTS].changes)
+			baseline[change.index] = change.entity;
+	baselineTick = tick;
+	return true;
+}
+
+void NetClient::reconcile(const NetShipState& serverShip)
+{
+	/*
+	Function restarts the prediction from the server's ship and applies the inputs the server has not seen.
+	A prediction that differs from the server's ship at the same input counts as a misprediction,
+	a ship that started again (more health than predicted) does not
+	*/
+	const bool known = lastAppliedInput > 0 && inputSequence - lastAppliedInput < NET_INPUT_BUFFER;
+	if (known)
+	{
+		const NetShipState& predicted = predictions[lastAppliedInput % NET_INPUT_BUFFER];
+		if (serverShip.health <= predicted.health &&
+			(predicted.x != serverShip.x || predicted.y != serverShip.y || predicted.rotation != serverShip.rotation))
+			mispredictions++;
+	}
+
+	predictedShip = serverShip;
+	const std::uint32_t first = std::max(lastAppliedInput + 1, inputSequence > NET_INPUT_BUFFER ? inputSequence - NET_INPUT_BUFFER + 1 : 1u);
+	for (std::uint32_t sequence{ first }; sequence <= inputSequence; sequence++)
+	{
+		predictedShip.step(inputs[sequence % NET_INPUT_BUFFER]);
+		predictions[sequence % NET_INPUT_BUFFER] = predictedShip;
+	}
+}
+
+// Sending
+
+void NetClient::sendInput()
+{
+	/*
+	Function sends the newest inputs, oldest first, and acknowledges the newest snapshot
+	*/
+	const int count = static_cast<int>(std::min<std::uint32_t>(inputSequence - lastAppliedInput, NET_INPUT_REDUNDANCY));
+	StateWriter writer{ packet };
+	writer.write(static_cast<std::uint8_t>(NET_INPUT));
+	writer.write(latestTick);
+	writer.write(inputSequence);
+	writer.write(static_cast<std::uint8_t>(count));
+	for (int k{ count - 1 }; k >= 0; k--)
+		writer.write(inputs[(inputSequence - k) % NET_INPUT_BUFFER]);
+	socket.send(packet.data(), packet.size(), serverAddress, serverPort);
+}
+
+// Drawing
+
+float NetClient::getDrawTick() const
+{
+	return static_cast<float>(latestTick) - NET_INTERPOLATION_TICKS + std::min(ticksSinceSnapshot, NET_INTERPOLATION_TICKS);
+}
+
+bool NetClient::getInterpolatedShip(const int id, NetShipState& ship) const
+{
+	/*
+	Function interpolates another ship between the two snapshots around the drawing time,
+	a ship that jumped (wrapped around the screen, started again) is not interpolated
+	*/
+	if (latestTick == NET_NO_BASELINE || id < 0 || id >= NET_MAX_CLIENTS)
+		return false;
+	const float drawTick = getDrawTick();
+	const std::uint32_t before = static_cast<std::uint32_t>(drawTick);
+	const ShipFrame& first = shipFrames[before % NET_SHIP_HISTORY];
+	const ShipFrame& second = shipFrames[(before + 1) % NET_SHIP_HISTORY];
+	const bool hasFirst = first.tick == before && first.present[id];
+	const bool hasSecond = second.tick == before + 1 && second.present[id];
+	if (!hasFirst && !hasSecond)
+		return false;
+	if (!hasFirst || !hasSecond)
+	{
+		ship = hasFirst ? first.ships[id] : second.ships[id];
+		return true;
+	}
+
+	const NetShipState& a = first.ships[id];
+	const NetShipState& b = second.ships[id];
+	const float fraction = drawTick - before;
+	ship = fraction < 0.5f ? a : b;
+	if (std::abs(b.x - a.x) > 100.f || std::abs(b.y - a.y) > 100.f)
+		return true;
+	float turn = std::fmod(b.rotation - a.rotation + 540.f, 360.f) - 180.f; // shortest way round
+	ship.x = a.x + (b.x - a.x) * fraction;
+	ship.y = a.y + (b.y - a.y) * fraction;
+	ship.rotation = std::fmod(a.rotation + turn * fraction + 360.f, 360.f);
+	return true;
+}
+
+void NetClient::getEntityPosition(const int index, float& x, float& y) const
+{
+	view[index].extrapolate(getDrawTick(), x, y);
+}
+
+// G&S
+bool NetClient::isConnected() const
+{
+	return shipId != -1;
+}
+
+int NetClient::getShipId() const
+{
+	return shipId;
+}
+
+const NetShipState& NetClient::getPredictedShip() const
+{
+	return predictedShip;
+}
+
+int NetClient::getNumOfEntities() const
+{
+	return static_cast<int>(view.size());
+}
+
+const NetEntity& NetClient::getEntity(const int index) const
+{
+	return view[index];
+}
+
+std::uint32_t NetClient::getLatestTick() const
+{
+	return latestTick;
+}
+
+long long NetClient::getBytesReceived() const
+{
+	return bytesReceived;
+}
+
+long long NetClient::getSnapshotsReceived() const
+{
+	return snapshotsReceived;
+}
+
+long long NetClient::getSnapshotsDropped() const
+{
+	return snapshotsDropped;
+}
+
+long long NetClient::getMispredictions() const
+{
+	return mispredictions;
+}
+
+void NetClient::setPacketLoss(const float fraction)
+{
+	packetLoss = fraction;
+}
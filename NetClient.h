@@ -0,0 +1,103 @@
+#pragma once
+
+#include "NetProtocol.h"
+#include <SFML/Network.hpp>
+#include <vector>
+#include <cstdint>
+
+class NetClient
+{
+	/*
+	Client side of NetServer, one update() per tick.
+	The local ship is predicted: every input is applied right away and kept until the server has applied it,
+	a snapshot resets the ship to the server's state and the inputs still in flight are applied again.
+	Other ships are interpolated NET_INTERPOLATION_TICKS behind the newest snapshot.
+	Asteroids and bullets are dead reckoned from the last state the server sent for them
+	*/
+public:
+	NetClient();
+	~NetClient();
+	NetClient(const NetClient&) = delete;
+	NetClient& operator=(const NetClient&) = delete;
+private:
+
+	struct Change
+	{
+		std::uint16_t index;
+		NetEntity entity;
+	};
+
+	// Decoded snapshot, kept while the server may still use it as baseline
+	struct ReceivedSnapshot
+	{
+		std::uint32_t tick = NET_NO_BASELINE;
+		std::uint32_t baselineTick = NET_NO_BASELINE;
+		std::vector<Change> changes;
+	};
+
+	// Every ship of one snapshot
+	struct ShipFrame
+	{
+		std::uint32_t tick = NET_NO_BASELINE;
+		bool present[NET_MAX_CLIENTS] = {};
+		NetShipState ships[NET_MAX_CLIENTS];
+	};
+
+	sf::UdpSocket socket;
+	sf::IpAddress serverAddress;
+	unsigned short serverPort = 0;
+	int shipId = -1;
+	std::vector<std::uint8_t> packet;
+
+	// Prediction
+	NetShipState predictedShip;
+	std::uint8_t inputs[NET_INPUT_BUFFER] = {};
+	NetShipState predictions[NET_INPUT_BUFFER];	// ship after each input, to measure mispredictions
+	std::uint32_t inputSequence = 0;
+	std::uint32_t lastAppliedInput = 0;			// by the server
+
+	// Snapshots
+	std::vector<NetEntity> baseline;			// entities at baselineTick
+	std::uint32_t baselineTick = NET_NO_BASELINE;
+	ReceivedSnapshot received[NET_PENDING_SNAPSHOTS];
+	std::vector<NetEntity> view;				// entities of the newest snapshot
+	std::uint32_t latestTick = NET_NO_BASELINE;
+	int ticksSinceSnapshot = 0;
+	ShipFrame shipFrames[NET_SHIP_HISTORY];
+
+	// Statistics
+	long long bytesReceived = 0;
+	long long snapshotsReceived = 0;
+	long long snapshotsDropped = 0;		// their baseline was gone
+	long long mispredictions = 0;
+	float packetLoss = 0.f;				// simulated, of incoming packets
+	std::uint32_t random = 0x2545f491;
+
+public:
+	bool connect(const sf::IpAddress& address, const unsigned short port);
+	void disconnect();
+	void update(const std::uint8_t action); // envAction bits of this tick
+
+	// G&S
+	bool isConnected() const;
+	int getShipId() const;
+	const NetShipState& getPredictedShip() const;
+	bool getInterpolatedShip(const int id, NetShipState& ship) const;	// another client's ship
+	int getNumOfEntities() const;
+	const NetEntity& getEntity(const int index) const;				// as of the newest snapshot
+	void getEntityPosition(const int index, float& x, float& y) const;	// dead reckoned to the drawing time
+	std::uint32_t getLatestTick() const;
+	long long getBytesReceived() const;
+	long long getSnapshotsReceived() const;
+	long long getSnapshotsDropped() const;
+	long long getMispredictions() const;
+	void setPacketLoss(const float fraction); // for testing
+
+private:
+	void receive();
+	void handleSnapshot(StateReader& reader);
+	bool moveBaseline(const std::uint32_t tick);
+	void reconcile(const NetShipState& serverShip);
+	void sendInput();
+	float getDrawTick() const;
+};
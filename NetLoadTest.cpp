@@ -0,0 +1,126 @@
+#include "NetLoadTest.h"
+#include "NetServer.h"
+#include "NetClient.h"
+#include "BatchEnvironment.h"
+#include "TimerWheel.h"
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <string>
+
+int NetLoadTest::run(int argc, char* argv[])
+{
+	/*
+	Function steps the server and every client once per tick, as fast as it can. Clients keep a random
+	action for a while before picking the next one. After every tick the first client's entities
+	are compared with the server's, dead reckoned to the tick they are both at
+	*/
+	int numOfClients = NET_LOAD_TEST_CLIENTS;
+	int asteroids = NET_LOAD_TEST_ASTEROIDS;
+	int ticks = NET_LOAD_TEST_TICKS;
+	float packetLoss = 0.f;
+	try
+	{
+		if (argc > 0) numOfClients = std::min(std::stoi(argv[0]), NET_MAX_CLIENTS);
+		if (argc > 1) asteroids = std::stoi(argv[1]);
+		if (argc > 2) ticks = std::stoi(argv[2]);
+		if (argc > 3) packetLoss = std::stof(argv[3]) / 100.f;
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --net-load-test [clients] [asteroids] [ticks] [packet loss %]\n";
+		return 1;
+	}
+
+	NetServer server{ asteroids };
+	if (!server.bind(0))
+		return 1;
+	std::vector<std::unique_ptr<NetClient>> clients;
+	std::vector<std::uint8_t> actions(numOfClients, 0);
+	for (int c{ 0 }; c < numOfClients; c++)
+	{
+		clients.emplace_back(new NetClient());
+		if (!clients.back()->connect(sf::IpAddress::LocalHost, server.getPort()))
+			return 1;
+		clients.back()->setPacketLoss(packetLoss);
+	}
+
+	std::uint32_t random = 12345;
+	double serverSeconds = 0;
+	long long bytesAtWarmup = 0, snapshotsAtWarmup = 0;
+	long long comparedEntities = 0, wrongKinds = 0, offEntities = 0;
+	double errorSum = 0, maxError = 0;
+
+	for (int tick{ 0 }; tick < ticks; tick++)
+	{
+		for (int c{ 0 }; c < numOfClients; c++)
+		{
+			random = random * 1664525u + 1013904223u;
+			if ((random >> 24) < 16) // about every 16 ticks
+				actions[c] = static_cast<std::uint8_t>((random >> 8) & (ENV_ROTATE_LEFT | ENV_ROTATE_RIGHT | ENV_THRUST | ENV_FIRE));
+			clients[c]->update(actions[c]);
+		}
+
+		// the first client has just read the snapshot of the server's current tick (unless it was lost)
+		const NetClient& observer = *clients[0];
+		if (tick >= NET_LOAD_TEST_WARMUP_TICKS && observer.getLatestTick() == server.getTick())
+		{
+			for (int i{ 0 }; i < server.getNumOfEntities(); i++)
+			{
+				const NetEntity& truth = server.getEntity(i);
+				const NetEntity& known = observer.getEntity(i);
+				if (truth.kind == NET_ENTITY_EMPTY && known.kind == NET_ENTITY_EMPTY)
+					continue;
+				comparedEntities++;
+				if (truth.kind != known.kind)
+				{
+					wrongKinds++;
+					continue;
+				}
+				int x, y;
+				known.extrapolate(truth.tick, x, y);
+				double error = std::sqrt(static_cast<double>(x - truth.x) * (x - truth.x) + static_cast<double>(y - truth.y) * (y - truth.y)) / NET_POSITION_SCALE;
+				errorSum += error;
+				maxError = std::max(maxError, error);
+				offEntities += error > 1.5;
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		server.update();
+		serverSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (tick + 1 == NET_LOAD_TEST_WARMUP_TICKS)
+		{
+			bytesAtWarmup = server.getBytesSent();
+			snapshotsAtWarmup = server.getSnapshotsSent();
+		}
+	}
+
+	long long mispredictions = 0, dropped = 0, received = 0;
+	int connected = 0;
+	for (const auto& client : clients)
+	{
+		mispredictions += client->getMispredictions();
+		dropped += client->getSnapshotsDropped();
+		received += client->getSnapshotsReceived();
+		connected += client->isConnected();
+	}
+
+	const int measuredTicks = std::max(ticks - NET_LOAD_TEST_WARMUP_TICKS, 1);
+	const long long snapshots = std::max(server.getSnapshotsSent() - snapshotsAtWarmup, 1LL);
+	const double bytes = static_cast<double>(server.getBytesSent() - bytesAtWarmup);
+	std::cout << connected << " clients, " << server.getNumOfEntities() << " entity slots, " << ticks << " ticks, "
+		<< packetLoss * 100 << "% packet loss\n";
+	std::cout << "  " << bytes / snapshots << " bytes per snapshot (largest " << server.getLargestSnapshot() << "), "
+		<< bytes / numOfClients / measuredTicks * SIM_TICKS_PER_SECOND / 1024 << " KiB/s per client\n";
+	std::cout << "  " << received << " snapshots decoded, " << dropped << " without baseline, "
+		<< mispredictions << " mispredicted ships\n";
+	std::cout << "  first client vs server: " << comparedEntities << " entities, " << wrongKinds << " wrong kind, "
+		<< offEntities << " off by more than 1.5 px, mean error " << (comparedEntities ? errorSum / comparedEntities : 0)
+		<< " px, max " << maxError << " px\n";
+	std::cout << "  server " << 1000.0 * serverSeconds / ticks << " ms per tick\n";
+	return 0;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#define NET_LOAD_TEST_CLIENTS 32
+#define NET_LOAD_TEST_ASTEROIDS 2000
+#define NET_LOAD_TEST_TICKS 1800		// thirty seconds of game time
+#define NET_LOAD_TEST_WARMUP_TICKS 120	// the first full sync is left out of the bandwidth
+
+namespace NetLoadTest
+{
+	// Runs a NetServer and many NetClients in this process over localhost, the clients fly with random
+	// inputs, and prints the bandwidth per client, prediction and dead reckoning errors and the server time.
+	// Arguments: [clients] [asteroids] [ticks] [packet loss %]
+	int run(int argc, char* argv[]);
+}
@@ -0,0 +1,143 @@
+#include "NetProtocol.h"
+#include "SimWorld.h"
+#include "TimerWheel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static std::int16_t toInt16(const float value)
+{
+	return static_cast<std::int16_t>(std::max(-32768.f, std::min(32767.f, std::round(value))));
+}
+
+// Net Entity
+
+NetEntity NetEntity::quantize(const std::uint8_t kind, const float x, const float y, const float vx, const float vy, const std::uint32_t tick)
+{
+	/*
+	Function quantizes an entity, velocities are given in pixels per ms like everywhere else in the game
+	*/
+	NetEntity entity;
+	entity.kind = kind;
+	entity.tick = tick;
+	if (kind == NET_ENTITY_EMPTY)
+		return entity;
+	entity.x = toInt16(x * NET_POSITION_SCALE);
+	entity.y = toInt16(y * NET_POSITION_SCALE);
+	entity.vx = toInt16(vx * SIM_TICK_MS * NET_VELOCITY_SCALE);
+	entity.vy = toInt16(vy * SIM_TICK_MS * NET_VELOCITY_SCALE);
+	return entity;
+}
+
+void NetEntity::extrapolate(const std::uint32_t atTick, int& atX, int& atY) const
+{
+	/*
+	Function moves the entity on from the tick it was sent, in integers so the server and every client
+	get the same result. Asteroids wrap around the field (GameRules::moveAsteroid, without its
+	rounding to the edge, the tolerance covers that)
+	*/
+	const int ticks = static_cast<int>(atTick - tick);
+	const int scale = static_cast<int>(NET_VELOCITY_SCALE / NET_POSITION_SCALE);
+	atX = x + vx * ticks / scale;
+	atY = y + vy * ticks / scale;
+	if (kind != NET_ENTITY_SMALL_ASTEROID && kind != NET_ENTITY_LARGE_ASTEROID)
+		return;
+
+	const int fieldMin = static_cast<int>(SIM_FIELD_MIN * NET_POSITION_SCALE);
+	const int fieldMax = static_cast<int>(SIM_FIELD_MAX * NET_POSITION_SCALE);
+	const int period = fieldMax; // leaving at the max comes back at 0, leaving at the min comes back at the screen edge
+	while (atX > fieldMax) atX -= period;
+	while (atX < fieldMin) atX += period;
+	while (atY > fieldMax) atY -= period;
+	while (atY < fieldMin) atY += period;
+}
+
+void NetEntity::extrapolate(const float atTick, float& atX, float& atY) const
+{
+	const std::uint32_t wholeTick = static_cast<std::uint32_t>(atTick);
+	int quantizedX, quantizedY;
+	extrapolate(wholeTick, quantizedX, quantizedY);
+	const float fraction = atTick - wholeTick;
+	atX = (quantizedX + fraction * vx * NET_POSITION_SCALE / NET_VELOCITY_SCALE) / NET_POSITION_SCALE;
+	atY = (quantizedY + fraction * vy * NET_POSITION_SCALE / NET_VELOCITY_SCALE) / NET_POSITION_SCALE;
+}
+
+bool NetEntity::differs(const NetEntity& truth) const
+{
+	if (kind != truth.kind)
+		return true;
+	if (kind == NET_ENTITY_EMPTY)
+		return false;
+	if (vx != truth.vx || vy != truth.vy)
+		return true;
+	int atX, atY;
+	extrapolate(truth.tick, atX, atY);
+	return std::abs(atX - truth.x) > NET_POSITION_TOLERANCE || std::abs(atY - truth.y) > NET_POSITION_TOLERANCE;
+}
+
+void NetEntity::write(StateWriter& writer) const
+{
+	writer.write(kind);
+	writer.write(x);
+	writer.write(y);
+	writer.write(vx);
+	writer.write(vy);
+}
+
+void NetEntity::read(StateReader& reader, const std::uint32_t snapshotTick)
+{
+	kind = reader.read<std::uint8_t>();
+	x = reader.read<std::int16_t>();
+	y = reader.read<std::int16_t>();
+	vx = reader.read<std::int16_t>();
+	vy = reader.read<std::int16_t>();
+	tick = snapshotTick;
+}
+
+// Net Ship State
+
+void NetShipState::step(const std::uint8_t action)
+{
+	/*
+	Function moves the ship by one tick with GameRules::steerShip, the movement of Player, in floats
+	on every machine. The quantized result is what the server sends, so a prediction matches it
+	*/
+	const float dt = SIM_TICK_MS;
+	const ShipControls controls = ShipControls::fromAction(action);
+	sf::Vector2f position(x, y);
+	GameRules::steerShip(position, rotation, controls, thrustTicks * dt, dt, false);
+	x = position.x;
+	y = position.y;
+	if (controls.thrust == 0.f)
+		thrustTicks = 0;
+	else if (thrustTicks < 255) // far past the take off boost
+		thrustTicks++;
+	quantize();
+}
+
+void NetShipState::quantize()
+{
+	x = std::round(x * NET_POSITION_SCALE) / NET_POSITION_SCALE;
+	y = std::round(y * NET_POSITION_SCALE) / NET_POSITION_SCALE;
+	rotation = std::fmod(std::round(rotation * NET_ROTATION_STEPS / 360.f), NET_ROTATION_STEPS) * 360.f / NET_ROTATION_STEPS;
+}
+
+void NetShipState::write(StateWriter& writer) const
+{
+	writer.write(toInt16(x * NET_POSITION_SCALE));
+	writer.write(toInt16(y * NET_POSITION_SCALE));
+	writer.write(static_cast<std::uint16_t>(static_cast<int>(std::round(rotation * NET_ROTATION_STEPS / 360.f)) & 0xffff));
+	writer.write(thrustTicks);
+	writer.write(health);
+	writer.write(score);
+}
+
+void NetShipState::read(StateReader& reader)
+{
+	x = reader.read<std::int16_t>() / NET_POSITION_SCALE;
+	y = reader.read<std::int16_t>() / NET_POSITION_SCALE;
+	rotation = reader.read<std::uint16_t>() * 360.f / NET_ROTATION_STEPS;
+	thrustTicks = reader.read<std::uint8_t>();
+	health = reader.read<std::uint8_t>();
+	score = reader.read<std::uint16_t>();
+}
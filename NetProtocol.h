@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Snapshot.h"
+#include "GameRules.h"
+#include <cstdint>
+
+// Connection
+#define NET_DEFAULT_PORT 53000
+#define NET_PROTOCOL_VERSION 1			// packets are plain values in machine byte order, like snapshots
+#define NET_MAX_CLIENTS 64				// the ships of every client fit into one snapshot
+#define NET_MAX_PACKET 1200				// bytes, below the usual MTU so datagrams are never fragmented
+#define NET_TIMEOUT_TICKS (5 * 60)		// a client silent for this long is dropped
+#define NET_NO_BASELINE 0xffffffffu		// snapshot is a delta against the empty world
+
+// Quantization
+#define NET_POSITION_SCALE 16.f			// positions are sent in 1/16 pixel
+#define NET_VELOCITY_SCALE 256.f		// velocities in 1/256 pixel per tick
+#define NET_POSITION_TOLERANCE 16		// 1 pixel, a dead reckoned entity further off than this is sent again
+#define NET_ROTATION_STEPS 65536.f		// per 360 degrees
+
+// Input
+#define NET_INPUT_REDUNDANCY 8			// every input packet repeats the last inputs, so a lost packet costs nothing
+#define NET_INPUT_BUFFER 64				// inputs a client can be ahead of the server
+#define NET_MAX_INPUTS_PER_TICK 2		// a client that fell behind catches up twice as fast
+
+// Snapshots
+#define NET_PENDING_SNAPSHOTS 32		// unacknowledged snapshots kept, the baseline is dropped when they run out
+#define NET_INTERPOLATION_TICKS 2		// remote ships are drawn this far in the past
+#define NET_SHIP_HISTORY 8
+
+// Ships, the GameRules of Player
+#define NET_MAX_BULLETS NUMBER_OF_BULLETS	// per ship
+#define NET_START_HEALTH INTIAL_PLAYER_HEALTH
+#define NET_INVULNERABLE_MS 1000.f		// after losing a life, instead of a contact per asteroid
+
+enum netMessage
+{
+	NET_CONNECT,		// client: version
+	NET_ACCEPT,			// server: ship id, number of entities
+	NET_INPUT,			// client: acknowledged snapshot, newest input sequence, inputs oldest first
+	NET_SNAPSHOT,		// server: tick, baseline, last input applied, every ship, changed entities
+	NET_DISCONNECT,		// client
+	NUMBER_OF_NET_MESSAGES
+};
+
+enum netEntityKind
+{
+	NET_ENTITY_EMPTY,
+	NET_ENTITY_SMALL_ASTEROID,
+	NET_ENTITY_LARGE_ASTEROID,
+	NET_ENTITY_BULLET,
+	NUMBER_OF_NET_ENTITY_KINDS
+};
+
+struct NetEntity
+{
+	/*
+	Asteroid or bullet as the clients know it: quantized state at the tick it was sent.
+	Both sides dead reckon it from there, so an entity flying straight is sent once
+	*/
+	std::int16_t x = 0, y = 0;		// 1/16 pixel
+	std::int16_t vx = 0, vy = 0;	// 1/256 pixel per tick
+	std::uint8_t kind = NET_ENTITY_EMPTY;
+	std::uint32_t tick = 0;			// not sent, the tick of the snapshot that carried it
+
+	static NetEntity quantize(const std::uint8_t kind, const float x, const float y, const float vx, const float vy, const std::uint32_t tick);
+	void extrapolate(const std::uint32_t atTick, int& atX, int& atY) const;			// quantized units
+	void extrapolate(const float atTick, float& atX, float& atY) const;				// pixels, for drawing between ticks
+	bool differs(const NetEntity& truth) const; // the dead reckoned entity is off by more than NET_POSITION_TOLERANCE
+
+	// Packets, the index is written and read by the caller
+	void write(StateWriter& writer) const;
+	void read(StateReader& reader, const std::uint32_t snapshotTick);
+};
+
+#define NET_ENTITY_BYTES 11 // index, kind, x, y, vx, vy
+
+struct NetShipState
+{
+	/*
+	Everything the movement of a ship depends on. The server quantizes its ships after every
+	step, so a client that predicts from a snapshot with the same inputs gets the same state
+	*/
+	float x = RULES_SCREEN_SIZE / 2, y = RULES_SCREEN_SIZE / 2;
+	float rotation = 0.f;
+	std::uint8_t thrustTicks = 0;	// for the take off boost
+	std::uint8_t health = NET_START_HEALTH;
+	std::uint16_t score = 0;
+
+	void step(const std::uint8_t action); // envAction bits
+	void quantize();
+
+	// Packets, the id is written and read by the caller
+	void write(StateWriter& writer) const;
+	void read(StateReader& reader);
+};
+
+#define NET_SHIP_BYTES 11 // id, x, y, rotation, thrust ticks, health, score
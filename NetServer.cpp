@@ -0,0 +1,458 @@
+#include "NetServer.h"
+#include "SimulationPolicies.h"
+#include "TimerWheel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+NetServer::NetServer(const int _numOfAsteroids, const std::uint32_t seed)
+	:
+	world{ SimScene{ _numOfAsteroids, 0, seed } }
+{
+	numOfAsteroidSlots = world.maxAsteroids;
+	entities.resize(numOfAsteroidSlots + NET_MAX_CLIENTS * NET_MAX_BULLETS);
+	const size_t bulletSlots = NET_MAX_CLIENTS * NET_MAX_BULLETS;
+	bulletX.resize(bulletSlots); bulletY.resize(bulletSlots); bulletAngle.resize(bulletSlots);
+	bulletActive.resize(bulletSlots);
+	bulletHits.resize(bulletSlots);
+	brokenAsteroids.resize(numOfAsteroidSlots);
+	clients.resize(NET_MAX_CLIENTS);
+	packet.reserve(NET_MAX_PACKET);
+	quantizeEntities();
+}
+
+bool NetServer::bind(const unsigned short port)
+{
+	if (socket.bind(port) != sf::Socket::Done)
+	{
+		std::cerr << "Error binding UDP port " << port << "\n";
+		return false;
+	}
+	socket.setBlocking(false);
+	return true;
+}
+
+void NetServer::update()
+{
+	/*
+	Function plays one server tick: inputs that arrived are queued, the world is stepped
+	and every client gets its snapshot. Clients that went silent are dropped
+	*/
+	receive();
+	step();
+	quantizeEntities();
+	for (int id{ 0 }; id < NET_MAX_CLIENTS; id++)
+	{
+		if (!clients[id].active)
+			continue;
+		if (++clients[id].silentTicks > NET_TIMEOUT_TICKS)
+			clients[id].active = false;
+		else
+			sendSnapshot(id);
+	}
+}
+
+// Receiving
+
+void NetServer::receive()
+{
+	sf::IpAddress address;
+	unsigned short port;
+	std::size_t received;
+	while (true)
+	{
+		packet.resize(NET_MAX_PACKET);
+		if (socket.receive(packet.data(), packet.size(), received, address, port) != sf::Socket::Done)
+			break;
+		packet.resize(received);
+		handlePacket(address, port);
+	}
+}
+
+void NetServer::handlePacket(const sf::IpAddress& address, const unsigned short port)
+{
+	StateReader reader{ packet };
+	const std::uint8_t type = reader.read<std::uint8_t>();
+	int id = findClient(address, port);
+
+	if (type == NET_CONNECT)
+	{
+		if (reader.read<std::uint16_t>() != NET_PROTOCOL_VERSION || !reader.good())
+			return;
+		if (id == -1) // a new client gets the first free ship
+		{
+			for (int i{ 0 }; i < NET_MAX_CLIENTS && id == -1; i++)
+				if (!clients[i].active)
+					id = i;
+			if (id == -1)
+				return;
+			Client& client = clients[id];
+			client = Client();
+			client.active = true;
+			client.address = address;
+			client.port = port;
+			client.baseline.assign(entities.size(), NetEntity());
+			for (int b{ 0 }; b < NET_MAX_BULLETS; b++)
+				bulletActive[id * NET_MAX_BULLETS + b] = 0;
+		}
+		sendAccept(id); // again when the accept got lost
+	}
+	else if (type == NET_INPUT && id != -1)
+	{
+		Client& client = clients[id];
+		const std::uint32_t ackedTick = reader.read<std::uint32_t>();
+		const std::uint32_t newest = reader.read<std::uint32_t>();
+		const int count = reader.read<std::uint8_t>();
+		std::uint8_t actions[NET_INPUT_BUFFER];
+		if (count == 0 || count > NET_INPUT_BUFFER || newest + 1 < static_cast<std::uint32_t>(count))
+			return;
+		for (int k{ 0 }; k < count; k++)
+			actions[k] = reader.read<std::uint8_t>();
+		if (!reader.good()) // a short packet changes nothing
+			return;
+		for (int k{ 0 }; k < count; k++)
+		{
+			const std::uint32_t sequence = newest + 1 - count + k;
+			if (sequence > client.lastInput)
+				client.inputs[sequence % NET_INPUT_BUFFER] = actions[k];
+		}
+		client.newestInput = std::max(client.newestInput, newest);
+		if (client.newestInput - client.lastInput > NET_INPUT_BUFFER) // too far behind, the oldest inputs are gone
+			client.lastInput = client.newestInput - NET_INPUT_BUFFER;
+		client.silentTicks = 0;
+		acknowledge(client, ackedTick);
+	}
+	else if (type == NET_DISCONNECT && id != -1)
+		clients[id].active = false;
+}
+
+int NetServer::findClient(const sf::IpAddress& address, const unsigned short port) const
+{
+	for (int id{ 0 }; id < NET_MAX_CLIENTS; id++)
+		if (clients[id].active && clients[id].port == port && clients[id].address == address)
+			return id;
+	return -1;
+}
+
+void NetServer::acknowledge(Client& client, const std::uint32_t ackedTick)
+{
+	/*
+	Function moves the baseline of a client to the snapshot it acknowledged. Only a snapshot made against
+	the current baseline can become the next one, so baselines form one chain the client can follow
+	*/
+	if (ackedTick == NET_NO_BASELINE || ackedTick == client.baselineTick)
+		return;
+	PendingSnapshot& snapshot = client.pending[ackedTick % NET_PENDING_SNAPSHOTS];
+	if (snapshot.tick != ackedTick || snapshot.baselineTick != client.baselineTick)
+		return;
+
+	for (const Change& change : snapshot.changes)
+		client.baseline[change.index] = change.entity;
+	client.baselineTick = ackedTick;
+}
+
+// Simulation
+
+void NetServer::step()
+{
+	/*
+	Function steps the world by one tick. Every client's ship takes the inputs that arrived, at most
+	NET_MAX_INPUTS_PER_TICK, so each input moves the ship exactly once, as on the predicting client
+	*/
+	tick++;
+	const float dt = SIM_TICK_MS;
+
+	for (int id{ 0 }; id < NET_MAX_CLIENTS; id++)
+	{
+		Client& client = clients[id];
+		if (!client.active)
+			continue;
+		for (int k{ 0 }; k < NET_MAX_INPUTS_PER_TICK && client.lastInput < client.newestInput; k++)
+		{
+			client.lastInput++;
+			stepShip(id, client.inputs[client.lastInput % NET_INPUT_BUFFER]);
+		}
+		if (client.invulnerableTicks > 0)
+			client.invulnerableTicks--;
+	}
+
+	FloatIntegration::integrate(world, dt); // the asteroids, the bullets belong to the ships
+	world.updateBounds();
+
+	for (size_t b{ 0 }; b < bulletActive.size(); b++)
+	{
+		if (!bulletActive[b])
+			continue;
+		sf::Vector2f moved = GameRules::moveBullet(sf::Vector2f(bulletX[b], bulletY[b]), bulletAngle[b], dt, false);
+		bulletX[b] = moved.x;
+		bulletY[b] = moved.y;
+		if (GameRules::isOffScreen(moved))
+			bulletActive[b] = 0;
+	}
+
+	// Collision, the hit boxes of Game::checkForCollision. A ship loses a life and is invulnerable for a while,
+	// a bullet is spent on the first asteroid it touches and scores for its ship, an asteroid breaks once per tick
+	const int numOfAsteroids = world.getNumOfAsteroids();
+	for (int id{ 0 }; id < NET_MAX_CLIENTS; id++)
+	{
+		Client& client = clients[id];
+		if (!client.active || client.invulnerableTicks > 0)
+			continue;
+		const sf::FloatRect shipBounds = GameRules::shipBounds(sf::Vector2f(client.ship.x, client.ship.y), client.ship.rotation);
+		for (int i{ 0 }; i < numOfAsteroids; i++)
+		{
+			if (GameRules::overlaps(shipBounds, world.asteroidBounds[i], false))
+			{
+				client.invulnerableTicks = msToTicks(NET_INVULNERABLE_MS);
+				if (--client.ship.health == 0) // game over, the ship starts again
+					client.ship = NetShipState();
+				break;
+			}
+		}
+	}
+
+	// the asteroid each bullet hits is found before any asteroid breaks, like the contacts of the game
+	for (size_t b{ 0 }; b < bulletActive.size(); b++)
+	{
+		bulletHits[b] = -1;
+		if (!bulletActive[b])
+			continue;
+		const sf::FloatRect bounds = GameRules::bulletBounds(sf::Vector2f(bulletX[b], bulletY[b]), bulletAngle[b]);
+		for (int i{ 0 }; i < numOfAsteroids && bulletHits[b] == -1; i++)
+			if (GameRules::overlaps(bounds, world.asteroidBounds[i], false))
+				bulletHits[b] = i;
+	}
+
+	int deadAsteroid = -1;
+	std::fill(brokenAsteroids.begin(), brokenAsteroids.end(), 0);
+	for (size_t b{ 0 }; b < bulletActive.size(); b++)
+	{
+		const int i = bulletHits[b];
+		if (i == -1)
+			continue;
+		bulletActive[b] = 0;
+		if (brokenAsteroids[i])
+			continue; // the asteroid already broke, the bullet still hit it
+		clients[b / NET_MAX_BULLETS].ship.score += GameRules::hitScore(world.asteroidLevel[i]);
+		world.hitAsteroid(i);
+		brokenAsteroids[i] = 1;
+		deadAsteroid = i;
+	}
+	if (deadAsteroid != -1) // at most one new asteroid per tick, like Game::checkForCollision
+		world.spawnFragment(deadAsteroid);
+}
+
+void NetServer::stepShip(const int id, const std::uint8_t action)
+{
+	/*
+	Function applies one input of a client: the ship moves and, when loaded, fires
+	*/
+	Client& client = clients[id];
+	client.ship.step(action);
+
+	// the gun reloads for RULES_RELOAD_MS like the shot timer of Player
+	if (client.reloadTicks > 0)
+		client.reloadTicks--;
+	if ((action & ENV_FIRE) && client.reloadTicks == 0)
+	{
+		for (int b{ id * NET_MAX_BULLETS }; b < (id + 1) * NET_MAX_BULLETS; b++)
+		{
+			if (!bulletActive[b])
+			{
+				bulletActive[b] = 1;
+				bulletX[b] = client.ship.x;
+				bulletY[b] = client.ship.y;
+				bulletAngle[b] = client.ship.rotation;
+				client.reloadTicks = msToTicks(RULES_RELOAD_MS);
+				break;
+			}
+		}
+	}
+}
+
+void NetServer::quantizeEntities()
+{
+	for (int i{ 0 }; i < numOfAsteroidSlots; i++)
+	{
+		if (i < world.getNumOfAsteroids())
+			entities[i] = NetEntity::quantize(world.asteroidLevel[i] == 1 ? NET_ENTITY_LARGE_ASTEROID : NET_ENTITY_SMALL_ASTEROID,
+				world.asteroidX[i], world.asteroidY[i], world.asteroidSpeed[i] * world.asteroidDirectionX[i],
+				world.asteroidSpeed[i] * world.asteroidDirectionY[i], tick);
+		else
+			entities[i] = NetEntity::quantize(NET_ENTITY_EMPTY, 0, 0, 0, 0, tick);
+	}
+	const float toRadians = 3.14159265f / 180;
+	for (size_t b{ 0 }; b < bulletActive.size(); b++)
+		entities[numOfAsteroidSlots + b] = NetEntity::quantize(bulletActive[b] ? NET_ENTITY_BULLET : NET_ENTITY_EMPTY, bulletX[b], bulletY[b],
+			RULES_BULLET_SPEED * std::sin(bulletAngle[b] * toRadians), -RULES_BULLET_SPEED * std::cos(bulletAngle[b] * toRadians), tick);
+}
+
+// Sending
+
+void NetServer::sendAccept(const int id)
+{
+	StateWriter writer{ packet };
+	writer.write(static_cast<std::uint8_t>(NET_ACCEPT));
+	writer.write(static_cast<std::uint8_t>(id));
+	writer.write(static_cast<std::uint16_t>(entities.size()));
+	socket.send(packet.data(), packet.size(), clients[id].address, clients[id].port);
+	bytesSent += packet.size();
+}
+
+void NetServer::sendSnapshot(const int id)
+{
+	/*
+	Function sends a client every ship and the entities its baseline gets wrong, as many as fit.
+	A client whose baseline has not moved for NET_PENDING_SNAPSHOTS ticks starts over from the empty world
+	*/
+	Client& client = clients[id];
+	if (client.baselineTick != NET_NO_BASELINE && tick - client.baselineTick >= NET_PENDING_SNAPSHOTS)
+	{
+		std::fill(client.baseline.begin(), client.baseline.end(), NetEntity());
+		client.baselineTick = NET_NO_BASELINE;
+	}
+
+	PendingSnapshot& snapshot = client.pending[tick % NET_PENDING_SNAPSHOTS];
+	snapshot.tick = tick;
+	snapshot.baselineTick = client.baselineTick;
+	snapshot.changes.clear();
+
+	StateWriter writer{ packet };
+	writer.write(static_cast<std::uint8_t>(NET_SNAPSHOT));
+	writer.write(tick);
+	writer.write(client.baselineTick);
+	writer.write(client.lastInput);
+	std::uint8_t numOfShips = 0;
+	for (const Client& other : clients)
+		numOfShips += other.active;
+	writer.write(numOfShips);
+	for (int other{ 0 }; other < NET_MAX_CLIENTS; other++)
+	{
+		if (!clients[other].active)
+			continue;
+		writer.write(static_cast<std::uint8_t>(other));
+		clients[other].ship.write(writer);
+	}
+
+	const size_t countOffset = packet.size();
+	writer.write(static_cast<std::uint16_t>(0));
+	const int numOfEntities = static_cast<int>(entities.size());
+	std::uint16_t count = 0;
+	for (int k{ 0 }; k < numOfEntities; k++)
+	{
+		const int i = (client.scanStart + k) % numOfEntities;
+		if (!client.baseline[i].differs(entities[i]))
+			continue;
+		if (packet.size() + NET_ENTITY_BYTES > NET_MAX_PACKET)
+		{
+			client.scanStart = i; // the rest goes first next tick
+			break;
+		}
+		writer.write(static_cast<std::uint16_t>(i));
+		entities[i].write(writer);
+		snapshot.changes.push_back({ static_cast<std::uint16_t>(i), entities[i] });
+		count++;
+	}
+	std::memcpy(packet.data() + countOffset, &count, sizeof(count));
+
+	socket.send(packet.data(), packet.size(), client.address, client.port);
+	bytesSent += packet.size();
+	snapshotsSent++;
+	largestSnapshot = std::max(largestSnapshot, static_cast<int>(packet.size()));
+}
+
+// G&S
+unsigned short NetServer::getPort() const
+{
+	return socket.getLocalPort();
+}
+
+std::uint32_t NetServer::getTick() const
+{
+	return tick;
+}
+
+int NetServer::getNumOfClients() const
+{
+	int count = 0;
+	for (const Client& client : clients)
+		count += client.active;
+	return count;
+}
+
+int NetServer::getNumOfEntities() const
+{
+	return static_cast<int>(entities.size());
+}
+
+const NetEntity& NetServer::getEntity(const int index) const
+{
+	return entities[index];
+}
+
+bool NetServer::getShip(const int id, NetShipState& ship) const
+{
+	if (id < 0 || id >= NET_MAX_CLIENTS || !clients[id].active)
+		return false;
+	ship = clients[id].ship;
+	return true;
+}
+
+long long NetServer::getBytesSent() const
+{
+	return bytesSent;
+}
+
+long long NetServer::getSnapshotsSent() const
+{
+	return snapshotsSent;
+}
+
+int NetServer::getLargestSnapshot() const
+{
+	return largestSnapshot;
+}
+
+int NetServer::run(int argc, char* argv[])
+{
+	int port = NET_DEFAULT_PORT;
+	int asteroids = NET_SERVER_ASTEROIDS;
+	try
+	{
+		if (argc > 0) port = std::stoi(argv[0]);
+		if (argc > 1) asteroids = std::stoi(argv[1]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --server [port] [asteroids]\n";
+		return 1;
+	}
+
+	NetServer server{ asteroids };
+	if (!server.bind(static_cast<unsigned short>(port)))
+		return 1;
+	std::cout << "Serving " << asteroids << " asteroids on UDP port " << server.getPort() << "\n";
+
+	sf::Clock clock;
+	sf::Time nextTick = clock.getElapsedTime();
+	long long bytesReported = 0;
+	while (true)
+	{
+		server.update();
+		if (server.getTick() % (NET_SERVER_REPORT_SECONDS * SIM_TICKS_PER_SECOND) == 0)
+		{
+			std::cout << "tick " << server.getTick() << ", " << server.getNumOfClients() << " clients, "
+				<< (server.getBytesSent() - bytesReported) / 1024.0 / NET_SERVER_REPORT_SECONDS << " KiB/s sent\n";
+			bytesReported = server.getBytesSent();
+		}
+
+		nextTick += sf::microseconds(static_cast<sf::Int64>(SIM_TICK_MS * 1000));
+		sf::Time wait = nextTick - clock.getElapsedTime();
+		if (wait > sf::Time::Zero)
+			sf::sleep(wait);
+		else if (wait < sf::milliseconds(-NET_SERVER_MAX_LAG_MS))
+			nextTick = clock.getElapsedTime(); // far behind, do not try to catch up
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "NetProtocol.h"
+#include "SimWorld.h"
+#include <SFML/Network.hpp>
+#include <vector>
+#include <cstdint>
+
+#define NET_SERVER_ASTEROIDS 1000
+#define NET_SERVER_REPORT_SECONDS 5
+#define NET_SERVER_MAX_LAG_MS 250		// a server further behind (debugger, suspended) does not try to catch up
+
+class NetServer
+{
+	/*
+	Authoritative multiplayer simulation: one asteroid field (SimWorld) and a ship per client,
+	stepped a tick per update(). Clients send their inputs and get a snapshot every tick.
+	A snapshot holds every ship and the asteroids and bullets that a client dead reckoning its
+	acknowledged baseline would get wrong, up to NET_MAX_PACKET bytes. Entities that do not fit
+	stay wrong on the client for another tick and are sent with the next snapshot
+	*/
+public:
+	NetServer(const int _numOfAsteroids = NET_SERVER_ASTEROIDS, const std::uint32_t seed = 1);
+	NetServer(const NetServer&) = delete;
+	NetServer& operator=(const NetServer&) = delete;
+private:
+
+	struct Change
+	{
+		std::uint16_t index;
+		NetEntity entity;
+	};
+
+	// Snapshot sent to a client and not acknowledged yet
+	struct PendingSnapshot
+	{
+		std::uint32_t tick = NET_NO_BASELINE;
+		std::uint32_t baselineTick = NET_NO_BASELINE;
+		std::vector<Change> changes;
+	};
+
+	struct Client
+	{
+		bool active = false;
+		sf::IpAddress address;
+		unsigned short port = 0;
+		int silentTicks = 0;
+
+		// Ship
+		NetShipState ship;
+		int reloadTicks = 0;
+		int invulnerableTicks = 0;
+
+		// Inputs, by sequence number
+		std::uint8_t inputs[NET_INPUT_BUFFER] = {};
+		std::uint32_t newestInput = 0;		// received
+		std::uint32_t lastInput = 0;		// applied, 0 before the first
+
+		// Baseline, the entities as the client knows them after its newest acknowledged snapshot
+		std::vector<NetEntity> baseline;
+		std::uint32_t baselineTick = NET_NO_BASELINE;
+		PendingSnapshot pending[NET_PENDING_SNAPSHOTS];
+		int scanStart = 0; // entities that do not fit are taken first next time
+	};
+
+	SimWorld world;
+	std::uint32_t tick = 0;
+	std::vector<Client> clients;
+
+	// Entities: the asteroid slots of the world, then NET_MAX_BULLETS bullet slots per client
+	int numOfAsteroidSlots;
+	std::vector<NetEntity> entities; // quantized state of this tick
+	std::vector<float> bulletX, bulletY, bulletAngle;
+	std::vector<std::uint8_t> bulletActive;
+	std::vector<int> bulletHits;					// asteroid each bullet hits this tick, -1 for none
+	std::vector<std::uint8_t> brokenAsteroids;
+
+	sf::UdpSocket socket;
+	std::vector<std::uint8_t> packet;
+	long long bytesSent = 0;
+	long long snapshotsSent = 0;
+	int largestSnapshot = 0;
+
+public:
+	bool bind(const unsigned short port); // 0 picks a free port
+	void update(); // receive, step a tick, send the snapshots
+
+	// G&S
+	unsigned short getPort() const;
+	std::uint32_t getTick() const;
+	int getNumOfClients() const;
+	int getNumOfEntities() const;
+	const NetEntity& getEntity(const int index) const;	// this tick
+	bool getShip(const int id, NetShipState& ship) const;
+	long long getBytesSent() const;
+	long long getSnapshotsSent() const;
+	int getLargestSnapshot() const;
+
+	// Runs a server at the tick rate until the process is stopped.
+	// Arguments: [port] [asteroids]
+	static int run(int argc, char* argv[]);
+
+private:
+	void receive();
+	void handlePacket(const sf::IpAddress& address, const unsigned short port);
+	int findClient(const sf::IpAddress& address, const unsigned short port) const;
+	void acknowledge(Client& client, const std::uint32_t ackedTick);
+	void step();
+	void stepShip(const int id, const std::uint8_t action);
+	void quantizeEntities();
+	void sendAccept(const int id);
+	void sendSnapshot(const int id);
+};
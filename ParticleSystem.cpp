@@ -0,0 +1,214 @@
+#include "ParticleSystem.h"
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+static std::uint32_t packColor(const std::uint8_t r, const std::uint8_t g, const std::uint8_t b)
+{
+	return r | (g << 8) | (b << 16);
+}
+
+ParticleSystem::ParticleSystem(const int _budget)
+	:
+	budget{ _budget }
+{
+	for (auto* array : { &x, &y, &vx, &vy, &life, &maxLife, &size })
+		array->resize(budget);
+	color.resize(budget);
+	vertices.resize(static_cast<size_t>(budget) * 4);
+}
+
+void ParticleSystem::update(const float dt)
+{
+	/*
+	Function moves and ages every particle, then removes the dead ones.
+	The first loop has no branches and no dependencies between particles, so it is vectorized
+	*/
+	const float damping = std::pow(PARTICLE_DAMPING, dt);
+	float* px = x.data();
+	float* py = y.data();
+	float* pvx = vx.data();
+	float* pvy = vy.data();
+	float* plife = life.data();
+	const int n = count;
+	for (int i{ 0 }; i < n; i++)
+	{
+		px[i] += pvx[i] * dt;
+		py[i] += pvy[i] * dt;
+		pvx[i] *= damping;
+		pvy[i] *= damping;
+		plife[i] -= dt;
+	}
+
+	// backwards, so the particle moved into a hole has already been checked
+	for (int i{ n - 1 }; i >= 0; i--)
+	{
+		if (plife[i] > 0.f)
+			continue;
+		int last = --count;
+		x[i] = x[last];
+		y[i] = y[last];
+		vx[i] = vx[last];
+		vy[i] = vy[last];
+		life[i] = life[last];
+		maxLife[i] = maxLife[last];
+		size[i] = size[last];
+		color[i] = color[last];
+	}
+}
+
+void ParticleSystem::buildVertices()
+{
+	/*
+	Function writes one quad per live particle, its alpha fades out with the life left
+	*/
+	sf::Vertex* quad = vertices.data();
+	for (int i{ 0 }; i < count; i++, quad += 4)
+	{
+		float half = size[i] * 0.5f;
+		std::uint32_t c = color[i];
+		sf::Color vertexColor(c & 0xff, (c >> 8) & 0xff, (c >> 16) & 0xff, static_cast<sf::Uint8>(255.f * life[i] / maxLife[i]));
+
+		quad[0].position = sf::Vector2f(x[i] - half, y[i] - half);
+		quad[1].position = sf::Vector2f(x[i] + half, y[i] - half);
+		quad[2].position = sf::Vector2f(x[i] + half, y[i] + half);
+		quad[3].position = sf::Vector2f(x[i] - half, y[i] + half);
+		quad[0].color = quad[1].color = quad[2].color = quad[3].color = vertexColor;
+	}
+	numOfVertices = count * 4;
+}
+
+void ParticleSystem::clear()
+{
+	count = 0;
+	numOfVertices = 0;
+}
+
+// Emitters
+
+void ParticleSystem::emitExplosion(const float _x, const float _y, const int level, const float scale)
+{
+	/*
+	Function throws debris in every direction, large asteroids throw more and bigger pieces
+	*/
+	int numOfParticles = static_cast<int>((level == 1 ? PARTICLE_EXPLOSION_LARGE : PARTICLE_EXPLOSION_LARGE / 2) * scale + 0.5f);
+	for (int i{ 0 }; i < numOfParticles; i++)
+	{
+		float angle = 6.2831853f * randomFloat();
+		float speed = PARTICLE_EXPLOSION_SPEED * (0.2f + 0.8f * randomFloat());
+		float particleLife = PARTICLE_EXPLOSION_LIFE * (0.4f + 0.6f * randomFloat());
+		std::uint8_t heat = static_cast<std::uint8_t>(120 + 135 * randomFloat()); // orange to yellow
+		emit(_x, _y, speed * std::cos(angle), speed * std::sin(angle), particleLife, level == 1 ? 3.f : 2.f, packColor(255, heat, 40));
+	}
+}
+
+void ParticleSystem::emitThrust(const float _x, const float _y, const float rotation, const bool burst, const float scale)
+{
+	/*
+	Function blows exhaust out of the back of the ship, rotation is the ship's in degrees (0 points up)
+	*/
+	int numOfParticles = static_cast<int>((burst ? PARTICLE_THRUST_BURST : PARTICLE_THRUST_TRAIL) * scale + 0.5f);
+	float backward = (rotation + 90.f) * 3.14159265f / 180.f;
+	for (int i{ 0 }; i < numOfParticles; i++)
+	{
+		float angle = backward + 0.5f * (randomFloat() - 0.5f);
+		float speed = PARTICLE_THRUST_SPEED * (0.5f + 0.5f * randomFloat());
+		float particleLife = PARTICLE_THRUST_LIFE * (0.5f + 0.5f * randomFloat());
+		std::uint8_t blue = static_cast<std::uint8_t>(150 + 105 * randomFloat());
+		emit(_x, _y, speed * std::cos(angle), speed * std::sin(angle), particleLife, 2.f, packColor(120, 180, blue));
+	}
+}
+
+void ParticleSystem::emit(const float _x, const float _y, const float _vx, const float _vy, const float _life, const float _size, const std::uint32_t _color)
+{
+	if (count == budget)
+	{
+		dropped++;
+		return;
+	}
+	x[count] = _x;
+	y[count] = _y;
+	vx[count] = _vx;
+	vy[count] = _vy;
+	life[count] = _life;
+	maxLife[count] = _life;
+	size[count] = _size;
+	color[count] = _color;
+	count++;
+}
+
+float ParticleSystem::randomFloat()
+{
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	return (random >> 8) * (1.f / 16777216.f);
+}
+
+// G&S
+int ParticleSystem::getCount() const
+{
+	return count;
+}
+
+int ParticleSystem::getDropped() const
+{
+	return dropped;
+}
+
+const sf::Vertex* ParticleSystem::getVertices() const
+{
+	return vertices.data();
+}
+
+int ParticleSystem::getNumOfVertices() const
+{
+	return numOfVertices;
+}
+
+int ParticleSystem::runBenchmark(int argc, char* argv[])
+{
+	int particles = PARTICLE_BENCHMARK_PARTICLES;
+	int frames = PARTICLE_BENCHMARK_FRAMES;
+	try
+	{
+		if (argc > 0) particles = std::stoi(argv[0]);
+		if (argc > 1) frames = std::stoi(argv[1]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-particles [particles] [frames]\n";
+		return 1;
+	}
+
+	ParticleSystem system{ std::max(particles * 2, PARTICLE_BUDGET) };
+	const float dt = 1000.f / 60;
+	double updateSeconds = 0, buildSeconds = 0;
+	long long liveSum = 0;
+	std::uint32_t state = 12345;
+
+	for (int frame{ 0 }; frame < frames; frame++)
+	{
+		while (system.getCount() < particles) // keep explosions going all over the screen
+		{
+			state = state * 1664525u + 1013904223u;
+			system.emitExplosion(static_cast<float>(state >> 22), static_cast<float>((state >> 12) & 1023), 1, 1.f);
+		}
+		liveSum += system.getCount();
+
+		auto start = std::chrono::steady_clock::now();
+		system.update(dt);
+		auto updated = std::chrono::steady_clock::now();
+		system.buildVertices();
+		auto built = std::chrono::steady_clock::now();
+		updateSeconds += std::chrono::duration<double>(updated - start).count();
+		buildSeconds += std::chrono::duration<double>(built - updated).count();
+	}
+
+	std::cout << frames << " frames, " << liveSum / std::max(frames, 1) << " live particles on average\n";
+	std::cout << "  update " << 1000.0 * updateSeconds / frames << " ms, vertices " << 1000.0 * buildSeconds / frames
+		<< " ms per frame\n";
+	return 0;
+}
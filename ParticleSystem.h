@@ -0,0 +1,67 @@
+#pragma once
+
+#include "MemoryTracker.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+#define PARTICLE_BUDGET 50000			// live particles at most, emitters drop what does not fit
+#define PARTICLE_DAMPING 0.998f			// velocity kept per ms
+#define PARTICLE_EXPLOSION_LARGE 160	// particles of a large asteroid hit, small ones get half
+#define PARTICLE_EXPLOSION_SPEED 0.25f	// pixels per ms at most
+#define PARTICLE_EXPLOSION_LIFE 700.f	// ms at most
+#define PARTICLE_THRUST_BURST 24		// when the engine starts
+#define PARTICLE_THRUST_TRAIL 6			// every tick the engine runs
+#define PARTICLE_THRUST_SPEED 0.20f
+#define PARTICLE_THRUST_LIFE 300.f
+#define PARTICLE_BENCHMARK_PARTICLES 40000
+#define PARTICLE_BENCHMARK_FRAMES 1000
+
+class ParticleSystem
+{
+	/*
+	Explosion debris and engine exhaust. Particles are purely visual, live in flat arrays
+	allocated once for PARTICLE_BUDGET particles and are updated by straight loops over
+	those arrays that the compiler vectorizes. Dead particles are replaced by the last live one,
+	so the live particles always take the front of the arrays.
+	Everything is drawn with one vertex array of quads. Particles have their own random
+	generator, so they never draw from the random streams the game (and its replays) depends on
+	*/
+public:
+	ParticleSystem(const int _budget = PARTICLE_BUDGET);
+private:
+	int budget;
+	int count = 0;
+	int dropped = 0;
+	std::uint32_t random = 0x9e3779b9;
+
+	// Particles
+	TrackedVector<float, MEMORY_EFFECTS> x, y, vx, vy;
+	TrackedVector<float, MEMORY_EFFECTS> life, maxLife, size;
+	TrackedVector<std::uint32_t, MEMORY_EFFECTS> color; // RGBA, alpha fades with life
+
+	TrackedVector<sf::Vertex, MEMORY_EFFECTS> vertices; // 4 per particle
+	int numOfVertices = 0;
+
+public:
+	void update(const float dt);
+	void buildVertices();
+	void clear();
+
+	// Emitters, scale thins the particles out (QualityGovernor::getEffectsScale)
+	void emitExplosion(const float _x, const float _y, const int level, const float scale);
+	void emitThrust(const float _x, const float _y, const float rotation, const bool burst, const float scale);
+
+	// G&S
+	int getCount() const;
+	int getDropped() const; // particles that did not fit in the budget
+	const sf::Vertex* getVertices() const;
+	int getNumOfVertices() const;
+
+	// Keeps about the given number of particles alive and prints the time of update and buildVertices.
+	// Arguments: [particles] [frames]
+	static int runBenchmark(int argc, char* argv[]);
+
+private:
+	void emit(const float _x, const float _y, const float _vx, const float _vy, const float _life, const float _size, const std::uint32_t _color);
+	float randomFloat(); // 0 - 1
+};
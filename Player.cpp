@@ -1,9 +1,12 @@
 #include "Player.h"
+#include "Telemetry.h"
+#include "FixedMath.h"
 
-Player::Player(const sf::Texture& _playerTexture, const sf::Texture& _bulletTexture)
+Player::Player(const sf::Texture& _playerTexture, const sf::Texture& _bulletTexture, TimerWheel& _timerWheel)
 	:
 	playerTexture{ _playerTexture },
 	bulletTexture{_bulletTexture },
+	timerWheel{ _timerWheel },
 	health{ INTIAL_PLAYER_HEALTH},
 	score{ 0 }
 {
@@ -13,7 +16,8 @@ Player::Player(const sf::Texture& _playerTexture, const sf::Texture& _bulletText
 
 Player::~Player()
 {
-	
+	timerWheel.cancel(shotTimer);
+
 	while (readyBullets.size() != 0)
 	{
 		Bullet* currentBullet = readyBullets.back();
@@ -36,40 +40,46 @@ void Player::setUp()
 	Function initializes player sprite
 	*/
 	setTexture(playerTexture);
-	scale(sf::Vector2f(0.015f, 0.025f));
+	scale(sf::Vector2f(RULES_SHIP_SCALE_X, RULES_SHIP_SCALE_Y));
 	setOrigin(400.0f + getLocalBounds().width / 2, 400.f + getLocalBounds().height / 2);
-	setPosition(400.0f, 400.0f);
+	setPosition(RULES_SCREEN_SIZE / 2, RULES_SCREEN_SIZE / 2);
 }
 
 // Shooting
 void Player::createBullets()
 {
 	for (int i{ 0 }; i < numberOfBullets; i++)
+	{
 		readyBullets.push_back(new Bullet(bulletTexture));
+		readyBullets.back()->id = i;
+	}
 }
 
 void Player::shootBullet()
 {
 	/*
-	Function checks if elapsed time since last bullet shot is greater than specified shootDelay
-	it adds the bullet pointer to the moving bullets dequeu and restarts the shotTimer
+	Function checks if the gun has reloaded (shotTimer is no longer pending)
+	it adds the bullet pointer to the moving bullets list and restarts the shotTimer
 	*/
-	if (shotTimer.getElapsedTime().asMilliseconds() > shootDelay || isFirstBullet)
+	if (!timerWheel.isPending(shotTimer))
 	{
-
-		if (isFirstBullet) isFirstBullet = false;
-
 		currentState = STATE_SHOOTING;
 
 		Bullet* currentBullet = std::move(readyBullets.back());					
 		currentBullet->intialize(getRotation(), getPosition());
+		Telemetry::record(TELEMETRY_SHOT, getPosition().x, getPosition().y);
 		movingBullets.push_back(currentBullet);
 		readyBullets.pop_back();
 
-		shotTimer.restart().asMilliseconds();
+		shotTimer = timerWheel.schedule(shootDelay);
 	}
 }
 
+bool Player::canShoot() const
+{
+	return !readyBullets.empty() && !timerWheel.isPending(shotTimer);
+}
+
 void Player::reviveBullet(const int index)
 {
 	/*
@@ -86,38 +96,12 @@ void Player::reviveBullet(const int index)
 void Player::movePlayer(const float dt)
 {
 	/*
-	Function moves the player in direction to which the player sprite points to
-	,it calucalates the speed at which the player moves.
-	The speed is a function of elapsedTimeSinceTakeoff ( time since the user first pressed the UP Arrow Key)
+	Function moves the player in direction to which the player sprite points to,
+	with the take off boost of GameRules::shipSpeed for the time since the user first pressed the UP Arrow Key
 	*/
-
-	float angleRelavantToSprite = getRotation();
-	float speed = 0.35 * dt;
-	float elapsedTimeSinceTakeoff = thrustTimer.getElapsedTime().asMilliseconds();
-	
-	if ( elapsedTimeSinceTakeoff < speedBostTimeRange || firstSpeedBost)
-	{
-		if (elapsedTimeSinceTakeoff != 0)
-		{
-			// deltaSpeed is a simple linear interpolation defined in range t(0ms,speedBostTimeRangems) with values clamped between (deltaSpeedMax, deltaSpeedMin)
-			// with a slope < 0 && |slope| < 1 therefor deltaSpeed function decreases as a function of elapsedTimeSinceTakeoff
-			// which roughly models the thurst of a rocket 
-			const float deltaSpeedMax = 6.f;
-			const float deltaSpeedMin = 1.f;
-			const float slope = ((deltaSpeedMax - deltaSpeedMin) / (0.0f - speedBostTimeRange));
-			float deltaSpeed = deltaSpeedMax + slope * elapsedTimeSinceTakeoff;
-			speed += deltaSpeed;
-		}
-		firstSpeedBost = false;
-	}
-
-	move(sf::Vector2f(speed * sin(angleRelavantToSprite * 3.14159265 / 180), -speed * cos(angleRelavantToSprite * 3.14159265 / 180))); // moves the player in correct direction
-
-	// Bounds Check
-	if (getPosition().x > 850)		setPosition(sf::Vector2f(0, getPosition().y ));
-	else if(getPosition().x < -50)	setPosition(sf::Vector2f(800, getPosition().y));
-	else if (getPosition().y > 850) setPosition(sf::Vector2f(getPosition().x , 0));
-	else if (getPosition().y < -50) setPosition(sf::Vector2f( getPosition().x , 800));
+	float speed = GameRules::shipSpeed(dt, getThrustElapsedTime(), firstSpeedBost);
+	firstSpeedBost = false;
+	setPosition(GameRules::moveShip(getPosition(), getRotation(), speed, FixedMath::isEnabled()));
 }
 
 void Player::startRocketThrustTimer()
@@ -126,7 +110,7 @@ void Player::startRocketThrustTimer()
 	Function gets called by the Game object when player presses the UP Arrow key
 	it starts the thrustTimer clock and changes the player state
 	*/
-	thrustTimer.restart().asMilliseconds(); // start boost
+	thrustStartTick = timerWheel.getNow(); // start boost
 	currentState = STATE_MOVING;
 }
 
@@ -141,71 +125,50 @@ void Player::moveBullets(const float dt)
 	Function moves bullets at an angle, at which the bullet was shot
 	*/
 
-	std::vector<int> deleteIndexes;
-	int index = 0;
-
-	for (auto* bullet : movingBullets)
+	// backwards, so reviving a bullet does not move the ones still to be visited
+	for (int index{ movingBullets.size() - 1 }; index >= 0; index--)
 	{
-		bullet->move(sf::Vector2f(0.40f * dt * sin(bullet->angle * 3.14159265 / 180), -0.40f * dt * cos(bullet->angle * 3.14159265 / 180)));
-
-		sf::Vector2f bulletPosition = bullet->getPosition();
-		if (bulletPosition.x > 800 || bulletPosition.x < 0 || bulletPosition.y > 800 || bulletPosition.y < 0)
-			deleteIndexes.push_back(index);
-
-		index += 1;
+		Bullet* bullet = movingBullets[index];
+		bullet->setPosition(GameRules::moveBullet(bullet->getPosition(), bullet->angle, dt, FixedMath::isEnabled()));
+		if (GameRules::isOffScreen(bullet->getPosition()))
+			reviveBullet(index);
 	}
-	for (auto index : deleteIndexes)
-		reviveBullet(index);
-	
 }
 
 void Player::rotatePlayer(const float dt , int direction)
 {
-	rotate( direction * rotationSpeed * dt);
+	setRotation(GameRules::rotateShip(getRotation(), dt, direction));
 }
 
 
 // Collision
 
-void Player::playerCollides(Asteroid* asteroid)
+void Player::takeDamage()
 {
 	/*
-	Collision check between player and asteroid
+	Function is called when the ship starts touching an asteroid, touching it longer does no more damage
 	*/
-	if (getGlobalBounds().intersects(asteroid->getGlobalBounds()))
-	{
-		if (health != 0 && asteroid->madeDamage == false)
-		{
-			health--;
-			asteroid->madeDamage = true;
-		}
-	}
-	else if (asteroid->madeDamage == true)
-		asteroid->madeDamage = false;
+	if (health == 0)
+		return;
+	health--;
+	Telemetry::record(TELEMETRY_DAMAGE, getPosition().x, getPosition().y, static_cast<float>(health));
 }
 
-void Player::bulletCollides(Asteroid* asteroid)
+void Player::bulletHits(Bullet* bullet, Asteroid* asteroid)
 {
 	/*
-	Collision check between movingBullets and asteroid
+	Function scores a bullet that started touching an asteroid and spends the bullet,
+	the game breaks or removes the asteroid
 	*/
+	sf::Vector2f asteroidPositition = asteroid->getPosition();
+	score += GameRules::hitScore(asteroid->getLevel());
+	Telemetry::record(TELEMETRY_HIT, asteroidPositition.x, asteroidPositition.y, static_cast<float>(asteroid->getLevel()));
+	spendBullet(bullet);
+}
 
-	for (auto* bullet : movingBullets)
-	{
-		sf::Vector2f positition = bullet->getPosition();
-		sf::Vector2f asteroidPositition = asteroid->getPosition();
-
-
-		if (bullet->getGlobalBounds().intersects(asteroid->getGlobalBounds()))
-		{
-			if (asteroid->getLevel() == 1)
-				score += 2;
-			else if (asteroid->getLevel() == 0)
-				score += 1;
-			bullet->setPosition(-200.f, -200.f); 
-			asteroid->downSize();
-		}
-	}
+void Player::spendBullet(Bullet* bullet)
+{
+	bullet->setPosition(-200.f, -200.f); // off screen, moveBullets revives it
 }
 
 // S&G
@@ -223,4 +186,87 @@ void Player::resetParameters()
 {
 	score = 0;
 	health = INTIAL_PLAYER_HEALTH;
-}
\ No newline at end of file
+}
+
+float Player::getThrustElapsedTime() const
+{
+	return (timerWheel.getNow() - thrustStartTick) * SIM_TICK_MS;
+}
+
+// Snapshot
+
+void Player::saveState(StateWriter& writer) const
+{
+	/*
+	Function writes the player transform, timers, health, score and the moving bullets
+	*/
+	writer.write(getPosition().x);
+	writer.write(getPosition().y);
+	writer.write(getRotation());
+	writer.write(timerWheel.getRemaining(shotTimer));
+	writer.write(timerWheel.getNow() - thrustStartTick);
+	writer.write(health);
+	writer.write(score);
+	writer.write(static_cast<std::uint8_t>(currentState));
+	writer.write(static_cast<std::uint8_t>(firstSpeedBost));
+
+	writer.write(static_cast<std::uint8_t>(movingBullets.size()));
+	for (auto* bullet : movingBullets)
+	{
+		writer.write(bullet->getPosition().x);
+		writer.write(bullet->getPosition().y);
+		writer.write(bullet->getRotation());
+		writer.write(bullet->angle);
+		writer.write(static_cast<std::uint8_t>(bullet->id));
+	}
+}
+
+void Player::loadState(StateReader& reader)
+{
+	/*
+	Function restores the state written by saveState
+	*/
+	float x = reader.read<float>();
+	float y = reader.read<float>();
+	setPosition(x, y);
+	setRotation(reader.read<float>());
+
+	// timers are saved relative to the tick of the snapshot
+	timerWheel.cancel(shotTimer);
+	std::uint32_t reloadTicks = reader.read<std::uint32_t>();
+	if (reloadTicks > 0)
+		shotTimer = timerWheel.schedule(reloadTicks);
+	thrustStartTick = timerWheel.getNow() - reader.read<std::uint32_t>();
+
+	health = reader.read<int>();
+	score = reader.read<int>();
+	currentState = static_cast<playerState>(reader.read<std::uint8_t>());
+	firstSpeedBost = reader.read<std::uint8_t>() != 0;
+
+	while (!movingBullets.empty()) // every bullet back to the magazine
+		reviveBullet(0);
+
+	int numOfMovingBullets = reader.read<std::uint8_t>();
+	for (int i{ 0 }; i < numOfMovingBullets && !readyBullets.empty(); i++)
+	{
+		float bulletX = reader.read<float>();
+		float bulletY = reader.read<float>();
+		float rotation = reader.read<float>();
+		float angle = reader.read<float>();
+		int id = reader.read<std::uint8_t>();
+
+		// the same bullet object as before, its contacts are saved by id
+		int ready = static_cast<int>(readyBullets.size()) - 1;
+		for (int r{ 0 }; r < readyBullets.size(); r++)
+			if (readyBullets[r]->id == id)
+				ready = r;
+		Bullet* bullet = readyBullets[ready];
+		readyBullets[ready] = readyBullets.back();
+		readyBullets.pop_back();
+
+		bullet->setPosition(bulletX, bulletY);
+		bullet->setRotation(rotation);
+		bullet->angle = angle;
+		movingBullets.push_back(bullet);
+	}
+}
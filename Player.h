@@ -3,10 +3,11 @@
 #include <SFML/Graphics.hpp>
 #include "Bullet.h"
 #include "Asteroid.h"
-#include <deque>
-
-#define INTIAL_PLAYER_HEALTH 3
-#define NUMBER_OF_BULLETS 5
+#include "Snapshot.h"
+#include "TimerWheel.h"
+#include "MemoryTracker.h"
+#include "FixedVector.h"
+#include "GameRules.h"
 
 // Player State
 enum playerState
@@ -17,42 +18,44 @@ enum playerState
 	NUMBER_OF_PLAYER_STATES
 };
 
-class Player : public sf::Sprite
+typedef FixedVector<Bullet*, NUMBER_OF_BULLETS> BulletList;
+
+class Player : public sf::Sprite, public Tracked<MEMORY_ENTITIES>
 {
 
 public:
-	Player(const sf::Texture& _playerTexture, const sf::Texture& _bulletTexture);
+	Player(const sf::Texture& _playerTexture, const sf::Texture& _bulletTexture, TimerWheel& _timerWheel);
 	~Player();
 private:
 
 	// General
 	int health, score;
-	const float rotationSpeed = 0.25f;
 	const sf::Texture playerTexture;
 	const sf::Texture bulletTexture;
+	TimerWheel& timerWheel;
+
 	// Shooting
-	sf::Clock shotTimer;
-	const float shootDelay = 150.f;
-	bool isFirstBullet = true;
+	TimerHandle shotTimer; // pending while the gun reloads
+	const std::uint32_t shootDelay = msToTicks(RULES_RELOAD_MS);
 	const int numberOfBullets = NUMBER_OF_BULLETS;
 
 	// Rocket thrust
-	sf::Clock thrustTimer;
-	const float speedBostTimeRange = 800.f;
+	std::uint32_t thrustStartTick = 0;
 	bool firstSpeedBost = true;
 	const int boostFactor = 3;
 
 public:
 
 	playerState currentState = STATE_STATIONARY; // intial state
-	std::deque<Bullet*> readyBullets;
-	std::deque<Bullet*> movingBullets;
+	BulletList readyBullets;
+	BulletList movingBullets;
 
 public:
 
 	// Shooting
 	void shootBullet();
 	void reviveBullet(const int index);
+	bool canShoot() const;
 
 	// Movement
 	void movePlayer(const float dt);
@@ -61,17 +64,23 @@ public:
 	void startRocketThrustTimer();
 	void slowDown();
 
-	// Collision
-	void playerCollides(Asteroid* asteroid);
-	void bulletCollides(Asteroid* asteroid);
+	// Collision, for contacts that began this tick (Game::checkForCollision)
+	void takeDamage();
+	void bulletHits(Bullet* bullet, Asteroid* asteroid);
+	void spendBullet(Bullet* bullet);
 
 	// G&S
 	int getHealth();
 	int getScore();
 	void resetParameters();
 
+	// Snapshot
+	void saveState(StateWriter& writer) const;
+	void loadState(StateReader& reader);
+
 private:
 	void setUp();
 	void createBullets();
+	float getThrustElapsedTime() const;
 };
 
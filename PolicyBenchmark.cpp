@@ -0,0 +1,81 @@
+#include "PolicyBenchmark.h"
+#include "SimulationCore.h"
+#include "TimerWheel.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <map>
+
+namespace
+{
+	template <class Core>
+	void runCore(const SimScene& scene, const int steps, std::map<std::string, std::uint64_t>& referenceChecksums)
+	{
+		/*
+		Function runs one instantiation and prints its row. The first core of every integration
+		policy sets the reference checksum, the other collision policies have to end in the same state
+		*/
+		Core core{ scene };
+		auto start = std::chrono::steady_clock::now();
+		for (int i{ 0 }; i < steps; i++)
+			core.step(SIM_TICK_MS);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::string integration = Core::getName().substr(Core::getName().find(" + ") + 3);
+		std::uint64_t checksum = core.getWorld().getChecksum();
+		auto reference = referenceChecksums.emplace(integration, checksum).first;
+
+		std::cout << std::left << std::setw(40) << Core::getName() << std::right
+			<< std::setw(10) << ms
+			<< std::setw(10) << 1000.0 * ms / steps
+			<< std::setw(14) << core.getNarrowphaseTests() / steps
+			<< std::setw(8) << core.getNumOfHits()
+			<< std::setw(10) << core.getWorld().getNumOfAsteroids()
+			<< "  " << std::hex << std::setw(16) << std::setfill('0') << checksum << std::dec << std::setfill(' ')
+			<< (reference->second == checksum ? "" : "  MISMATCH") << "\n";
+	}
+
+	template <class... Cores>
+	void runCores(const SimScene& scene, const int steps)
+	{
+		std::map<std::string, std::uint64_t> referenceChecksums;
+		(runCore<Cores>(scene, steps, referenceChecksums), ...);
+	}
+}
+
+int PolicyBenchmark::run(int argc, char* argv[])
+{
+	SimScene scene;
+	int steps = POLICY_BENCHMARK_STEPS;
+	try
+	{
+		if (argc > 0) scene.numOfAsteroids = std::stoi(argv[0]);
+		if (argc > 1) steps = std::stoi(argv[1]);
+		if (argc > 2) scene.seed = static_cast<std::uint32_t>(std::stoul(argv[2]));
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-policies [asteroids] [steps] [seed]\n";
+		return 1;
+	}
+
+	std::cout << scene.numOfAsteroids << " asteroids, " << scene.numOfBullets << " bullets, "
+		<< steps << " steps, seed " << scene.seed << "\n\n";
+	std::cout << std::left << std::setw(40) << "policies" << std::right
+		<< std::setw(10) << "ms" << std::setw(10) << "us/step" << std::setw(14) << "tests/step"
+		<< std::setw(8) << "hits" << std::setw(10) << "asteroids" << "  checksum\n";
+	std::cout << std::fixed << std::setprecision(2);
+
+	runCores<
+		SimulationCore<BruteForceCollision, FloatIntegration>,
+		SimulationCore<BruteForceCollision, FixedPointIntegration>,
+		SimulationCore<GridCollision, FloatIntegration>,
+		SimulationCore<GridCollision, FixedPointIntegration>,
+		SimulationCore<SweepAndPruneCollision, FloatIntegration>,
+		SimulationCore<SweepAndPruneCollision, FixedPointIntegration>,
+		SimulationCore<ContactManagerCollision, FloatIntegration>,
+		SimulationCore<ContactManagerCollision, FixedPointIntegration>
+	>(scene, steps);
+	return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#define POLICY_BENCHMARK_STEPS 600 // ten seconds of game time
+
+namespace PolicyBenchmark
+{
+	// Runs the same seeded scene under every SimulationCore instantiation and prints a comparison table.
+	// Arguments: [asteroids] [steps] [seed]
+	int run(int argc, char* argv[]);
+}
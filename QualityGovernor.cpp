@@ -0,0 +1,101 @@
+#include "QualityGovernor.h"
+
+QualityGovernor::QualityGovernor(const float _budget)
+	:
+	budget{ _budget },
+	averageFrameTime{ 0.f }
+{
+}
+
+void QualityGovernor::addFrame(const float frameTime)
+{
+	/*
+	Function adds the work time of the last frame (without waiting for the display)
+	to the running average and changes the quality level when needed
+	*/
+	averageFrameTime += GOVERNOR_SMOOTHING * (frameTime - averageFrameTime);
+	if (!enabled)
+		return;
+
+	if (averageFrameTime > GOVERNOR_DEGRADE_RATIO * budget)
+	{
+		framesWithHeadroom = 0;
+		if (++framesOverBudget >= GOVERNOR_DEGRADE_FRAMES && level < NUMBER_OF_QUALITY_LEVELS - 1)
+		{
+			level = static_cast<qualityLevel>(level + 1);
+			if (level == QUALITY_COARSE_COLLISION && !preciseCollision) // boxes are all there is, nothing to give up
+				level = static_cast<qualityLevel>(level + 1);
+			framesOverBudget = 0;
+		}
+	}
+	else if (averageFrameTime < GOVERNOR_RESTORE_RATIO * budget)
+	{
+		framesOverBudget = 0;
+		if (++framesWithHeadroom >= GOVERNOR_RESTORE_FRAMES && level > QUALITY_FULL)
+		{
+			level = static_cast<qualityLevel>(level - 1);
+			if (level == QUALITY_COARSE_COLLISION && !preciseCollision)
+				level = static_cast<qualityLevel>(level - 1);
+			framesWithHeadroom = 0;
+		}
+	}
+	else // close to the budget, hold the current level
+	{
+		framesOverBudget = 0;
+		framesWithHeadroom = 0;
+	}
+}
+
+void QualityGovernor::setEnabled(const bool _enabled)
+{
+	enabled = _enabled;
+	if (!enabled)
+		level = QUALITY_FULL;
+}
+
+void QualityGovernor::setPreciseCollision(const bool _preciseCollision)
+{
+	preciseCollision = _preciseCollision;
+}
+
+// G&S
+qualityLevel QualityGovernor::getLevel() const
+{
+	return level;
+}
+
+const char* QualityGovernor::getLevelName() const
+{
+	const char* names[NUMBER_OF_QUALITY_LEVELS] = { "full", "no HUD relayout", "coarse collision", "fewer effects", "capped spawns" };
+	return names[level];
+}
+
+float QualityGovernor::getAverageFrameTime() const
+{
+	return averageFrameTime;
+}
+
+float QualityGovernor::getBudget() const
+{
+	return budget;
+}
+
+bool QualityGovernor::allowsHudRelayout(const int frameNumber) const
+{
+	return level < QUALITY_NO_HUD_RELAYOUT || frameNumber % HUD_REFRESH_FRAMES == 0;
+}
+
+bool QualityGovernor::usesPreciseCollision() const
+{
+	return preciseCollision && level < QUALITY_COARSE_COLLISION;
+}
+
+float QualityGovernor::getEffectsScale() const
+{
+	return level < QUALITY_FEWER_EFFECTS ? 1.f : 0.25f;
+}
+
+bool QualityGovernor::allowsSpawn(const int numOfAsteroids) const
+{
+	return level < QUALITY_CAPPED_SPAWNS || numOfAsteroids < MAX_ASTEROIDS_UNDER_PRESSURE;
+}
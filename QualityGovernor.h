@@ -0,0 +1,56 @@
+#pragma once
+
+#define FRAME_BUDGET_MS (1000.f / 60)
+#define GOVERNOR_SMOOTHING 0.1f			// weight of the newest frame in the average
+#define GOVERNOR_DEGRADE_RATIO 0.90f	// of the budget, above it quality drops a level
+#define GOVERNOR_RESTORE_RATIO 0.60f	// of the budget, below it quality comes back a level
+#define GOVERNOR_DEGRADE_FRAMES 10		// frames over budget before a level is dropped
+#define GOVERNOR_RESTORE_FRAMES 120		// frames with headroom before a level is restored
+#define HUD_REFRESH_FRAMES 15			// HUD re-layout interval once it is degraded
+#define MAX_ASTEROIDS_UNDER_PRESSURE 64
+
+// Quality Level, every level keeps the degradations of the levels before it
+enum qualityLevel
+{
+	QUALITY_FULL,
+	QUALITY_NO_HUD_RELAYOUT,	// HUD strings are rebuilt only every HUD_REFRESH_FRAMES frames
+	QUALITY_COARSE_COLLISION,	// bounding boxes only, the circle narrowphase of --precise-collision is skipped (the level is stepped over without it)
+	QUALITY_FEWER_EFFECTS,		// effects are thinned out
+	QUALITY_CAPPED_SPAWNS,		// no new asteroids past MAX_ASTEROIDS_UNDER_PRESSURE
+	NUMBER_OF_QUALITY_LEVELS
+};
+
+class QualityGovernor
+{
+	/*
+	Watches how long the previous frames took to simulate and draw and steps the quality
+	down while they overrun the frame budget, and back up once there is headroom again
+	*/
+public:
+	QualityGovernor(const float _budget = FRAME_BUDGET_MS);
+private:
+	float budget;
+	float averageFrameTime;
+	int framesOverBudget = 0;
+	int framesWithHeadroom = 0;
+	qualityLevel level = QUALITY_FULL;
+	bool enabled = true;
+	bool preciseCollision = false; // asked for, full quality is the bounding box test
+
+public:
+	void addFrame(const float frameTime);
+	void setEnabled(const bool _enabled);
+	void setPreciseCollision(const bool _preciseCollision);
+
+	// G&S
+	qualityLevel getLevel() const;
+	const char* getLevelName() const;
+	float getAverageFrameTime() const;
+	float getBudget() const;
+
+	// What the current level allows
+	bool allowsHudRelayout(const int frameNumber) const;
+	bool usesPreciseCollision() const;
+	float getEffectsScale() const;
+	bool allowsSpawn(const int numOfAsteroids) const;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+class RenderBackend
+{
+	/*
+	Everything the game draws goes through a backend, so the same frame can be
+	drawn by SFML (GPU) or by the software rasterizer (CPU, no GPU needed)
+	*/
+public:
+	virtual ~RenderBackend() {}
+
+	virtual void clear(const sf::Color& color = sf::Color::Black) = 0;
+	virtual void drawSprite(const sf::Sprite& sprite) = 0;
+	virtual void drawText(const sf::Text& text) = 0;
+	virtual void drawVertices(const sf::Vertex* vertices, const std::size_t count, const sf::PrimitiveType type) = 0; // untextured
+	virtual void drawTexturedQuads(const sf::Vertex* vertices, const std::size_t count, const sf::Texture& texture) = 0; // axis aligned sf::Quads
+	virtual void prepareTexture(const sf::Texture& /*texture*/) {} // before the first frame, for backends that keep their own copy
+	virtual void reserveDrawCalls(const std::size_t /*count*/) {} // most draws of a frame, for backends that record them
+	virtual void display() = 0; // finishes the frame
+
+	virtual sf::Vector2u getSize() const = 0;
+	virtual const sf::Uint8* getPixels() const { return nullptr; } // RGBA frame in memory, if the backend has one
+};
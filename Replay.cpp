@@ -0,0 +1,104 @@
+#include "Replay.h"
+#include <iostream>
+
+// Replay Recorder
+
+bool ReplayRecorder::open(const std::string& fileName, const std::uint32_t seed, const std::uint32_t flags)
+{
+	file.open(fileName, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "Error opening " << fileName << "\n";
+		return false;
+	}
+	ReplayFileHeader header{ REPLAY_MAGIC, REPLAY_VERSION, sizeof(ReplayRecord), seed, flags };
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	numOfRecords = 0;
+	return true;
+}
+
+void ReplayRecorder::record(const int tick, const TickInput& input)
+{
+	if (!file.is_open())
+		return;
+
+	ReplayRecord record{};
+	record.tick = static_cast<std::uint32_t>(tick);
+	for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
+	{
+		record.held[c] = input.held[c];
+		if (input.down[c])
+			record.down |= 1 << c;
+	}
+	file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+	numOfRecords++;
+}
+
+void ReplayRecorder::close()
+{
+	if (file.is_open())
+		file.close();
+}
+
+bool ReplayRecorder::isOpen() const
+{
+	return file.is_open();
+}
+
+int ReplayRecorder::getNumOfRecords() const
+{
+	return numOfRecords;
+}
+
+// Replay Player
+
+bool ReplayPlayer::open(const std::string& fileName)
+{
+	std::ifstream file{ fileName, std::ios::binary };
+	if (!file)
+	{
+		std::cerr << "Error opening " << fileName << "\n";
+		return false;
+	}
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION || header.recordSize != sizeof(ReplayRecord))
+	{
+		std::cerr << fileName << " is not a replay of this version\n";
+		return false;
+	}
+
+	ReplayRecord record;
+	while (file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+		records.push_back(record);
+	next = 0;
+	return true;
+}
+
+bool ReplayPlayer::read(const int tick, TickInput& input)
+{
+	if (isFinished() || records[next].tick != static_cast<std::uint32_t>(tick))
+		return false;
+
+	const ReplayRecord& record = records[next++];
+	for (int c{ 0 }; c < NUMBER_OF_INPUT_CONTROLS; c++)
+	{
+		input.held[c] = record.held[c];
+		input.down[c] = (record.down >> c) & 1;
+	}
+	return true;
+}
+
+bool ReplayPlayer::isFinished() const
+{
+	return next >= static_cast<int>(records.size());
+}
+
+std::uint32_t ReplayPlayer::getSeed() const
+{
+	return header.seed;
+}
+
+std::uint32_t ReplayPlayer::getFlags() const
+{
+	return header.flags;
+}
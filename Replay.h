@@ -0,0 +1,65 @@
+#pragma once
+
+#include "InputQueue.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define REPLAY_MAGIC 0x50525341 // "ASRP"
+#define REPLAY_VERSION 2
+#define REPLAY_FLAG_FIXED_POINT 1 // recorded with --fixed-point, played the same way
+#define REPLAY_FLAG_PRECISE_COLLISION 2 // recorded with --precise-collision
+
+struct ReplayFileHeader
+{
+	std::uint32_t magic;
+	std::uint16_t version;
+	std::uint16_t recordSize;
+	std::uint32_t seed;		// seed of the game's random streams
+	std::uint32_t flags;
+};
+
+// Fixed size record of one tick, written to the file as is
+struct ReplayRecord
+{
+	std::uint32_t tick;
+	float held[NUMBER_OF_INPUT_CONTROLS];
+	std::uint8_t down;		// bit per control
+	std::uint8_t reserved[3];
+};
+static_assert(sizeof(ReplayRecord) == 24, "replay records have a fixed size");
+
+class ReplayRecorder
+{
+	/*
+	Writes the input of every tick of one game, played back with the same seed the game
+	goes through exactly the same ticks
+	*/
+private:
+	std::ofstream file;
+	int numOfRecords = 0;
+public:
+	bool open(const std::string& fileName, const std::uint32_t seed, const std::uint32_t flags);
+	void record(const int tick, const TickInput& input);
+	void close();
+	bool isOpen() const;
+	int getNumOfRecords() const;
+};
+
+class ReplayPlayer
+{
+	/*
+	Reads a whole replay file and hands out its ticks in order
+	*/
+private:
+	ReplayFileHeader header{};
+	std::vector<ReplayRecord> records;
+	int next = 0;
+public:
+	bool open(const std::string& fileName);
+	bool read(const int tick, TickInput& input); // false when the replay is over or does not match the tick
+	bool isFinished() const;
+	std::uint32_t getSeed() const;
+	std::uint32_t getFlags() const;
+};
@@ -0,0 +1,430 @@
+#include "Script.h"
+#include "AllocationHook.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+namespace
+{
+	struct FramePool
+	{
+		void* freeFrames[SCRIPT_FRAME_CLASSES] = {}; // a free frame starts with the next free frame of its class
+		TrackedVector<std::uint8_t*, MEMORY_SCRIPTS> chunks;
+		std::size_t chunkUsed = SCRIPT_FRAME_CHUNK_BYTES; // no chunk yet
+		int liveFrames = 0;
+		std::size_t liveBytes = 0;
+
+		~FramePool()
+		{
+			for (std::uint8_t* chunk : chunks)
+				MemoryTracker::deallocate(chunk, SCRIPT_FRAME_CHUNK_BYTES, MEMORY_SCRIPTS);
+		}
+	};
+
+	thread_local FramePool pool;
+	thread_local int numOfSchedulers = 0; // the pool is trimmed when the last one is destroyed
+
+	int getSizeClass(const std::size_t size)
+	{
+		int sizeClass = 0;
+		while (sizeClass < SCRIPT_FRAME_CLASSES && (static_cast<std::size_t>(SCRIPT_FRAME_MIN_BYTES) << sizeClass) < size)
+			sizeClass++;
+		return sizeClass; // SCRIPT_FRAME_CLASSES when the frame is too large for the pool
+	}
+}
+
+// Frame Pool
+
+void* ScriptFrames::allocate(const std::size_t size)
+{
+	/*
+	Function takes a frame of the size class from its free list or from the current chunk,
+	the end of a chunk too small for the frame is left unused
+	*/
+	const int sizeClass = getSizeClass(size);
+	if (sizeClass == SCRIPT_FRAME_CLASSES)
+		return MemoryTracker::allocate(size, MEMORY_SCRIPTS);
+
+	const std::size_t bytes = static_cast<std::size_t>(SCRIPT_FRAME_MIN_BYTES) << sizeClass;
+	void* frame = pool.freeFrames[sizeClass];
+	if (frame)
+		pool.freeFrames[sizeClass] = *static_cast<void**>(frame);
+	else
+	{
+		if (pool.chunkUsed + bytes > SCRIPT_FRAME_CHUNK_BYTES)
+		{
+			pool.chunks.push_back(static_cast<std::uint8_t*>(MemoryTracker::allocate(SCRIPT_FRAME_CHUNK_BYTES, MEMORY_SCRIPTS)));
+			pool.chunkUsed = 0;
+		}
+		frame = pool.chunks.back() + pool.chunkUsed;
+		pool.chunkUsed += bytes;
+	}
+	pool.liveFrames++;
+	pool.liveBytes += bytes;
+	return frame;
+}
+
+void ScriptFrames::deallocate(void* frame, const std::size_t size)
+{
+	const int sizeClass = getSizeClass(size);
+	if (sizeClass == SCRIPT_FRAME_CLASSES)
+	{
+		MemoryTracker::deallocate(frame, size, MEMORY_SCRIPTS);
+		return;
+	}
+
+	*static_cast<void**>(frame) = pool.freeFrames[sizeClass];
+	pool.freeFrames[sizeClass] = frame;
+	pool.liveFrames--;
+	pool.liveBytes -= static_cast<std::size_t>(SCRIPT_FRAME_MIN_BYTES) << sizeClass;
+}
+
+void ScriptFrames::trim()
+{
+	if (pool.liveFrames > 0)
+		return;
+	for (std::uint8_t* chunk : pool.chunks)
+		MemoryTracker::deallocate(chunk, SCRIPT_FRAME_CHUNK_BYTES, MEMORY_SCRIPTS);
+	TrackedVector<std::uint8_t*, MEMORY_SCRIPTS>().swap(pool.chunks); // its capacity is charged to scripts too
+	std::fill(pool.freeFrames, pool.freeFrames + SCRIPT_FRAME_CLASSES, nullptr);
+	pool.chunkUsed = SCRIPT_FRAME_CHUNK_BYTES;
+	pool.liveBytes = 0;
+}
+
+int ScriptFrames::getLiveFrames()
+{
+	return pool.liveFrames;
+}
+
+std::size_t ScriptFrames::getLiveBytes()
+{
+	return pool.liveBytes;
+}
+
+std::size_t ScriptFrames::getPoolBytes()
+{
+	return pool.chunks.size() * SCRIPT_FRAME_CHUNK_BYTES;
+}
+
+// Script
+
+Script Script::promise_type::get_return_object()
+{
+	return Script(Handle::from_promise(*this));
+}
+
+Script::Script(const Handle _handle)
+	:
+	handle{ _handle }
+{
+}
+
+Script::Script(Script&& other) noexcept
+	:
+	handle{ other.handle }
+{
+	other.handle = nullptr;
+}
+
+Script::~Script()
+{
+	if (handle) // never started
+		handle.destroy();
+}
+
+// Signal
+
+ScriptSignal::~ScriptSignal()
+{
+	/*
+	Scripts still waiting are left suspended until their scheduler destroys them
+	*/
+	for (Script::promise_type* promise = firstWaiting; promise; promise = promise->nextWaiting)
+		promise->signal = nullptr;
+}
+
+void ScriptSignal::raise()
+{
+	/*
+	Function hands every waiting script to its scheduler, in the order they started waiting
+	*/
+	Script::promise_type* promise = firstWaiting;
+	firstWaiting = lastWaiting = nullptr;
+	numOfWaiting = 0;
+	while (promise)
+	{
+		Script::promise_type* next = promise->nextWaiting;
+		promise->signal = nullptr;
+		promise->previousWaiting = promise->nextWaiting = nullptr;
+		promise->scheduler->makeReady(*promise);
+		promise = next;
+	}
+}
+
+int ScriptSignal::getNumOfWaiting() const
+{
+	return numOfWaiting;
+}
+
+// Scheduler
+
+ScriptScheduler::ScriptScheduler()
+{
+	numOfSchedulers++;
+}
+
+ScriptScheduler::~ScriptScheduler()
+{
+	clear();
+	if (--numOfSchedulers == 0)
+		ScriptFrames::trim();
+}
+
+void ScriptScheduler::reserve(const int scripts)
+{
+	timerWheel.reserve(static_cast<std::size_t>(std::max(scripts, 0)));
+}
+
+void ScriptScheduler::start(Script script)
+{
+	Script::Handle handle = script.handle;
+	script.handle = nullptr;
+
+	Script::promise_type& promise = handle.promise();
+	promise.scheduler = this;
+	promise.next = firstScript;
+	if (firstScript)
+		firstScript->previous = &promise;
+	firstScript = &promise;
+	numOfScripts++;
+	resume(promise);
+}
+
+void ScriptScheduler::tick()
+{
+	/*
+	Function fires the timers of this tick, then resumes the scripts whose wait ended. Scripts that
+	end a wait of another (raising a signal) get it resumed in the same tick, after themselves
+	*/
+	ticking = true;
+	timerWheel.advance();
+	while (firstReady)
+	{
+		Script::promise_type& promise = *firstReady;
+		firstReady = promise.nextReady;
+		if (!firstReady)
+			lastReady = nullptr;
+		promise.nextReady = nullptr;
+		resume(promise);
+	}
+	ticking = false;
+}
+
+void ScriptScheduler::clear()
+{
+	firstReady = lastReady = nullptr;
+	while (firstScript)
+		destroy(*firstScript);
+}
+
+void ScriptScheduler::suspend(Script::promise_type& promise, const std::uint32_t ticks)
+{
+	promise.timer = timerWheel.schedule(ticks, [&promise]()
+		{
+			promise.timer = TimerHandle();
+			promise.scheduler->makeReady(promise);
+		});
+}
+
+void ScriptScheduler::suspend(Script::promise_type& promise, ScriptSignal& signal)
+{
+	promise.signal = &signal;
+	promise.previousWaiting = signal.lastWaiting;
+	promise.nextWaiting = nullptr;
+	if (signal.lastWaiting)
+		signal.lastWaiting->nextWaiting = &promise;
+	else
+		signal.firstWaiting = &promise;
+	signal.lastWaiting = &promise;
+	signal.numOfWaiting++;
+}
+
+void ScriptScheduler::makeReady(Script::promise_type& promise)
+{
+	if (lastReady)
+		lastReady->nextReady = &promise;
+	else
+		firstReady = &promise;
+	lastReady = &promise;
+}
+
+void ScriptScheduler::resume(Script::promise_type& promise)
+{
+	Script::Handle handle = Script::Handle::from_promise(promise);
+	numOfResumes++;
+	handle.resume();
+	if (handle.done())
+		destroy(promise);
+}
+
+void ScriptScheduler::destroy(Script::promise_type& promise)
+{
+	/*
+	Function cancels what the script waits for, unlinks it and frees its frame
+	*/
+	timerWheel.cancel(promise.timer);
+	if (ScriptSignal* signal = promise.signal)
+	{
+		if (promise.previousWaiting)
+			promise.previousWaiting->nextWaiting = promise.nextWaiting;
+		else
+			signal->firstWaiting = promise.nextWaiting;
+		if (promise.nextWaiting)
+			promise.nextWaiting->previousWaiting = promise.previousWaiting;
+		else
+			signal->lastWaiting = promise.previousWaiting;
+		signal->numOfWaiting--;
+	}
+
+	if (promise.previous)
+		promise.previous->next = promise.next;
+	else
+		firstScript = promise.next;
+	if (promise.next)
+		promise.next->previous = promise.previous;
+	numOfScripts--;
+
+	Script::Handle::from_promise(promise).destroy();
+}
+
+// Waits
+
+void ScriptScheduler::TickWait::await_suspend(Script::Handle handle)
+{
+	scheduler->suspend(handle.promise(), ticks);
+}
+
+void ScriptScheduler::SignalWait::await_suspend(Script::Handle handle)
+{
+	handle.promise().scheduler->suspend(handle.promise(), *signal);
+}
+
+ScriptScheduler::TickWait ScriptScheduler::waitTicks(const std::uint32_t ticks)
+{
+	return TickWait{ this, ticks };
+}
+
+ScriptScheduler::TickWait ScriptScheduler::waitSeconds(const float seconds)
+{
+	return TickWait{ this, msToTicks(seconds * 1000.f) };
+}
+
+ScriptScheduler::SignalWait ScriptScheduler::waitFor(ScriptSignal& signal)
+{
+	return SignalWait{ &signal };
+}
+
+// G&S
+int ScriptScheduler::getNumOfScripts() const
+{
+	return numOfScripts;
+}
+
+int ScriptScheduler::getNumOfResumes() const
+{
+	return numOfResumes;
+}
+
+bool ScriptScheduler::isTicking() const
+{
+	return ticking;
+}
+
+// Benchmark
+
+static Script benchmarkBehaviour(ScriptScheduler& scheduler, ScriptSignal& signal, const int id, long long& wakeups)
+{
+	/*
+	Function is a per-entity behaviour: wait a while, do a little, every fourth also waits for the signal
+	*/
+	for (;;)
+	{
+		co_await scheduler.waitTicks(30 + id % 97);
+		wakeups++;
+		if (id % 4 == 0)
+			co_await scheduler.waitFor(signal);
+	}
+}
+
+static Script benchmarkIdle(ScriptScheduler& scheduler, ScriptSignal& signal)
+{
+	co_await scheduler.waitFor(signal);
+}
+
+int ScriptScheduler::runBenchmark(int argc, char* argv[])
+{
+	int scripts = SCRIPT_BENCHMARK_SCRIPTS;
+	int ticks = SCRIPT_BENCHMARK_TICKS;
+	try
+	{
+		if (argc > 0) scripts = std::stoi(argv[0]);
+		if (argc > 1) ticks = std::stoi(argv[1]);
+	}
+	catch (const std::exception&)
+	{
+		std::cerr << "Usage: --bench-scripts [scripts] [ticks]\n";
+		return 1;
+	}
+
+	ScriptScheduler scheduler;
+	ScriptSignal signal;
+	long long wakeups = 0;
+	typedef std::chrono::steady_clock Clock;
+
+	scheduler.reserve(scripts);
+
+	// busy: every script wakes up every 30 to 126 ticks, a quarter of them also waits for a signal raised once a second
+	auto start = Clock::now();
+	for (int i{ 0 }; i < scripts; i++)
+		scheduler.start(benchmarkBehaviour(scheduler, signal, i, wakeups));
+	double startSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+	const std::size_t frameBytes = ScriptFrames::getLiveBytes();
+
+	long long allocationsBefore = AllocationHook::getThreadAllocations();
+	int resumesBefore = scheduler.getNumOfResumes();
+	start = Clock::now();
+	for (int tick{ 0 }; tick < ticks; tick++)
+	{
+		if (tick % SIM_TICKS_PER_SECOND == 0)
+			signal.raise();
+		scheduler.tick();
+	}
+	double busySeconds = std::chrono::duration<double>(Clock::now() - start).count();
+	long long busyAllocations = AllocationHook::getThreadAllocations() - allocationsBefore;
+	int busyResumes = scheduler.getNumOfResumes() - resumesBefore;
+
+	start = Clock::now();
+	scheduler.clear();
+	double clearSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// idle: every script waits for a signal that never comes
+	for (int i{ 0 }; i < scripts; i++)
+		scheduler.start(benchmarkIdle(scheduler, signal));
+	start = Clock::now();
+	for (int tick{ 0 }; tick < ticks; tick++)
+		scheduler.tick();
+	double idleSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+	scheduler.clear();
+
+	std::cout << scripts << " scripts, " << ticks << " ticks, " << frameBytes / std::max(scripts, 1) << " frame bytes per script, "
+		<< ScriptFrames::getPoolBytes() / 1024 << " KB pooled\n";
+	std::cout << "  start " << 1e9 * startSeconds / std::max(scripts, 1) << " ns, destroy " << 1e9 * clearSeconds / std::max(scripts, 1)
+		<< " ns per script\n";
+	std::cout << "  busy " << 1e6 * busySeconds / ticks << " us per tick, " << busyResumes / std::max(ticks, 1) << " resumes per tick, "
+		<< 1e9 * busySeconds / std::max(busyResumes, 1) << " ns per resume\n";
+	std::cout << "  idle " << 1e6 * idleSeconds / ticks << " us per tick\n";
+	if (AllocationHook::isEnabled())
+		std::cout << "  " << busyAllocations << " heap allocations while ticking\n";
+	return 0;
+}
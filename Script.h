@@ -0,0 +1,169 @@
+#pragma once
+
+#include "TimerWheel.h"
+#include "MemoryTracker.h"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#define SCRIPT_FRAME_CLASSES 6				// size classes of the frame pool: 64, 128, ... 2048 bytes
+#define SCRIPT_FRAME_MIN_BYTES 64
+#define SCRIPT_FRAME_CHUNK_BYTES 65536		// the pool grows by chunks of this size
+#define SCRIPT_BENCHMARK_SCRIPTS 10000
+#define SCRIPT_BENCHMARK_TICKS 600
+
+class ScriptScheduler;
+class ScriptSignal;
+
+namespace ScriptFrames
+{
+	/*
+	Pool the coroutine frames of scripts are allocated from. A frame is rounded up to a size class and
+	taken from that class's free list, or carved from the current chunk when the list is empty.
+	Frames go back to their free list and chunks are kept until the last scheduler of the thread
+	is destroyed, so starting and finishing scripts in a warmed up game does not touch the heap.
+	Every thread has its own pool
+	*/
+	void* allocate(const std::size_t size);
+	void deallocate(void* frame, const std::size_t size);
+	void trim(); // frees the chunks when no frame is live, the leak check at shutdown must not see them
+
+	// G&S, of the calling thread's pool
+	int getLiveFrames();
+	std::size_t getLiveBytes();		// rounded up to the size classes
+	std::size_t getPoolBytes();		// chunks, frames that do not fit a size class are not pooled
+}
+
+class Script
+{
+	/*
+	A script is a function returning Script that co_awaits the waits of a ScriptScheduler,
+	for example: wait 3 s, spawn a wave, wait until it is cleared. It does not run until it is
+	given to ScriptScheduler::start, which owns it from then on and resumes it on the tick its wait ends.
+	A waiting script is only its frame, a timer or a link in a signal's list, it costs nothing per tick
+	*/
+public:
+	struct promise_type
+	{
+		ScriptScheduler* scheduler = nullptr;
+		promise_type* previous = nullptr;		// every script of the scheduler
+		promise_type* next = nullptr;
+		promise_type* nextReady = nullptr;		// scripts to resume in this tick
+		ScriptSignal* signal = nullptr;			// the signal waited for, if any
+		promise_type* previousWaiting = nullptr;
+		promise_type* nextWaiting = nullptr;
+		TimerHandle timer;
+
+		Script get_return_object();
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; } // the scheduler destroys finished scripts
+		void return_void() {}
+		void unhandled_exception() { throw; }
+
+		static void* operator new(const std::size_t size) { return ScriptFrames::allocate(size); }
+		static void operator delete(void* frame, const std::size_t size) { ScriptFrames::deallocate(frame, size); }
+	};
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	Script(Script&& other) noexcept;
+	~Script();
+	Script(const Script&) = delete;
+	Script& operator=(const Script&) = delete;
+private:
+	explicit Script(const Handle _handle);
+	Handle handle;
+
+	friend class ScriptScheduler;
+};
+
+class ScriptSignal
+{
+	/*
+	Something scripts can wait for, like a cleared wave. Waiting scripts are linked into the signal,
+	raise() hands all of them to their scheduler to be resumed in the same tick
+	*/
+public:
+	ScriptSignal() = default;
+	~ScriptSignal();
+	ScriptSignal(const ScriptSignal&) = delete;
+	ScriptSignal& operator=(const ScriptSignal&) = delete;
+private:
+	Script::promise_type* firstWaiting = nullptr;
+	Script::promise_type* lastWaiting = nullptr;
+	int numOfWaiting = 0;
+
+public:
+	void raise();
+
+	// G&S
+	int getNumOfWaiting() const;
+
+	friend class ScriptScheduler;
+};
+
+class ScriptScheduler
+{
+	/*
+	Runs scripts on the simulation tick. Waits for a number of ticks are timers on the scheduler's own
+	TimerWheel, which only advances when tick() is called, so scripts see game time, not the time spent
+	in menus. Scripts whose wait ended are resumed in the order their waits ended
+	*/
+public:
+	ScriptScheduler();
+	~ScriptScheduler();
+	ScriptScheduler(const ScriptScheduler&) = delete;
+	ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+private:
+	TimerWheel timerWheel;
+	Script::promise_type* firstScript = nullptr;
+	Script::promise_type* firstReady = nullptr;
+	Script::promise_type* lastReady = nullptr;
+	int numOfScripts = 0;
+	int numOfResumes = 0;
+	bool ticking = false;
+
+public:
+	struct TickWait
+	{
+		ScriptScheduler* scheduler;
+		std::uint32_t ticks;
+		bool await_ready() const noexcept { return ticks == 0; }
+		void await_suspend(Script::Handle handle);
+		void await_resume() const noexcept {}
+	};
+	struct SignalWait
+	{
+		ScriptSignal* signal;
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(Script::Handle handle);
+		void await_resume() const noexcept {}
+	};
+
+	void reserve(const int scripts); // timers for that many scripts waiting at once, so ticking never allocates
+	void start(Script script); // runs the script up to its first wait
+	void tick(); // advances the timers and resumes every script whose wait ended
+	void clear(); // destroys every script, not to be called from a script
+
+	// Waits, to co_await in a script of this scheduler
+	TickWait waitTicks(const std::uint32_t ticks);
+	TickWait waitSeconds(const float seconds);
+	SignalWait waitFor(ScriptSignal& signal);
+
+	// G&S
+	int getNumOfScripts() const;
+	int getNumOfResumes() const; // since the scheduler was created
+	bool isTicking() const; // scripts are being resumed by tick()
+
+	// Keeps thousands of scripts waiting on timers and a signal, prints the cost per tick and per script.
+	// Arguments: [scripts] [ticks]
+	static int runBenchmark(int argc, char* argv[]);
+
+private:
+	void suspend(Script::promise_type& promise, const std::uint32_t ticks);
+	void suspend(Script::promise_type& promise, ScriptSignal& signal);
+	void makeReady(Script::promise_type& promise);
+	void resume(Script::promise_type& promise);
+	void destroy(Script::promise_type& promise);
+
+	friend class ScriptSignal;
+};
@@ -0,0 +1,44 @@
+#include "SfmlRenderBackend.h"
+
+SfmlRenderBackend::SfmlRenderBackend(sf::RenderTarget& _target)
+	:
+	target{ _target }
+{
+}
+
+void SfmlRenderBackend::clear(const sf::Color& color)
+{
+	target.clear(color);
+}
+
+void SfmlRenderBackend::drawSprite(const sf::Sprite& sprite)
+{
+	target.draw(sprite);
+}
+
+void SfmlRenderBackend::drawText(const sf::Text& text)
+{
+	target.draw(text);
+}
+
+void SfmlRenderBackend::drawVertices(const sf::Vertex* vertices, const std::size_t count, const sf::PrimitiveType type)
+{
+	if (count > 0)
+		target.draw(vertices, count, type);
+}
+
+void SfmlRenderBackend::drawTexturedQuads(const sf::Vertex* vertices, const std::size_t count, const sf::Texture& texture)
+{
+	if (count > 0)
+		target.draw(vertices, count, sf::Quads, sf::RenderStates(&texture));
+}
+
+void SfmlRenderBackend::display()
+{
+	// the window or render texture is displayed by its owner
+}
+
+sf::Vector2u SfmlRenderBackend::getSize() const
+{
+	return target.getSize();
+}
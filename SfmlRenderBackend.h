@@ -0,0 +1,19 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+class SfmlRenderBackend : public RenderBackend
+{
+public:
+	SfmlRenderBackend(sf::RenderTarget& _target);
+private:
+	sf::RenderTarget& target;
+public:
+	void clear(const sf::Color& color = sf::Color::Black) override;
+	void drawSprite(const sf::Sprite& sprite) override;
+	void drawText(const sf::Text& text) override;
+	void drawVertices(const sf::Vertex* vertices, const std::size_t count, const sf::PrimitiveType type) override;
+	void drawTexturedQuads(const sf::Vertex* vertices, const std::size_t count, const sf::Texture& texture) override;
+	void display() override;
+	sf::Vector2u getSize() const override;
+};
@@ -0,0 +1,162 @@
+#include "SimWorld.h"
+#include <cmath>
+
+SimWorld::SimWorld(const SimScene& _scene)
+	:
+	scene{ _scene }
+{
+	reset();
+}
+
+void SimWorld::reset()
+{
+	/*
+	Function builds the starting scene, like Game::setupGame with scene.numOfAsteroids,
+	the streams start from the seed again
+	*/
+	maxAsteroids = 2 * scene.numOfAsteroids; // room for every asteroid to split once, like the pool of the game
+	numOfSpawns = 0;
+
+	asteroidX.clear(); asteroidY.clear();
+	asteroidSpeed.clear(); asteroidDirectionX.clear(); asteroidDirectionY.clear();
+	asteroidRadius.clear(); asteroidLevel.clear();
+	asteroidRandom.clear(); asteroidBounds.clear();
+	for (std::vector<float>* v : { &asteroidX, &asteroidY, &asteroidSpeed, &asteroidDirectionX, &asteroidDirectionY, &asteroidRadius })
+		v->reserve(maxAsteroids);
+	asteroidLevel.reserve(maxAsteroids);
+	asteroidRandom.reserve(maxAsteroids);
+	asteroidBounds.reserve(maxAsteroids);
+
+	for (int i{ 0 }; i < scene.numOfAsteroids; i++)
+		spawnAsteroid(1);
+
+	bulletX.assign(scene.numOfBullets, 0.f);
+	bulletY.assign(scene.numOfBullets, 0.f);
+	bulletAngle.assign(scene.numOfBullets, 0.f);
+	bulletBounds.assign(scene.numOfBullets, sf::FloatRect());
+	for (int i{ 0 }; i < scene.numOfBullets; i++)
+	{
+		bulletAngle[i] = 360.f * i / scene.numOfBullets;
+		fireBullet(i);
+	}
+	updateBounds();
+}
+
+int SimWorld::spawnAsteroid(const int level)
+{
+	/*
+	Function adds an asteroid rolled with the next stream of the scene, like Game::spawnAsteroid,
+	and returns its index, or -1 once maxAsteroids is reached. A large one is placed by its roll
+	*/
+	if (getNumOfAsteroids() >= maxAsteroids)
+		return -1;
+
+	asteroidX.push_back(0.f);
+	asteroidY.push_back(0.f);
+	asteroidSpeed.push_back(0.f);
+	asteroidDirectionX.push_back(0.f);
+	asteroidDirectionY.push_back(0.f);
+	asteroidRadius.push_back(GameRules::asteroidBounds(sf::Vector2f(0.f, 0.f)).width / 2);
+	asteroidLevel.push_back(static_cast<std::uint8_t>(level));
+	asteroidRandom.push_back(CounterRandom(scene.seed, numOfSpawns++));
+	asteroidBounds.push_back(sf::FloatRect());
+	rollAsteroid(getNumOfAsteroids() - 1);
+	return getNumOfAsteroids() - 1;
+}
+
+void SimWorld::hitAsteroid(const int index)
+{
+	/*
+	Function does what Asteroid::downSize does: a large asteroid becomes a small one
+	where it is, a small one comes back as a large one somewhere else
+	*/
+	asteroidLevel[index] = asteroidLevel[index] == 1 ? 0 : 1;
+	rollAsteroid(index);
+}
+
+void SimWorld::spawnFragment(const int index)
+{
+	/*
+	Function spawns a small asteroid where the asteroid at index is, what Game::checkForCollision
+	does once per tick for the last asteroid that broke
+	*/
+	const int fragment = spawnAsteroid(0);
+	if (fragment == -1)
+		return;
+	asteroidX[fragment] = asteroidX[index];
+	asteroidY[fragment] = asteroidY[index];
+}
+
+void SimWorld::setVelocity(const int index, const float vx, const float vy)
+{
+	asteroidSpeed[index] = 1.f;
+	asteroidDirectionX[index] = vx;
+	asteroidDirectionY[index] = vy;
+}
+
+void SimWorld::fireBullet(const int index)
+{
+	/*
+	Function fires the bullet again from its turret, every shot turns the turret by the golden angle
+	*/
+	const int turret = index % SIM_TURRETS;
+	bulletX[index] = SIM_SCREEN_SIZE * (turret % 4 + 0.5f) / 4;
+	bulletY[index] = SIM_SCREEN_SIZE * (turret / 4 + 0.5f) / 4;
+	bulletAngle[index] = std::fmod(bulletAngle[index] + 137.50776f, 360.f);
+}
+
+void SimWorld::updateBounds()
+{
+	/*
+	Function computes the hit boxes the game would test this tick
+	*/
+	for (int i{ 0 }; i < getNumOfAsteroids(); i++)
+		asteroidBounds[i] = GameRules::asteroidBounds(sf::Vector2f(asteroidX[i], asteroidY[i]));
+	for (int i{ 0 }; i < getNumOfBullets(); i++)
+		bulletBounds[i] = GameRules::bulletBounds(sf::Vector2f(bulletX[i], bulletY[i]), bulletAngle[i]);
+}
+
+int SimWorld::getNumOfAsteroids() const
+{
+	return static_cast<int>(asteroidX.size());
+}
+
+int SimWorld::getNumOfBullets() const
+{
+	return static_cast<int>(bulletX.size());
+}
+
+std::uint64_t SimWorld::getChecksum() const
+{
+	/*
+	Function returns a FNV-1a hash of the asteroid state, equal checksums mean equal runs
+	*/
+	std::uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](const void* data, const std::size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i{ 0 }; i < size; i++)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+	};
+	add(asteroidX.data(), asteroidX.size() * sizeof(float));
+	add(asteroidY.data(), asteroidY.size() * sizeof(float));
+	add(asteroidSpeed.data(), asteroidSpeed.size() * sizeof(float));
+	add(asteroidDirectionX.data(), asteroidDirectionX.size() * sizeof(float));
+	add(asteroidDirectionY.data(), asteroidDirectionY.size() * sizeof(float));
+	add(asteroidLevel.data(), asteroidLevel.size());
+	return hash;
+}
+
+void SimWorld::rollAsteroid(const int index)
+{
+	/*
+	Function rolls speed, direction and for a large asteroid the position from the asteroid's own stream
+	*/
+	sf::Vector2f direction;
+	sf::Vector2f position(asteroidX[index], asteroidY[index]);
+	GameRules::rollAsteroid(asteroidLevel[index], asteroidRandom[index], asteroidSpeed[index], direction, position);
+	asteroidX[index] = position.x;
+	asteroidY[index] = position.y;
+	asteroidDirectionX[index] = direction.x;
+	asteroidDirectionY[index] = direction.y;
+}
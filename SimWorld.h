@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GameRules.h"
+#include "CounterRandom.h"
+#include <vector>
+#include <cstdint>
+
+// Scene constants, the field of the game (pixels, milliseconds)
+#define SIM_FIELD_MIN RULES_ASTEROID_WRAP_MIN	// asteroids wrap around like Asteroid::moveAsteroid
+#define SIM_FIELD_MAX RULES_ASTEROID_WRAP_MAX
+#define SIM_SCREEN_SIZE RULES_SCREEN_SIZE
+#define SIM_TURRETS 16						// fixed guns spread over the screen, one bullet each
+
+// Bullet against asteroid overlap
+struct SimHit
+{
+	int bullet;
+	int asteroid;
+};
+
+struct SimScene
+{
+	int numOfAsteroids = 1000;
+	int numOfBullets = 256;
+	std::uint32_t seed = 1;
+};
+
+class SimWorld
+{
+	/*
+	Headless structure-of-arrays version of the game world, no textures or sprites.
+	Asteroids are rolled, broken and spawned by the GameRules of Asteroid and Game, each with
+	its own CounterRandom stream like the game gives them, so the same scene always plays out
+	the same way. Turrets stand in for the ship, their bullets fly like the player's
+	*/
+public:
+	SimWorld(const SimScene& _scene = SimScene());
+
+	// Asteroids
+	std::vector<float> asteroidX, asteroidY;
+	std::vector<float> asteroidSpeed, asteroidDirectionX, asteroidDirectionY; // as in Asteroid, speed * direction is px per ms
+	std::vector<float> asteroidRadius;			// Asteroid::getRadius, for the solver and the autopilot
+	std::vector<std::uint8_t> asteroidLevel;
+	std::vector<CounterRandom> asteroidRandom;
+	int maxAsteroids;
+
+	// Bullets, always flying, a bullet leaving the screen is fired again from its turret
+	std::vector<float> bulletX, bulletY;
+	std::vector<float> bulletAngle;
+
+	// Hit boxes of the last updateBounds(), GameRules::asteroidBounds and bulletBounds
+	std::vector<sf::FloatRect> asteroidBounds, bulletBounds;
+
+private:
+	SimScene scene;
+	std::uint64_t numOfSpawns = 0;
+
+public:
+	void reset();
+	int spawnAsteroid(const int level); // index, or -1 once maxAsteroids is reached
+	void hitAsteroid(const int index);
+	void spawnFragment(const int index);
+	void setVelocity(const int index, const float vx, const float vy); // like Asteroid::setVelocity, after a bounce
+	void fireBullet(const int index);
+	void updateBounds();
+
+	int getNumOfAsteroids() const;
+	int getNumOfBullets() const;
+	std::uint64_t getChecksum() const;
+
+private:
+	void rollAsteroid(const int index);
+};
@@ -0,0 +1,93 @@
+#include "SimulationCore.h"
+#include <algorithm>
+
+template <class CollisionPolicy, class IntegrationPolicy>
+SimulationCore<CollisionPolicy, IntegrationPolicy>::SimulationCore(const SimScene& scene)
+	:
+	world{ scene }
+{
+}
+
+template <class CollisionPolicy, class IntegrationPolicy>
+void SimulationCore<CollisionPolicy, IntegrationPolicy>::step(const float dt)
+{
+	/*
+	Function moves the world by dt and breaks every asteroid a bullet hit, Game::updateGame
+	and checkForCollision without the ship
+	*/
+	IntegrationPolicy::integrate(world, dt);
+	world.updateBounds();
+
+	hits.clear();
+	collision.findHits(world, hits, narrowphaseTests);
+	resolveHits();
+}
+
+template <class CollisionPolicy, class IntegrationPolicy>
+void SimulationCore<CollisionPolicy, IntegrationPolicy>::resolveHits()
+{
+	/*
+	Function sorts the hits, so every collision policy resolves them in the same order, the order
+	of the contact events of the game: a bullet is spent on the lowest numbered asteroid it overlaps,
+	which breaks unless it already broke this step, and the last asteroid that broke spawns a small one
+	*/
+	std::sort(hits.begin(), hits.end(), [](const SimHit& hit1, const SimHit& hit2)
+	{
+		return hit1.bullet != hit2.bullet ? hit1.bullet < hit2.bullet : hit1.asteroid < hit2.asteroid;
+	});
+	asteroidHit.assign(world.getNumOfAsteroids(), 0);
+
+	int lastBullet = -1;
+	int deadAsteroid = -1;
+	for (const SimHit& hit : hits)
+	{
+		if (hit.bullet == lastBullet)
+			continue;
+		lastBullet = hit.bullet;
+		world.fireBullet(hit.bullet);
+		if (asteroidHit[hit.asteroid])
+			continue;
+		asteroidHit[hit.asteroid] = 1;
+
+		world.hitAsteroid(hit.asteroid);
+		deadAsteroid = hit.asteroid;
+		numOfHits++;
+	}
+	if (deadAsteroid != -1)
+		world.spawnFragment(deadAsteroid);
+}
+
+// G&S
+template <class CollisionPolicy, class IntegrationPolicy>
+const SimWorld& SimulationCore<CollisionPolicy, IntegrationPolicy>::getWorld() const
+{
+	return world;
+}
+
+template <class CollisionPolicy, class IntegrationPolicy>
+std::uint64_t SimulationCore<CollisionPolicy, IntegrationPolicy>::getNarrowphaseTests() const
+{
+	return narrowphaseTests;
+}
+
+template <class CollisionPolicy, class IntegrationPolicy>
+long long SimulationCore<CollisionPolicy, IntegrationPolicy>::getNumOfHits() const
+{
+	return numOfHits;
+}
+
+template <class CollisionPolicy, class IntegrationPolicy>
+std::string SimulationCore<CollisionPolicy, IntegrationPolicy>::getName()
+{
+	return std::string(CollisionPolicy::getName()) + " + " + IntegrationPolicy::getName();
+}
+
+// Instantiations, the set of cores compiled into the game
+template class SimulationCore<BruteForceCollision, FloatIntegration>;
+template class SimulationCore<BruteForceCollision, FixedPointIntegration>;
+template class SimulationCore<GridCollision, FloatIntegration>;
+template class SimulationCore<GridCollision, FixedPointIntegration>;
+template class SimulationCore<SweepAndPruneCollision, FloatIntegration>;
+template class SimulationCore<SweepAndPruneCollision, FixedPointIntegration>;
+template class SimulationCore<ContactManagerCollision, FloatIntegration>;
+template class SimulationCore<ContactManagerCollision, FixedPointIntegration>;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SimWorld.h"
+#include "SimulationPolicies.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+template <class CollisionPolicy, class IntegrationPolicy>
+class SimulationCore
+{
+	/*
+	Headless simulation step of the game, built from a collision and an integration policy
+	on the GameRules, hit boxes and hit handling of Game.
+	The member functions are defined in SimulationCore.cpp and only the combinations
+	instantiated there exist, add a line there to benchmark a new policy
+	*/
+public:
+	SimulationCore(const SimScene& scene);
+private:
+	SimWorld world;
+	CollisionPolicy collision;
+	std::vector<SimHit> hits;
+	std::vector<std::uint8_t> asteroidHit;	// per step, an asteroid breaks only once
+	std::uint64_t narrowphaseTests = 0;
+	long long numOfHits = 0;
+
+public:
+	void step(const float dt);
+
+	// G&S
+	const SimWorld& getWorld() const;
+	std::uint64_t getNarrowphaseTests() const;
+	long long getNumOfHits() const;
+	static std::string getName();
+
+private:
+	void resolveHits();
+};
+
+extern template class SimulationCore<BruteForceCollision, FloatIntegration>;
+extern template class SimulationCore<BruteForceCollision, FixedPointIntegration>;
+extern template class SimulationCore<GridCollision, FloatIntegration>;
+extern template class SimulationCore<GridCollision, FixedPointIntegration>;
+extern template class SimulationCore<SweepAndPruneCollision, FloatIntegration>;
+extern template class SimulationCore<SweepAndPruneCollision, FixedPointIntegration>;
+extern template class SimulationCore<ContactManagerCollision, FloatIntegration>;
+extern template class SimulationCore<ContactManagerCollision, FixedPointIntegration>;
@@ -0,0 +1,215 @@
+#include "SimulationPolicies.h"
+#include <algorithm>
+#include <cmath>
+
+#define SIM_ASTEROID_BOX_WIDTH (RULES_ASTEROID_TEXTURE_WIDTH * RULES_ASTEROID_SCALE)
+#define SIM_ASTEROID_BOX_HEIGHT (RULES_ASTEROID_TEXTURE_HEIGHT * RULES_ASTEROID_SCALE)
+#define SIM_REACH_MARGIN 1.f				// px around the box sizes, so rounding never culls a pair the boxes test positive
+#define SIM_GRID_CELL_SIZE SIM_ASTEROID_BOX_WIDTH
+#define SIM_GRID_CELLS (static_cast<int>((SIM_FIELD_MAX - SIM_FIELD_MIN) / SIM_GRID_CELL_SIZE) + 1)
+
+// Brute Force
+
+void BruteForceCollision::findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests)
+{
+	const int numOfAsteroids = world.getNumOfAsteroids();
+	const int numOfBullets = world.getNumOfBullets();
+
+	for (int b{ 0 }; b < numOfBullets; b++)
+	{
+		for (int a{ 0 }; a < numOfAsteroids; a++)
+		{
+			if (GameRules::overlaps(world.bulletBounds[b], world.asteroidBounds[a], false))
+				hits.push_back({ b, a });
+		}
+	}
+	tests += static_cast<std::uint64_t>(numOfAsteroids) * numOfBullets;
+}
+
+// Grid
+
+int GridCollision::getCell(const float position)
+{
+	int cell = static_cast<int>((position - SIM_FIELD_MIN) / SIM_GRID_CELL_SIZE);
+	return std::min(std::max(cell, 0), SIM_GRID_CELLS - 1);
+}
+
+void GridCollision::findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests)
+{
+	/*
+	Function rebuilds the grid with a counting sort (no allocations once the vectors have grown)
+	and tests every bullet against the asteroids of the cells whose boxes can reach its box
+	*/
+	const int numOfAsteroids = world.getNumOfAsteroids();
+	cellStart.assign(SIM_GRID_CELLS * SIM_GRID_CELLS + 1, 0);
+	cellAsteroids.resize(numOfAsteroids);
+	asteroidCell.resize(numOfAsteroids);
+
+	for (int a{ 0 }; a < numOfAsteroids; a++)
+	{
+		asteroidCell[a] = getCell(world.asteroidY[a]) * SIM_GRID_CELLS + getCell(world.asteroidX[a]);
+		cellStart[asteroidCell[a]]++;
+	}
+	for (int c{ 1 }; c < SIM_GRID_CELLS * SIM_GRID_CELLS; c++) // end of every cell
+		cellStart[c] += cellStart[c - 1];
+	cellStart[SIM_GRID_CELLS * SIM_GRID_CELLS] = numOfAsteroids;
+	for (int a{ numOfAsteroids - 1 }; a >= 0; a--) // moves every end back to the start, cells list their asteroids in index order
+		cellAsteroids[--cellStart[asteroidCell[a]]] = a;
+
+	for (int b{ 0 }; b < world.getNumOfBullets(); b++)
+	{
+		const sf::FloatRect& bounds = world.bulletBounds[b];
+		const int firstX = getCell(bounds.left - SIM_ASTEROID_BOX_WIDTH - SIM_REACH_MARGIN);
+		const int lastX = getCell(bounds.left + bounds.width + SIM_REACH_MARGIN);
+		const int firstY = getCell(bounds.top - SIM_ASTEROID_BOX_HEIGHT - SIM_REACH_MARGIN);
+		const int lastY = getCell(bounds.top + bounds.height + SIM_REACH_MARGIN);
+		for (int y{ firstY }; y <= lastY; y++)
+		{
+			for (int x{ firstX }; x <= lastX; x++)
+			{
+				const int cell = y * SIM_GRID_CELLS + x;
+				for (int i{ cellStart[cell] }; i < cellStart[cell + 1]; i++)
+				{
+					const int a = cellAsteroids[i];
+					if (GameRules::overlaps(bounds, world.asteroidBounds[a], false))
+						hits.push_back({ b, a });
+				}
+				tests += cellStart[cell + 1] - cellStart[cell];
+			}
+		}
+	}
+}
+
+// Sweep And Prune
+
+void SweepAndPruneCollision::updateOrder(std::vector<int>& order, const std::vector<float>& keys)
+{
+	/*
+	Function appends new indexes and insertion sorts the order by key. Wrapped and respawned
+	asteroids jump across the whole order, once that gets too expensive it sorts from scratch
+	*/
+	const int size = static_cast<int>(keys.size());
+	if (static_cast<int>(order.size()) != size)
+	{
+		order.clear();
+		for (int i{ 0 }; i < size; i++)
+			order.push_back(i);
+	}
+
+	int shiftsLeft = 4 * size;
+	for (int i{ 1 }; i < size; i++)
+	{
+		int index = order[i];
+		float key = keys[index];
+		int j = i - 1;
+		while (j >= 0 && keys[order[j]] > key)
+		{
+			order[j + 1] = order[j];
+			j--;
+			if (--shiftsLeft == 0)
+			{
+				order[j + 1] = index;
+				std::sort(order.begin(), order.end(), [&keys](const int i1, const int i2) { return keys[i1] < keys[i2]; });
+				return;
+			}
+		}
+		order[j + 1] = index;
+	}
+}
+
+void SweepAndPruneCollision::findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests)
+{
+	/*
+	Function sweeps the sorted bullets and asteroids along x, the window of asteroids
+	within reach of a bullet only ever moves forward. An asteroid box starts at its position,
+	a bullet box turns around the bullet's position, so it lies within the box diagonal of it
+	*/
+	updateOrder(asteroidOrder, world.asteroidX);
+	updateOrder(bulletOrder, world.bulletX);
+
+	static const float bulletReach = std::hypot(RULES_BULLET_TEXTURE_WIDTH, RULES_BULLET_TEXTURE_HEIGHT) * RULES_BULLET_SCALE + SIM_REACH_MARGIN;
+	const int numOfAsteroids = world.getNumOfAsteroids();
+	int first = 0;
+
+	for (int b : bulletOrder)
+	{
+		const float bulletX = world.bulletX[b];
+		while (first < numOfAsteroids && world.asteroidX[asteroidOrder[first]] < bulletX - bulletReach - SIM_ASTEROID_BOX_WIDTH)
+			first++;
+
+		for (int i{ first }; i < numOfAsteroids && world.asteroidX[asteroidOrder[i]] <= bulletX + bulletReach; i++)
+		{
+			const int a = asteroidOrder[i];
+			if (GameRules::overlaps(world.bulletBounds[b], world.asteroidBounds[a], false))
+				hits.push_back({ b, a });
+			tests++;
+		}
+	}
+}
+
+// Contact Manager
+
+void ContactManagerCollision::findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests)
+{
+	/*
+	Function fills the targets and probes in like Game::checkForCollision and reports every
+	contact that lasts this tick, the ones that began and the ones that stayed
+	*/
+	if (!reserved)
+	{
+		contacts.reserve(world.getNumOfBullets(), world.maxAsteroids);
+		reserved = true;
+	}
+
+	const int numOfAsteroids = world.getNumOfAsteroids();
+	contacts.setNumOfTargets(numOfAsteroids);
+	for (int a{ 0 }; a < numOfAsteroids; a++)
+		ContactManager::boundingCircle(world.asteroidBounds[a], contacts.targetX[a], contacts.targetY[a], contacts.targetRadius[a]);
+	float x, y, radius;
+	for (int b{ 0 }; b < world.getNumOfBullets(); b++)
+	{
+		ContactManager::boundingCircle(world.bulletBounds[b], x, y, radius);
+		contacts.setProbe(b, x, y, radius);
+	}
+
+	contacts.update([&](const int b, const int a) { return GameRules::overlaps(world.bulletBounds[b], world.asteroidBounds[a], false); });
+	for (const ContactEvent& event : contacts.getEvents())
+		if (event.phase != CONTACT_END)
+			hits.push_back({ event.probe, event.target });
+	tests += contacts.getNumOfTests();
+}
+
+// Integration
+
+template <bool fixedPoint>
+static void moveWorld(SimWorld& world, const float dt)
+{
+	/*
+	Function moves every asteroid and bullet like Game::updateGame, a bullet that leaves the screen is fired again
+	*/
+	for (int i{ 0 }; i < world.getNumOfAsteroids(); i++)
+	{
+		sf::Vector2f moved = GameRules::moveAsteroid(sf::Vector2f(world.asteroidX[i], world.asteroidY[i]), world.asteroidSpeed[i],
+			sf::Vector2f(world.asteroidDirectionX[i], world.asteroidDirectionY[i]), dt, fixedPoint);
+		world.asteroidX[i] = moved.x;
+		world.asteroidY[i] = moved.y;
+	}
+	for (int i{ 0 }; i < world.getNumOfBullets(); i++)
+	{
+		sf::Vector2f moved = GameRules::moveBullet(sf::Vector2f(world.bulletX[i], world.bulletY[i]), world.bulletAngle[i], dt, fixedPoint);
+		world.bulletX[i] = moved.x;
+		world.bulletY[i] = moved.y;
+		if (GameRules::isOffScreen(moved))
+			world.fireBullet(i);
+	}
+}
+
+void FloatIntegration::integrate(SimWorld& world, const float dt)
+{
+	moveWorld<false>(world, dt);
+}
+
+void FixedPointIntegration::integrate(SimWorld& world, const float dt)
+{
+	moveWorld<true>(world, dt);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "SimWorld.h"
+#include "ContactManager.h"
+#include <vector>
+#include <cstdint>
+
+/*
+Strategy policies for SimulationCore. A collision policy finds every bullet/asteroid pair
+whose hit boxes overlap (GameRules::overlaps on the boxes of SimWorld::updateBounds, in any order),
+an integration policy moves the asteroids and bullets by dt the way Game::updateGame does.
+They are template arguments, so the inner loops are compiled for one strategy and never go
+through a virtual call
+*/
+
+// Collision Policies
+
+class BruteForceCollision
+{
+	/*
+	Every bullet against every asteroid
+	*/
+public:
+	static const char* getName() { return "brute force"; }
+	void findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests);
+};
+
+class GridCollision
+{
+	/*
+	Asteroids are binned by the top left corner of their box into a uniform grid with cells
+	as large as the box, every bullet only looks at the cells its box can reach
+	*/
+public:
+	static const char* getName() { return "grid"; }
+	void findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests);
+private:
+	std::vector<int> cellStart;		// prefix sums, asteroids of cell c are cellAsteroids[cellStart[c] .. cellStart[c + 1])
+	std::vector<int> cellAsteroids;
+	std::vector<int> asteroidCell;
+
+	static int getCell(const float position);
+};
+
+class SweepAndPruneCollision
+{
+	/*
+	Asteroids and bullets are kept sorted along x, a bullet only tests asteroids whose box
+	can reach its own on x. The orders are kept between steps and fixed up
+	with insertion sort, which is close to linear since objects barely move in a step
+	*/
+public:
+	static const char* getName() { return "sweep and prune"; }
+	void findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests);
+private:
+	std::vector<int> asteroidOrder;
+	std::vector<int> bulletOrder;
+
+	static void updateOrder(std::vector<int>& order, const std::vector<float>& keys);
+};
+
+class ContactManagerCollision
+{
+	/*
+	What Game::checkForCollision does: the contacts of a ContactManager, bounding circles
+	of the boxes in its broadphase, the bullets are its probes
+	*/
+public:
+	static const char* getName() { return "contact manager"; }
+	void findHits(const SimWorld& world, std::vector<SimHit>& hits, std::uint64_t& tests);
+private:
+	ContactManager contacts;
+	bool reserved = false;
+};
+
+// Integration Policies
+
+class FloatIntegration
+{
+	/*
+	Asteroid::moveAsteroid and Player::moveBullets in floats, the default of the game
+	*/
+public:
+	static const char* getName() { return "float"; }
+	static void integrate(SimWorld& world, const float dt);
+};
+
+class FixedPointIntegration
+{
+	/*
+	The same moves on the FixedMath grid, what --fixed-point plays with
+	*/
+public:
+	static const char* getName() { return "fixed point"; }
+	static void integrate(SimWorld& world, const float dt);
+};
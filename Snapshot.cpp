@@ -0,0 +1,284 @@
+#include "Snapshot.h"
+
+SnapshotBuffer::SnapshotBuffer(const int _capacity, const size_t _memoryBudget)
+	:
+	capacity{ _capacity },
+	memoryBudget{ _memoryBudget }
+{
+	entries.resize(capacity);
+	storage.resize(memoryBudget);
+	previousState.reserve(SNAPSHOT_RESERVED_STATE_BYTES);
+}
+
+void SnapshotBuffer::reserveState(const size_t bytes)
+{
+	previousState.reserve(bytes);
+}
+
+SnapshotBuffer::Entry& SnapshotBuffer::at(const int i)
+{
+	return entries[(oldest + i) % capacity];
+}
+
+void SnapshotBuffer::push(const int tick, const std::vector<std::uint8_t>& state)
+{
+	/*
+	Function stores the serialized state of the given tick, evicting the oldest
+	snapshots when the ring is full or the memory budget is exceeded
+	*/
+	if (count == capacity)
+		evictOldest();
+
+	// every run pair covers at least one byte of state, so this bounds the encoded size
+	const size_t maxEncodedSize = 3 * state.size() + 32;
+	if (!reserveSpace(maxEncodedSize)) // larger than the whole budget
+	{
+		clear();
+		return;
+	}
+
+	bool keyframe = count == 0 || sinceKeyframe >= SNAPSHOT_KEYFRAME_INTERVAL;
+	Entry& entry = at(count);
+	entry.tick = tick;
+	entry.keyframe = keyframe;
+	entry.rawSize = state.size();
+	entry.offset = head;
+
+	if (keyframe)
+	{
+		entry.size = encodeDelta(nullptr, 0, state, &storage[head]); // keyframes are encoded against an empty state
+		sinceKeyframe = 0;
+	}
+	else
+		entry.size = encodeDelta(previousState.data(), previousState.size(), state, &storage[head]);
+
+	head += entry.size;
+	sinceKeyframe++;
+	count++;
+	usedBytes += entry.size;
+	previousState.assign(state.begin(), state.end());
+}
+
+bool SnapshotBuffer::restore(const int tick, std::vector<std::uint8_t>& state)
+{
+	/*
+	Function rebuilds the state of the given tick from the closest keyframe before it
+	*/
+	int index = -1;
+	for (int i{ count - 1 }; i >= 0; i--)
+	{
+		if (at(i).tick == tick)
+		{
+			index = i;
+			break;
+		}
+	}
+	if (index == -1)
+		return false;
+
+	int keyframe = index;
+	while (!at(keyframe).keyframe)
+		keyframe--; // oldest entry is always a keyframe
+
+	state.clear();
+	for (int i{ keyframe }; i <= index; i++)
+		applyDelta(&storage[at(i).offset], at(i).size, at(i).rawSize, state);
+	return true;
+}
+
+bool SnapshotBuffer::latest(std::vector<std::uint8_t>& state)
+{
+	if (count == 0)
+		return false;
+	state.assign(previousState.begin(), previousState.end());
+	return true;
+}
+
+void SnapshotBuffer::dropAfter(const int tick)
+{
+	/*
+	Function forgets every snapshot newer than tick, used when gameplay resumes from a rewound tick
+	*/
+	while (count > 0 && at(count - 1).tick > tick)
+	{
+		count--;
+		usedBytes -= at(count).size;
+	}
+	head = count > 0 ? at(count - 1).offset + at(count - 1).size : 0;
+
+	sinceKeyframe = 0;
+	for (int i{ count - 1 }; i >= 0; i--)
+	{
+		sinceKeyframe++;
+		if (at(i).keyframe)
+			break;
+	}
+
+	if (count > 0)
+		restore(at(count - 1).tick, previousState);
+}
+
+void SnapshotBuffer::clear()
+{
+	oldest = 0;
+	count = 0;
+	usedBytes = 0;
+	sinceKeyframe = 0;
+	head = 0;
+	previousState.clear();
+}
+
+void SnapshotBuffer::evictOldest()
+{
+	/*
+	Function removes the oldest snapshot, deltas that would lose their keyframe are removed too
+	*/
+	do
+	{
+		usedBytes -= at(0).size;
+		oldest = (oldest + 1) % capacity;
+		count--;
+	} while (count > 0 && !at(0).keyframe);
+
+	if (count == 0)
+	{
+		sinceKeyframe = SNAPSHOT_KEYFRAME_INTERVAL; // next snapshot has to be a keyframe
+		head = 0;
+	}
+}
+
+bool SnapshotBuffer::reserveSpace(const size_t size)
+{
+	/*
+	Function makes room for size contiguous bytes at head, wrapping to the start of storage
+	and evicting the oldest snapshots as needed. Live snapshots take [oldest, head) of the ring,
+	or [oldest, end) and [0, head) once it has wrapped
+	*/
+	if (size > storage.size())
+		return false;
+
+	while (count > 0)
+	{
+		const size_t tail = at(0).offset;
+		const bool wrapped = head < tail || (head == tail && usedBytes > 0);
+		if (wrapped)
+		{
+			if (head + size <= tail)
+				return true;
+		}
+		else if (head + size <= storage.size())
+			return true;
+		else if (size <= tail) // the space at the end is too small, continue at the start
+		{
+			head = 0;
+			return true;
+		}
+		evictOldest();
+	}
+	head = 0;
+	return true;
+}
+
+// Delta Encoding
+
+static void writeVarint(std::uint8_t* out, size_t& size, size_t value)
+{
+	while (value >= 0x80)
+	{
+		out[size++] = static_cast<std::uint8_t>(value | 0x80);
+		value >>= 7;
+	}
+	out[size++] = static_cast<std::uint8_t>(value);
+}
+
+static size_t readVarint(const std::uint8_t* in, const size_t inSize, size_t& offset)
+{
+	size_t value = 0;
+	int shift = 0;
+	while (offset < inSize)
+	{
+		std::uint8_t byte = in[offset++];
+		value |= static_cast<size_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			break;
+		shift += 7;
+	}
+	return value;
+}
+
+size_t SnapshotBuffer::encodeDelta(const std::uint8_t* previous, const size_t previousSize, const std::vector<std::uint8_t>& current, std::uint8_t* out)
+{
+	/*
+	Function writes current XOR previous as a list of (unchanged run, changed run, changed bytes)
+	into out and returns the number of bytes written, bytes past the end of previous are treated as zero
+	*/
+	size_t outSize = 0;
+	const size_t size = current.size();
+	const size_t common = previousSize < size ? previousSize : size;
+	auto byteAt = [&](size_t i) -> std::uint8_t { return i < common ? previous[i] : 0; };
+
+	size_t i = 0;
+	while (i < size)
+	{
+		size_t start = i;
+		// skip unchanged bytes, 8 at a time while both buffers have them
+		while (i + 8 <= common && std::memcmp(&current[i], &previous[i], 8) == 0)
+			i += 8;
+		while (i < size && current[i] == byteAt(i))
+			i++;
+		size_t unchanged = i - start;
+
+		// changed run ends at the first 4 unchanged bytes in a row
+		start = i;
+		int equalInRow = 0;
+		while (i < size && equalInRow < 4)
+		{
+			equalInRow = (current[i] == byteAt(i)) ? equalInRow + 1 : 0;
+			i++;
+		}
+		if (equalInRow == 4)
+			i -= 4;
+		size_t changed = i - start;
+
+		writeVarint(out, outSize, unchanged);
+		writeVarint(out, outSize, changed);
+		for (size_t j{ start }; j < i; j++)
+			out[outSize++] = current[j] ^ byteAt(j);
+	}
+	return outSize;
+}
+
+void SnapshotBuffer::applyDelta(const std::uint8_t* delta, const size_t deltaSize, const size_t rawSize, std::vector<std::uint8_t>& state)
+{
+	state.resize(rawSize); // grown bytes are zero, matching encodeDelta
+
+	size_t offset = 0, i = 0;
+	while (offset < deltaSize)
+	{
+		i += readVarint(delta, deltaSize, offset);
+		size_t changed = readVarint(delta, deltaSize, offset);
+		for (size_t j{ 0 }; j < changed && i < rawSize; j++)
+			state[i++] ^= delta[offset++];
+	}
+}
+
+// G&S
+int SnapshotBuffer::getOldestTick() const
+{
+	return count > 0 ? entries[oldest].tick : -1;
+}
+
+int SnapshotBuffer::getNewestTick() const
+{
+	return count > 0 ? entries[(oldest + count - 1) % capacity].tick : -1;
+}
+
+int SnapshotBuffer::getCount() const
+{
+	return count;
+}
+
+size_t SnapshotBuffer::getUsedBytes() const
+{
+	return usedBytes;
+}
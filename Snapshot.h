@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#define SNAPSHOT_VERSION 5
+#define SNAPSHOT_KEYFRAME_INTERVAL 30
+#define SNAPSHOT_SECONDS 5
+#define SNAPSHOT_MEMORY_BUDGET (4 * 1024 * 1024) // bytes of encoded snapshots kept in the ring
+#define SNAPSHOT_RESERVED_STATE_BYTES (16 * 1024) // serialized game state with every pooled asteroid in use fits
+
+class StateWriter
+{
+	/*
+	Appends plain values to a byte buffer, the buffer keeps its capacity between snapshots
+	*/
+public:
+	StateWriter(std::vector<std::uint8_t>& _buffer) : buffer{ _buffer } { buffer.clear(); }
+private:
+	std::vector<std::uint8_t>& buffer;
+public:
+	template <typename T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots only store plain values");
+		size_t offset = buffer.size();
+		buffer.resize(offset + sizeof(T));
+		std::memcpy(buffer.data() + offset, &value, sizeof(T));
+	}
+};
+
+class StateReader
+{
+public:
+	StateReader(const std::vector<std::uint8_t>& _buffer) : buffer{ _buffer } {}
+private:
+	const std::vector<std::uint8_t>& buffer;
+	size_t offset = 0;
+	bool failed = false;
+public:
+	template <typename T>
+	T read()
+	{
+		T value{};
+		if (offset + sizeof(T) > buffer.size())
+		{
+			failed = true;
+			return value;
+		}
+		std::memcpy(&value, buffer.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return value;
+	}
+	bool good() const { return !failed; }
+};
+
+class SnapshotBuffer
+{
+	/*
+	Ring buffer of the last snapshots. Every SNAPSHOT_KEYFRAME_INTERVAL-th snapshot is stored whole,
+	the others are stored as the run length encoded XOR against the previous snapshot.
+	Encoded snapshots are written straight into one byte ring of the memory budget, allocated
+	up front, so recording a snapshot never allocates once the state has reached its size
+	*/
+public:
+	SnapshotBuffer(const int _capacity, const size_t _memoryBudget = SNAPSHOT_MEMORY_BUDGET);
+private:
+
+	struct Entry
+	{
+		int tick = -1;
+		bool keyframe = false;
+		size_t rawSize = 0;
+		size_t offset = 0;	// into storage
+		size_t size = 0;	// encoded bytes
+	};
+
+	int capacity;
+	size_t memoryBudget;
+	std::vector<Entry> entries;
+	int oldest = 0; // index of the oldest live entry
+	int count = 0;
+	size_t usedBytes = 0;
+	int sinceKeyframe = 0;
+	std::vector<std::uint8_t> storage;
+	size_t head = 0; // where the next snapshot goes
+	std::vector<std::uint8_t> previousState;
+
+public:
+	void push(const int tick, const std::vector<std::uint8_t>& state);
+	void reserveState(const size_t bytes); // states up to this size do not allocate, SNAPSHOT_RESERVED_STATE_BYTES by default
+	bool restore(const int tick, std::vector<std::uint8_t>& state);
+	bool latest(std::vector<std::uint8_t>& state);
+	void dropAfter(const int tick);
+	void clear();
+
+	// G&S
+	int getOldestTick() const;
+	int getNewestTick() const;
+	int getCount() const;
+	size_t getUsedBytes() const;
+
+private:
+	Entry& at(const int i);
+	void evictOldest();
+	bool reserveSpace(const size_t size);
+	static size_t encodeDelta(const std::uint8_t* previous, const size_t previousSize, const std::vector<std::uint8_t>& current, std::uint8_t* out);
+	static void applyDelta(const std::uint8_t* delta, const size_t deltaSize, const size_t rawSize, std::vector<std::uint8_t>& state);
+};
@@ -0,0 +1,503 @@
+#include "SoftwareRenderBackend.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTWARE_SSE2
+#include <emmintrin.h>
+#endif
+
+static std::uint32_t packColor(const sf::Color& color)
+{
+	return static_cast<std::uint32_t>(color.r) | (static_cast<std::uint32_t>(color.g) << 8) |
+		(static_cast<std::uint32_t>(color.b) << 16) | (static_cast<std::uint32_t>(color.a) << 24);
+}
+
+static inline std::uint32_t div255(const std::uint32_t x)
+{
+	// exact x / 255 rounded, for x in [0, 255 * 255]
+	std::uint32_t t = x + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+#ifdef SOFTWARE_SSE2
+static inline __m128i div255(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static inline __m128i blendHalf(__m128i source, const __m128i destination, const __m128i color)
+{
+	/*
+	Blends two pixels unpacked to 16 bit lanes: color = src * a + dst * (1 - a), alpha = a + dst_a * (1 - a)
+	*/
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+	source = div255(_mm_mullo_epi16(source, color));
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i inverseAlpha = _mm_sub_epi16(max, alpha);
+
+	__m128i rgb = div255(_mm_add_epi16(_mm_mullo_epi16(source, alpha), _mm_mullo_epi16(destination, inverseAlpha)));
+	__m128i a = _mm_add_epi16(source, div255(_mm_mullo_epi16(destination, inverseAlpha)));
+	return _mm_or_si128(_mm_andnot_si128(alphaMask, rgb), _mm_and_si128(alphaMask, a));
+}
+#endif
+
+static void blendSpan(std::uint32_t* destination, const std::uint32_t* source, const int count, const std::uint32_t color)
+{
+	/*
+	Function blends a span of texels (0 = outside the sprite) multiplied by color onto the framebuffer,
+	four pixels at a time with SSE2, the rest one by one with the same arithmetic
+	*/
+	int i = 0;
+#ifdef SOFTWARE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i colorLanes = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(src, zero)) == 0xffff) // nothing to draw here
+			continue;
+		__m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+
+		__m128i low = blendHalf(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), colorLanes);
+		__m128i high = blendHalf(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), colorLanes);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		std::uint32_t src = source[i];
+		if (src == 0)
+			continue;
+		std::uint32_t dst = destination[i];
+
+		std::uint32_t channels[4];
+		for (int c{ 0 }; c < 4; c++)
+			channels[c] = div255(((src >> (8 * c)) & 0xff) * ((color >> (8 * c)) & 0xff));
+
+		std::uint32_t alpha = channels[3];
+		std::uint32_t result = 0;
+		for (int c{ 0 }; c < 3; c++)
+			result |= div255(channels[c] * alpha + ((dst >> (8 * c)) & 0xff) * (255 - alpha)) << (8 * c);
+		result |= (alpha + div255((dst >> 24) * (255 - alpha))) << 24;
+		destination[i] = result;
+	}
+}
+
+static bool clipSpan(const float start, const float step, const float limit, float& first, float& last)
+{
+	/*
+	Function narrows [first, last] to the pixels i where 0 <= start + step * i < limit
+	*/
+	if (step == 0.f)
+		return start >= 0.f && start < limit;
+
+	float enter = (0.f - start) / step;
+	float leave = (limit - start) / step;
+	if (enter > leave)
+		std::swap(enter, leave);
+	first = std::max(first, enter);
+	last = std::min(last, leave);
+	return first <= last;
+}
+
+SoftwareRenderBackend::SoftwareRenderBackend(const unsigned _width, const unsigned _height, const int _numOfThreads)
+	:
+	width{ _width }, height{ _height }
+{
+	framebuffer.resize(static_cast<size_t>(width) * height, clearColor);
+	commands.reserve(SOFTWARE_RESERVED_COMMANDS);
+	whitePixel.size = sf::Vector2u(1, 1);
+	whitePixel.pixels.assign(1, 0xffffffff);
+	numOfTilesX = (width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	numOfTilesY = (height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+
+	int numOfThreads = _numOfThreads > 0 ? _numOfThreads : static_cast<int>(std::thread::hardware_concurrency());
+	numOfThreads = std::max(1, std::min(numOfThreads, SOFTWARE_MAX_THREADS));
+	for (int i{ 1 }; i < numOfThreads; i++) // the calling thread renders tiles too
+		workers.emplace_back(&SoftwareRenderBackend::workerLoop, this);
+}
+
+SoftwareRenderBackend::~SoftwareRenderBackend()
+{
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		stopWorkers = true;
+	}
+	workCondition.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void SoftwareRenderBackend::clear(const sf::Color& color)
+{
+	clearColor = packColor(color);
+	clearPending = true; // every tile clears itself before drawing
+	commands.clear();
+}
+
+void SoftwareRenderBackend::drawSprite(const sf::Sprite& sprite)
+{
+	if (!sprite.getTexture())
+		return;
+	addQuad(getCpuTexture(*sprite.getTexture(), false), sprite.getTextureRect(), sprite.getTransform(), sprite.getColor());
+}
+
+void SoftwareRenderBackend::drawText(const sf::Text& text)
+{
+	/*
+	Function lays the string out like sf::Text does (baseline at the character size,
+	kerning, line spacing) and adds one quad per glyph
+	*/
+	const sf::Font* font = text.getFont();
+	const sf::String& string = text.getString();
+	if (!font || string.isEmpty())
+		return;
+
+	const unsigned size = text.getCharacterSize();
+	const bool bold = (text.getStyle() & sf::Text::Bold) != 0;
+
+	// glyphs seen for the first time were just rasterized into the font texture, so its copy is stale
+	bool refresh = false;
+	for (std::size_t i{ 0 }; i < string.getSize(); i++)
+	{
+		font->getGlyph(string[i], size, bold);
+		std::uint64_t key = (static_cast<std::uint64_t>(size) << 33) | (static_cast<std::uint64_t>(bold) << 32) | string[i];
+		if (knownGlyphs.find(key) == knownGlyphs.end()) // looked up first, inserting a known glyph may still allocate a node
+		{
+			knownGlyphs.insert(key);
+			refresh = true;
+		}
+	}
+	const CpuTexture* texture = getCpuTexture(font->getTexture(size), refresh);
+
+	float x = 0.f;
+	float y = static_cast<float>(size);
+	sf::Uint32 previous = 0;
+	for (std::size_t i{ 0 }; i < string.getSize(); i++)
+	{
+		sf::Uint32 current = string[i];
+		x += font->getKerning(previous, current, size);
+		previous = current;
+
+		if (current == '\n')
+		{
+			x = 0.f;
+			y += font->getLineSpacing(size);
+			continue;
+		}
+
+		const sf::Glyph& glyph = font->getGlyph(current, size, bold);
+		if (glyph.textureRect.width > 0 && glyph.textureRect.height > 0)
+		{
+			// glyph textures have one pixel of padding around them
+			sf::Transform transform = text.getTransform();
+			transform.translate(x + glyph.bounds.left - 1.f, y + glyph.bounds.top - 1.f);
+			sf::IntRect textureRect(glyph.textureRect.left - 1, glyph.textureRect.top - 1, glyph.textureRect.width + 2, glyph.textureRect.height + 2);
+			addQuad(texture, textureRect, transform, text.getFillColor());
+		}
+		x += glyph.advance;
+	}
+}
+
+void SoftwareRenderBackend::drawVertices(const sf::Vertex* vertices, const std::size_t count, const sf::PrimitiveType type)
+{
+	/*
+	Function draws every primitive type, every primitive takes the color of its first vertex.
+	sf::Quads have to be axis aligned (particles), points are one pixel and lines one pixel wide
+	*/
+	switch (type)
+	{
+	case sf::Points:
+		for (std::size_t i{ 0 }; i < count; i++)
+			addUntextured(vertices[i].position - sf::Vector2f(0.5f, 0.5f), sf::Vector2f(1.f, 0.f), sf::Vector2f(0.f, 1.f), vertices[i].color, false);
+		break;
+	case sf::Lines:
+	case sf::LineStrip:
+		for (std::size_t i{ 0 }; i + 1 < count; i += (type == sf::Lines ? 2 : 1))
+		{
+			const sf::Vector2f along = vertices[i + 1].position - vertices[i].position;
+			const float length = std::sqrt(along.x * along.x + along.y * along.y);
+			if (length <= 0.f)
+				continue;
+			const sf::Vector2f across(-along.y / length, along.x / length);
+			addUntextured(vertices[i].position - 0.5f * across, along, across, vertices[i].color, false);
+		}
+		break;
+	case sf::Triangles:
+	case sf::TriangleStrip:
+	case sf::TriangleFan:
+		for (std::size_t i{ 0 }; i + 2 < count; i += (type == sf::Triangles ? 3 : 1))
+		{
+			const sf::Vertex& first = vertices[type == sf::TriangleFan ? 0 : i];
+			addUntextured(first.position, vertices[i + 1].position - first.position, vertices[i + 2].position - first.position, first.color, true);
+		}
+		break;
+	case sf::Quads:
+		for (std::size_t i{ 0 }; i + 3 < count; i += 4)
+		{
+			const sf::Vector2f& topLeft = vertices[i].position;
+			const sf::Vector2f& bottomRight = vertices[i + 2].position;
+			sf::Transform transform;
+			transform.translate(topLeft.x, topLeft.y);
+			transform.scale(bottomRight.x - topLeft.x, bottomRight.y - topLeft.y);
+			addQuad(&whitePixel, sf::IntRect(0, 0, 1, 1), transform, vertices[i].color);
+		}
+		break;
+	}
+}
+
+void SoftwareRenderBackend::drawTexturedQuads(const sf::Vertex* vertices, const std::size_t count, const sf::Texture& texture)
+{
+	/*
+	Function supports axis aligned sf::Quads (batched text), every quad takes the color of its first vertex
+	*/
+	const CpuTexture* cpuTexture = getCpuTexture(texture, false);
+	for (std::size_t i{ 0 }; i + 3 < count; i += 4)
+	{
+		const sf::Vertex& topLeft = vertices[i];
+		const sf::Vertex& bottomRight = vertices[i + 2];
+		sf::IntRect textureRect(static_cast<int>(topLeft.texCoords.x), static_cast<int>(topLeft.texCoords.y),
+			static_cast<int>(bottomRight.texCoords.x - topLeft.texCoords.x), static_cast<int>(bottomRight.texCoords.y - topLeft.texCoords.y));
+		if (textureRect.width <= 0 || textureRect.height <= 0)
+			continue;
+		sf::Transform transform;
+		transform.translate(topLeft.position.x, topLeft.position.y);
+		transform.scale((bottomRight.position.x - topLeft.position.x) / textureRect.width, (bottomRight.position.y - topLeft.position.y) / textureRect.height);
+		addQuad(cpuTexture, textureRect, transform, topLeft.color);
+	}
+}
+
+void SoftwareRenderBackend::prepareTexture(const sf::Texture& texture)
+{
+	getCpuTexture(texture, false); // downloaded now instead of in the first frame that draws it
+}
+
+void SoftwareRenderBackend::reserveDrawCalls(const std::size_t count)
+{
+	commands.reserve(count); // every sprite, particle and glyph is a command
+}
+
+void SoftwareRenderBackend::display()
+{
+	/*
+	Function rasterizes every command recorded since clear(), on all worker threads
+	*/
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		nextTile = 0;
+		workersDone = 0;
+		frameId++;
+	}
+	workCondition.notify_all();
+
+	renderTiles();
+
+	std::unique_lock<std::mutex> lock(workMutex);
+	doneCondition.wait(lock, [this] { return workersDone == static_cast<int>(workers.size()); });
+	commands.clear();
+	clearPending = false;
+}
+
+sf::Vector2u SoftwareRenderBackend::getSize() const
+{
+	return sf::Vector2u(width, height);
+}
+
+const sf::Uint8* SoftwareRenderBackend::getPixels() const
+{
+	return reinterpret_cast<const sf::Uint8*>(framebuffer.data());
+}
+
+bool SoftwareRenderBackend::saveToFile(const std::string& fileName) const
+{
+	sf::Image image;
+	image.create(width, height, getPixels());
+	return image.saveToFile(fileName);
+}
+
+const SoftwareRenderBackend::CpuTexture* SoftwareRenderBackend::getCpuTexture(const sf::Texture& texture, const bool refresh)
+{
+	/*
+	Function returns the CPU copy of a texture, it is downloaded once (or again when refresh is set)
+	*/
+	CpuTexture* cpuTexture = nullptr;
+	for (auto& candidate : textures)
+	{
+		if (candidate->texture == &texture && candidate->nativeHandle == texture.getNativeHandle())
+		{
+			cpuTexture = candidate.get();
+			break;
+		}
+	}
+
+	if (cpuTexture && !refresh && cpuTexture->size == texture.getSize())
+		return cpuTexture;
+
+	if (!cpuTexture)
+	{
+		textures.push_back(std::make_unique<CpuTexture>());
+		cpuTexture = textures.back().get();
+		cpuTexture->texture = &texture;
+		cpuTexture->nativeHandle = texture.getNativeHandle();
+	}
+
+	sf::Image image = texture.copyToImage();
+	cpuTexture->size = image.getSize();
+	cpuTexture->pixels.resize(static_cast<size_t>(cpuTexture->size.x) * cpuTexture->size.y);
+	std::copy_n(reinterpret_cast<const std::uint32_t*>(image.getPixelsPtr()), cpuTexture->pixels.size(), cpuTexture->pixels.begin());
+	return cpuTexture;
+}
+
+void SoftwareRenderBackend::addQuad(const CpuTexture* texture, const sf::IntRect& textureRect, const sf::Transform& transform, const sf::Color& color, const bool triangle)
+{
+	/*
+	Function records a textured quad of textureRect's size placed by transform
+	*/
+	if (textureRect.width <= 0 || textureRect.height <= 0 || color.a == 0)
+		return;
+
+	const float* matrix = transform.getMatrix();
+	float a = matrix[0], b = matrix[4], c = matrix[12];
+	float d = matrix[1], e = matrix[5], f = matrix[13];
+	float determinant = a * e - b * d;
+	if (std::abs(determinant) < 1e-8f)
+		return;
+
+	DrawCommand command;
+	command.texture = texture;
+	command.texLeft = textureRect.left;
+	command.texTop = textureRect.top;
+	command.texWidth = textureRect.width;
+	command.texHeight = textureRect.height;
+	command.inverse[0] = e / determinant;
+	command.inverse[1] = -b / determinant;
+	command.inverse[2] = (b * f - e * c) / determinant;
+	command.inverse[3] = -d / determinant;
+	command.inverse[4] = a / determinant;
+	command.inverse[5] = (d * c - a * f) / determinant;
+	command.color = packColor(color);
+	command.triangle = triangle;
+
+	// screen bounds of the transformed quad
+	float w = static_cast<float>(textureRect.width), h = static_cast<float>(textureRect.height);
+	float cornersX[4] = { c, a * w + c, b * h + c, a * w + b * h + c };
+	float cornersY[4] = { f, d * w + f, e * h + f, d * w + e * h + f };
+	command.minX = std::max(0, static_cast<int>(std::floor(*std::min_element(cornersX, cornersX + 4))));
+	command.minY = std::max(0, static_cast<int>(std::floor(*std::min_element(cornersY, cornersY + 4))));
+	command.maxX = std::min(static_cast<int>(width), static_cast<int>(std::ceil(*std::max_element(cornersX, cornersX + 4))));
+	command.maxY = std::min(static_cast<int>(height), static_cast<int>(std::ceil(*std::max_element(cornersY, cornersY + 4))));
+	if (command.minX >= command.maxX || command.minY >= command.maxY) // off screen
+		return;
+
+	commands.push_back(command);
+}
+
+void SoftwareRenderBackend::addUntextured(const sf::Vector2f& origin, const sf::Vector2f& edgeU, const sf::Vector2f& edgeV, const sf::Color& color, const bool triangle)
+{
+	/*
+	Function records the parallelogram origin + u * edgeU + v * edgeV (u, v in 0 - 1), or its half with u + v < 1
+	*/
+	sf::Transform transform(edgeU.x, edgeV.x, origin.x,
+		edgeU.y, edgeV.y, origin.y,
+		0.f, 0.f, 1.f);
+	addQuad(&whitePixel, sf::IntRect(0, 0, 1, 1), transform, color, triangle);
+}
+
+void SoftwareRenderBackend::workerLoop()
+{
+	int lastFrame = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(workMutex);
+			workCondition.wait(lock, [&] { return stopWorkers || frameId != lastFrame; });
+			if (stopWorkers)
+				return;
+			lastFrame = frameId;
+		}
+
+		renderTiles();
+
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			workersDone++;
+		}
+		doneCondition.notify_one();
+	}
+}
+
+void SoftwareRenderBackend::renderTiles()
+{
+	const int numOfTiles = numOfTilesX * numOfTilesY;
+	int tile;
+	while ((tile = nextTile.fetch_add(1)) < numOfTiles)
+		renderTile(tile);
+}
+
+void SoftwareRenderBackend::renderTile(const int tile)
+{
+	const int x0 = (tile % numOfTilesX) * SOFTWARE_TILE_SIZE;
+	const int y0 = (tile / numOfTilesX) * SOFTWARE_TILE_SIZE;
+	const int x1 = std::min(x0 + SOFTWARE_TILE_SIZE, static_cast<int>(width));
+	const int y1 = std::min(y0 + SOFTWARE_TILE_SIZE, static_cast<int>(height));
+
+	if (clearPending)
+	{
+		for (int y{ y0 }; y < y1; y++)
+			std::fill(framebuffer.begin() + y * width + x0, framebuffer.begin() + y * width + x1, clearColor);
+	}
+
+	for (const auto& command : commands)
+		rasterize(command, x0, y0, x1, y1);
+}
+
+void SoftwareRenderBackend::rasterize(const DrawCommand& command, const int x0, const int y0, const int x1, const int y1)
+{
+	/*
+	Function draws the part of a command inside the rectangle (x0,y0)-(x1,y1), the texel of every
+	pixel center is found through the inverse transform, row by row
+	*/
+	const int left = std::max(x0, command.minX), right = std::min(x1, command.maxX);
+	const int top = std::max(y0, command.minY), bottom = std::min(y1, command.maxY);
+	if (left >= right || top >= bottom)
+		return;
+
+	const CpuTexture& texture = *command.texture;
+	const float* inverse = command.inverse;
+	std::uint32_t span[SOFTWARE_TILE_SIZE];
+
+	for (int y{ top }; y < bottom; y++)
+	{
+		float u = inverse[0] * (left + 0.5f) + inverse[1] * (y + 0.5f) + inverse[2];
+		float v = inverse[3] * (left + 0.5f) + inverse[4] * (y + 0.5f) + inverse[5];
+
+		// u and v are linear along the row, so the covered part of the row is known up front
+		float first = 0.f, last = static_cast<float>(right - left);
+		if (!clipSpan(u, inverse[0], static_cast<float>(command.texWidth), first, last) ||
+			!clipSpan(v, inverse[3], static_cast<float>(command.texHeight), first, last))
+			continue;
+		const int begin = std::max(0, static_cast<int>(first) - 1);
+		const int end = std::min(right - left, static_cast<int>(last) + 2);
+		if (begin >= end)
+			continue;
+
+		u += inverse[0] * begin;
+		v += inverse[3] * begin;
+		for (int i{ begin }; i < end; i++, u += inverse[0], v += inverse[3])
+		{
+			span[i] = 0;
+			if (u < 0.f || v < 0.f || u >= command.texWidth || v >= command.texHeight || (command.triangle && u + v > 1.f))
+				continue;
+			int texelX = command.texLeft + static_cast<int>(u);
+			int texelY = command.texTop + static_cast<int>(v);
+			if (texelX >= 0 && texelY >= 0 && texelX < static_cast<int>(texture.size.x) && texelY < static_cast<int>(texture.size.y))
+				span[i] = texture.pixels[static_cast<size_t>(texelY) * texture.size.x + texelX];
+		}
+
+		blendSpan(&framebuffer[static_cast<size_t>(y) * width + left + begin], span + begin, end - begin, command.color);
+	}
+}
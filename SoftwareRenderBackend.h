@@ -0,0 +1,92 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define SOFTWARE_TILE_SIZE 64
+#define SOFTWARE_MAX_THREADS 8
+#define SOFTWARE_RESERVED_COMMANDS 1024 // draw calls of a frame with every pooled asteroid on screen and the HUD
+
+class SoftwareRenderBackend : public RenderBackend
+{
+	/*
+	CPU rasterizer into an in-memory RGBA framebuffer. Draw calls are recorded during the frame
+	and rasterized in display(): the screen is cut into tiles, worker threads take tiles one by one
+	and draw every command that touches their tile in order, so the result does not depend
+	on the number of threads. Sprites and glyphs may be scaled, rotated and alpha blended,
+	texels are sampled nearest neighbour from CPU copies of the textures
+	*/
+public:
+	SoftwareRenderBackend(const unsigned _width, const unsigned _height, const int _numOfThreads = 0);
+	~SoftwareRenderBackend();
+private:
+
+	struct CpuTexture
+	{
+		const sf::Texture* texture = nullptr;
+		unsigned nativeHandle = 0;
+		sf::Vector2u size;
+		std::vector<std::uint32_t> pixels;
+	};
+
+	struct DrawCommand
+	{
+		const CpuTexture* texture;
+		int texLeft, texTop, texWidth, texHeight;
+		float inverse[6];		// screen -> texture rect coordinates
+		std::uint32_t color;	// texels are multiplied by it
+		bool triangle;			// only the half of the rect with u + v < 1, for untextured triangles
+		int minX, minY, maxX, maxY;
+	};
+
+	unsigned width, height;
+	std::vector<std::uint32_t> framebuffer;
+	std::uint32_t clearColor = 0xff000000;
+	bool clearPending = false;
+	std::vector<DrawCommand> commands;
+	std::vector<std::unique_ptr<CpuTexture>> textures;
+	CpuTexture whitePixel; // untextured quads are drawn with it
+	std::unordered_set<std::uint64_t> knownGlyphs;
+
+	// Tile Workers
+	int numOfTilesX, numOfTilesY;
+	std::vector<std::thread> workers;
+	std::mutex workMutex;
+	std::condition_variable workCondition;
+	std::condition_variable doneCondition;
+	int frameId = 0;
+	int workersDone = 0;
+	bool stopWorkers = false;
+	std::atomic<int> nextTile{ 0 };
+
+public:
+	void clear(const sf::Color& color = sf::Color::Black) override;
+	void drawSprite(const sf::Sprite& sprite) override;
+	void drawText(const sf::Text& text) override;
+	void drawVertices(const sf::Vertex* vertices, const std::size_t count, const sf::PrimitiveType type) override;
+	void drawTexturedQuads(const sf::Vertex* vertices, const std::size_t count, const sf::Texture& texture) override;
+	void prepareTexture(const sf::Texture& texture) override;
+	void reserveDrawCalls(const std::size_t count) override;
+	void display() override;
+
+	sf::Vector2u getSize() const override;
+	const sf::Uint8* getPixels() const override;
+	bool saveToFile(const std::string& fileName) const;
+
+private:
+	const CpuTexture* getCpuTexture(const sf::Texture& texture, const bool refresh);
+	void addQuad(const CpuTexture* texture, const sf::IntRect& textureRect, const sf::Transform& transform, const sf::Color& color, const bool triangle = false);
+	void addUntextured(const sf::Vector2f& origin, const sf::Vector2f& edgeU, const sf::Vector2f& edgeV, const sf::Color& color, const bool triangle);
+	void workerLoop();
+	void renderTiles();
+	void renderTile(const int tile);
+	void rasterize(const DrawCommand& command, const int x0, const int y0, const int x1, const int y1);
+};
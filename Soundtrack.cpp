@@ -0,0 +1,95 @@
+#include "Soundtrack.h"
+#include "MemoryTracker.h"
+#include <fstream>
+#include <algorithm>
+
+StreamedTrack::~StreamedTrack()
+{
+	stop(); // the streaming thread must not call onGetData of a destroyed track
+}
+
+bool StreamedTrack::open(const std::string& fileName)
+{
+	if (!file.openFromFile(fileName) || file.getChannelCount() == 0)
+		return false;
+	samples.resize(static_cast<std::size_t>(SOUNDTRACK_CHUNK_FRAMES) * file.getChannelCount());
+	initialize(file.getChannelCount(), file.getSampleRate());
+	return true;
+}
+
+std::size_t StreamedTrack::getBufferBytes() const
+{
+	return samples.size() * sizeof(sf::Int16);
+}
+
+bool StreamedTrack::onGetData(Chunk& data)
+{
+	/*
+	Function decodes the next chunk, runs on the streaming thread
+	*/
+	std::size_t count = static_cast<std::size_t>(file.read(samples.data(), samples.size()));
+	while (count < samples.size())
+	{
+		file.seek(static_cast<sf::Uint64>(0)); // wrap within the chunk, the loop has no gap
+		const std::size_t read = static_cast<std::size_t>(file.read(samples.data() + count, samples.size() - count));
+		if (read == 0)
+			break;
+		count += read;
+	}
+	data.samples = samples.data();
+	data.sampleCount = count;
+	return count > 0;
+}
+
+void StreamedTrack::onSeek(sf::Time timeOffset)
+{
+	file.seek(timeOffset);
+}
+
+Soundtrack::~Soundtrack()
+{
+	for (StreamedTrack& track : tracks)
+		track.stop();
+	MemoryTracker::release(MEMORY_AUDIO, bufferBytes);
+}
+
+void Soundtrack::load()
+{
+	/*
+	Function opens the music files, the game goes on silently without the ones that are missing
+	*/
+	const char* fileNames[NUMBER_OF_TRACKS] = { SOUNDTRACK_MENU_FILE, SOUNDTRACK_GAME_FILE };
+	for (int i{ 0 }; i < NUMBER_OF_TRACKS; i++)
+	{
+		loaded[i] = std::ifstream(fileNames[i]).good() && tracks[i].open(fileNames[i]); // SFML would print an error for a missing file
+		if (!loaded[i])
+			continue;
+		tracks[i].setVolume(0.f);
+		bufferBytes += tracks[i].getBufferBytes();
+	}
+	MemoryTracker::account(MEMORY_AUDIO, bufferBytes);
+}
+
+void Soundtrack::update(const soundtrackTrack wanted, const float dt)
+{
+	/*
+	Function moves every track's volume towards its target by dt (ms) of the crossfade,
+	decoding stays on the streaming threads
+	*/
+	const float step = dt / SOUNDTRACK_CROSSFADE_MS;
+	for (int i{ 0 }; i < NUMBER_OF_TRACKS; i++)
+	{
+		if (!loaded[i])
+			continue;
+		const float target = i == wanted ? 1.f : 0.f;
+		if (volumes[i] == target)
+			continue;
+		volumes[i] = target > volumes[i] ? std::min(volumes[i] + step, target) : std::max(volumes[i] - step, target);
+		tracks[i].setVolume(volumes[i] * SOUNDTRACK_VOLUME);
+
+		if (volumes[i] > 0.f && tracks[i].getStatus() != sf::SoundSource::Playing)
+			tracks[i].play(); // a paused track resumes where it faded out
+		else if (volumes[i] == 0.f)
+			tracks[i].pause();
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <string>
+#include <vector>
+
+#define SOUNDTRACK_MENU_FILE "assets//menuMusic.ogg"
+#define SOUNDTRACK_GAME_FILE "assets//gameMusic.ogg"
+#define SOUNDTRACK_CHUNK_FRAMES 4096		// per streaming buffer, SFML keeps three queued (about 0.3 s at 44.1 kHz)
+#define SOUNDTRACK_CROSSFADE_MS 1500.f
+#define SOUNDTRACK_VOLUME 60.f
+
+enum soundtrackTrack
+{
+	TRACK_MENU,		// menu and score list
+	TRACK_GAME,
+	NUMBER_OF_TRACKS
+};
+
+class StreamedTrack : public sf::SoundStream
+{
+	/*
+	Music file decoded a chunk at a time on SFML's streaming thread. The end of the file
+	wraps to its start inside the chunk being filled, so the loop has no gap
+	*/
+private:
+	sf::InputSoundFile file;
+	std::vector<sf::Int16> samples; // one chunk
+public:
+	~StreamedTrack();
+	bool open(const std::string& fileName);
+	std::size_t getBufferBytes() const;
+protected:
+	bool onGetData(Chunk& data) override;
+	void onSeek(sf::Time timeOffset) override;
+};
+
+class Soundtrack
+{
+	/*
+	Background music of the menu and of the game, streamed from disk. update() is called once
+	a frame with the track the current state wants, it only changes volumes: the wanted track
+	fades in while the other fades out and is paused where it was. A track whose file is missing
+	stays silent
+	*/
+private:
+	StreamedTrack tracks[NUMBER_OF_TRACKS];
+	bool loaded[NUMBER_OF_TRACKS] = {};
+	float volumes[NUMBER_OF_TRACKS] = {}; // 0 to 1 of SOUNDTRACK_VOLUME
+	std::size_t bufferBytes = 0;
+public:
+	~Soundtrack();
+	void load();
+	void update(const soundtrackTrack wanted, const float dt);
+};
@@ -0,0 +1,278 @@
+#include "Telemetry.h"
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+
+// Ring
+
+bool TelemetryRing::push(const TelemetryRecord& record)
+{
+	std::uint32_t currentHead = head.load(std::memory_order_relaxed);
+	if (currentHead - tail.load(std::memory_order_acquire) == TELEMETRY_RING_SIZE) // writer fell behind
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	records[currentHead & (TELEMETRY_RING_SIZE - 1)] = record;
+	head.store(currentHead + 1, std::memory_order_release);
+	return true;
+}
+
+int TelemetryRing::drain(TelemetryRecord* out, const int maxRecords)
+{
+	std::uint32_t currentTail = tail.load(std::memory_order_relaxed);
+	std::uint32_t available = head.load(std::memory_order_acquire) - currentTail;
+	int count = static_cast<int>(std::min<std::uint32_t>(available, maxRecords));
+	for (int i{ 0 }; i < count; i++)
+		out[i] = records[(currentTail + i) & (TELEMETRY_RING_SIZE - 1)];
+	tail.store(currentTail + count, std::memory_order_release);
+	return count;
+}
+
+// Writer
+
+namespace
+{
+	std::atomic<bool> enabled{ false };
+	std::atomic<std::uint32_t> currentTick{ 0 };
+	std::atomic<TelemetryRing*> rings{ nullptr };
+	std::atomic<std::uint16_t> nextThread{ 0 };
+	thread_local TelemetryRing* localRing = nullptr;
+	std::chrono::steady_clock::time_point startTime;
+
+	std::thread writer;
+	std::atomic<bool> stopWriter{ false };
+	std::string basePath;
+	std::ofstream file;
+	size_t fileBytes = 0;
+	TelemetryRecord writeBuffer[TELEMETRY_RING_SIZE];
+
+	struct RingOwner
+	{
+		// Rings live as long as the process, a thread may still hold its ring after stop()
+		~RingOwner()
+		{
+			TelemetryRing* ring = rings.load();
+			while (ring)
+			{
+				TelemetryRing* next = ring->next;
+				delete ring;
+				ring = next;
+			}
+		}
+	} ringOwner;
+
+	void openFile()
+	{
+		file.open(basePath, std::ios::binary | std::ios::trunc);
+		TelemetryFileHeader header{ TELEMETRY_MAGIC, TELEMETRY_VERSION, sizeof(TelemetryRecord) };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		fileBytes = sizeof(header);
+	}
+
+	void rotateFile()
+	{
+		/*
+		Function shifts telemetry.bin -> telemetry.bin.1 -> ... and starts a new file,
+		only the last TELEMETRY_MAX_FILES files are kept
+		*/
+		file.close();
+		std::error_code error;
+		for (int i{ TELEMETRY_MAX_FILES - 1 }; i > 0; i--)
+		{
+			std::string from = (i == 1) ? basePath : basePath + "." + std::to_string(i - 1);
+			std::filesystem::rename(from, basePath + "." + std::to_string(i), error);
+		}
+		openFile();
+	}
+
+	void flush()
+	{
+		for (TelemetryRing* ring = rings.load(std::memory_order_acquire); ring; ring = ring->next)
+		{
+			int count;
+			while ((count = ring->drain(writeBuffer, TELEMETRY_RING_SIZE)) > 0)
+			{
+				file.write(reinterpret_cast<const char*>(writeBuffer), count * sizeof(TelemetryRecord));
+				fileBytes += count * sizeof(TelemetryRecord);
+				if (fileBytes >= TELEMETRY_MAX_FILE_BYTES)
+					rotateFile();
+			}
+		}
+		file.flush();
+	}
+
+	void writerLoop()
+	{
+		while (!stopWriter.load())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_FLUSH_MS));
+			flush();
+		}
+		flush();
+	}
+}
+
+void Telemetry::start(const std::string& path)
+{
+	if (enabled.load())
+		return;
+
+	basePath = path;
+	openFile();
+	if (!file)
+	{
+		std::cerr << "Error opening " << path << "\n";
+		return;
+	}
+
+	startTime = std::chrono::steady_clock::now();
+	stopWriter = false;
+	writer = std::thread(writerLoop);
+	enabled = true;
+}
+
+void Telemetry::stop()
+{
+	if (!enabled.exchange(false))
+		return;
+
+	stopWriter = true;
+	writer.join();
+	file.close();
+
+	std::uint32_t dropped = 0;
+	for (TelemetryRing* ring = rings.load(); ring; ring = ring->next)
+		dropped += ring->dropped.load();
+	if (dropped > 0)
+		std::cerr << "Telemetry: " << dropped << " records dropped\n";
+}
+
+bool Telemetry::isEnabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void Telemetry::registerThread()
+{
+	if (localRing)
+		return;
+
+	localRing = new TelemetryRing(nextThread.fetch_add(1));
+	TelemetryRing* head = rings.load();
+	do
+	{
+		localRing->next = head;
+	} while (!rings.compare_exchange_weak(head, localRing));
+}
+
+void Telemetry::setTick(const std::uint32_t tick)
+{
+	currentTick.store(tick, std::memory_order_relaxed);
+}
+
+void Telemetry::record(const telemetryEvent type, const float x, const float y, const float value)
+{
+	/*
+	Function copies one record into the ring of the calling thread,
+	it never blocks, if the ring is full the record is dropped and counted
+	*/
+	if (!enabled.load(std::memory_order_relaxed))
+		return;
+	if (!localRing)
+		registerThread();
+
+	TelemetryRecord record;
+	record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	record.tick = currentTick.load(std::memory_order_relaxed);
+	record.type = static_cast<std::uint16_t>(type);
+	record.thread = localRing->thread;
+	record.x = x;
+	record.y = y;
+	record.value = value;
+	record.reserved = 0;
+	localRing->push(record);
+}
+
+// Report
+
+int Telemetry::printReport(int argc, char* argv[])
+{
+	/*
+	Function reads the given telemetry files (oldest first) and prints
+	event counts, hit rates and a frame time histogram
+	*/
+	const char* eventNames[NUMBER_OF_TELEMETRY_EVENTS] = { "shots", "hits", "damage", "spawns", "game overs", "frames" };
+	long long eventCounts[NUMBER_OF_TELEMETRY_EVENTS] = {};
+	long long hitsPerLevel[2] = {};
+	long long scoreSum = 0;
+	std::vector<float> frameTimes;
+
+	for (int i{ 0 }; i < argc; i++)
+	{
+		std::ifstream fileIn{ argv[i], std::ios::binary };
+		TelemetryFileHeader header{};
+		fileIn.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!fileIn || header.magic != TELEMETRY_MAGIC || header.recordSize != sizeof(TelemetryRecord))
+		{
+			std::cerr << "Error reading " << argv[i] << "\n";
+			continue;
+		}
+
+		TelemetryRecord record;
+		while (fileIn.read(reinterpret_cast<char*>(&record), sizeof(record)))
+		{
+			if (record.type >= NUMBER_OF_TELEMETRY_EVENTS)
+				continue;
+			eventCounts[record.type]++;
+
+			if (record.type == TELEMETRY_HIT && record.value >= 0 && record.value <= 1)
+				hitsPerLevel[static_cast<int>(record.value)]++;
+			else if (record.type == TELEMETRY_GAME_OVER)
+				scoreSum += static_cast<long long>(record.value);
+			else if (record.type == TELEMETRY_FRAME)
+				frameTimes.push_back(record.value);
+		}
+	}
+
+	std::cout << "Events:\n";
+	for (int i{ 0 }; i < NUMBER_OF_TELEMETRY_EVENTS; i++)
+		std::cout << "  " << std::setw(12) << std::left << eventNames[i] << eventCounts[i] << "\n";
+
+	long long shots = eventCounts[TELEMETRY_SHOT];
+	long long hits = eventCounts[TELEMETRY_HIT];
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Hit rate: " << (shots > 0 ? 100.0 * hits / shots : 0.0) << "% ("
+		<< hitsPerLevel[1] << " large, " << hitsPerLevel[0] << " small)\n";
+	if (eventCounts[TELEMETRY_GAME_OVER] > 0)
+		std::cout << "Average score: " << static_cast<double>(scoreSum) / eventCounts[TELEMETRY_GAME_OVER] << "\n";
+
+	if (frameTimes.empty())
+		return 0;
+
+	// Frame time histogram, 2 ms buckets, the last one collects everything slower
+	const int numOfBuckets = 17;
+	long long buckets[numOfBuckets] = {};
+	for (float frameTime : frameTimes)
+		buckets[std::min(numOfBuckets - 1, static_cast<int>(frameTime / 2))]++;
+
+	long long largestBucket = *std::max_element(buckets, buckets + numOfBuckets);
+	std::cout << "Frame times (" << frameTimes.size() << " frames):\n";
+	for (int i{ 0 }; i < numOfBuckets; i++)
+	{
+		std::string label = (i == numOfBuckets - 1) ? std::to_string(2 * i) + "+ ms" : std::to_string(2 * i) + "-" + std::to_string(2 * i + 2) + " ms";
+		std::cout << "  " << std::setw(10) << std::right << label << " " << std::setw(8) << buckets[i] << " "
+			<< std::string(static_cast<size_t>(50 * buckets[i] / largestBucket), '#') << "\n";
+	}
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	auto percentile = [&](double p) { return frameTimes[static_cast<size_t>(p * (frameTimes.size() - 1))]; };
+	std::cout << "  p50 " << percentile(0.5) << " ms, p95 " << percentile(0.95) << " ms, p99 " << percentile(0.99)
+		<< " ms, max " << frameTimes.back() << " ms\n";
+	return 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define TELEMETRY_RING_SIZE 4096 // records per thread, power of two
+#define TELEMETRY_FLUSH_MS 20
+#define TELEMETRY_MAX_FILE_BYTES (8 * 1024 * 1024)
+#define TELEMETRY_MAX_FILES 4
+#define TELEMETRY_MAGIC 0x4c545341 // "ASTL"
+#define TELEMETRY_VERSION 1
+
+// Telemetry Event
+enum telemetryEvent
+{
+	TELEMETRY_SHOT,			// x,y = bullet start position
+	TELEMETRY_HIT,			// x,y = asteroid position, value = asteroid level before the hit
+	TELEMETRY_DAMAGE,		// x,y = player position, value = health left
+	TELEMETRY_SPAWN,		// x,y = asteroid position, value = asteroid level
+	TELEMETRY_GAME_OVER,	// value = score
+	TELEMETRY_FRAME,		// value = frame time in ms
+	NUMBER_OF_TELEMETRY_EVENTS
+};
+
+// Fixed size record, written to the log file as is
+struct TelemetryRecord
+{
+	std::uint64_t timestamp;	// microseconds since Telemetry::start
+	std::uint32_t tick;
+	std::uint16_t type;
+	std::uint16_t thread;
+	float x, y;
+	float value;
+	std::uint32_t reserved;
+};
+static_assert(sizeof(TelemetryRecord) == 32, "telemetry records have a fixed size");
+
+struct TelemetryFileHeader
+{
+	std::uint32_t magic;
+	std::uint16_t version;
+	std::uint16_t recordSize;
+};
+
+class TelemetryRing
+{
+	/*
+	Single producer (the owning thread), single consumer (the writer thread) ring buffer
+	*/
+public:
+	TelemetryRing(const std::uint16_t _thread) : thread{ _thread } {}
+private:
+	TelemetryRecord records[TELEMETRY_RING_SIZE];
+	alignas(64) std::atomic<std::uint32_t> head{ 0 }; // written by the producer
+	alignas(64) std::atomic<std::uint32_t> tail{ 0 }; // written by the consumer
+public:
+	const std::uint16_t thread;
+	std::atomic<std::uint32_t> dropped{ 0 };
+	TelemetryRing* next = nullptr; // list of all rings, only ever prepended
+
+	bool push(const TelemetryRecord& record);
+	int drain(TelemetryRecord* out, const int maxRecords);
+};
+
+namespace Telemetry
+{
+	void start(const std::string& path);
+	void stop();
+	bool isEnabled();
+
+	// Gives the calling thread its ring ahead of time, otherwise the first record() allocates it
+	void registerThread();
+
+	void setTick(const std::uint32_t tick);
+	void record(const telemetryEvent type, const float x = 0.f, const float y = 0.f, const float value = 0.f);
+
+	// Offline reader, prints hit rates and frame time histograms of the given log files
+	int printReport(int argc, char* argv[]);
+}
@@ -0,0 +1,174 @@
+#include "TextBatch.h"
+#include <algorithm>
+
+TextBatch::TextBatch()
+{
+	vertices.resize(static_cast<size_t>(TEXT_BATCH_MAX_GLYPHS) * 4);
+}
+
+bool TextBatch::prewarm(const sf::Font& _font, const unsigned* characterSizes, const int count)
+{
+	/*
+	Function rasterizes every printable character at every size, then stacks the font's page of each
+	size into one atlas image, a gutter apart, and moves the glyph rectangles along with it
+	*/
+	font = &_font;
+	numOfSizes = std::min(count, TEXT_BATCH_MAX_SIZES);
+	kerning.assign(static_cast<size_t>(numOfSizes) * TEXT_BATCH_CHARACTERS * TEXT_BATCH_CHARACTERS, 0.f);
+
+	sf::Image pages[TEXT_BATCH_MAX_SIZES];
+	unsigned atlasWidth = 0, atlasHeight = 0;
+	for (int i{ 0 }; i < numOfSizes; i++)
+	{
+		SizeTable& table = sizes[i];
+		table.characterSize = characterSizes[i];
+		table.lineSpacing = font->getLineSpacing(table.characterSize);
+		for (int c{ 0 }; c < TEXT_BATCH_CHARACTERS; c++)
+		{
+			const sf::Glyph& glyph = font->getGlyph(TEXT_BATCH_FIRST_CHARACTER + c, table.characterSize, false);
+			table.glyphs[c].bounds = glyph.bounds;
+			table.glyphs[c].textureRect = glyph.textureRect;
+			table.glyphs[c].advance = glyph.advance;
+		}
+		for (int previous{ 0 }; previous < TEXT_BATCH_CHARACTERS; previous++)
+			for (int current{ 0 }; current < TEXT_BATCH_CHARACTERS; current++)
+				kerning[(static_cast<size_t>(i) * TEXT_BATCH_CHARACTERS + previous) * TEXT_BATCH_CHARACTERS + current] =
+					font->getKerning(TEXT_BATCH_FIRST_CHARACTER + previous, TEXT_BATCH_FIRST_CHARACTER + current, table.characterSize);
+
+		// the page is complete now, every glyph of this size is in it
+		pages[i] = font->getTexture(table.characterSize).copyToImage();
+		atlasWidth = std::max(atlasWidth, pages[i].getSize().x);
+		atlasHeight += pages[i].getSize().y + (i > 0 ? TEXT_BATCH_ATLAS_GUTTER : 0);
+	}
+	if (atlasWidth == 0 || atlasHeight == 0 || atlasWidth > sf::Texture::getMaximumSize() || atlasHeight > sf::Texture::getMaximumSize())
+		return false;
+
+	sf::Image image;
+	image.create(atlasWidth, atlasHeight, sf::Color::Transparent);
+	unsigned top = 0;
+	for (int i{ 0 }; i < numOfSizes; i++)
+	{
+		image.copy(pages[i], 0, top);
+		for (auto& glyph : sizes[i].glyphs)
+			glyph.textureRect.top += static_cast<int>(top);
+		top += pages[i].getSize().y + TEXT_BATCH_ATLAS_GUTTER;
+	}
+	skipped = 0;
+	return atlas.loadFromImage(image);
+}
+
+void TextBatch::clear()
+{
+	numOfVertices = 0;
+}
+
+void TextBatch::add(const sf::Text& text)
+{
+	/*
+	Function lays the string out like sf::Text does (baseline at the character size, kerning,
+	line spacing, glyphs padded by one pixel) and appends a quad per visible glyph
+	*/
+	const sf::String& string = text.getString();
+	if (string.isEmpty())
+		return;
+	const SizeTable* table = findSize(text.getCharacterSize());
+	if (!table || text.getFont() != font || text.getStyle() != sf::Text::Regular)
+	{
+		skipped += static_cast<int>(string.getSize());
+		return;
+	}
+
+	const float* kerningTable = kerning.data() + (table - sizes) * TEXT_BATCH_CHARACTERS * TEXT_BATCH_CHARACTERS;
+	const float whitespace = table->glyphs[' ' - TEXT_BATCH_FIRST_CHARACTER].advance;
+	const sf::Transform& transform = text.getTransform();
+	const sf::Color color = text.getFillColor();
+
+	float x = 0.f;
+	float y = static_cast<float>(table->characterSize);
+	int previous = -1;
+	for (std::size_t i{ 0 }; i < string.getSize(); i++)
+	{
+		sf::Uint32 character = string[i];
+		if (character == '\n')
+		{
+			x = 0.f;
+			y += table->lineSpacing;
+			previous = -1;
+			continue;
+		}
+		if (character == '\t')
+		{
+			x += whitespace * 4;
+			previous = -1;
+			continue;
+		}
+		if (character < TEXT_BATCH_FIRST_CHARACTER || character > TEXT_BATCH_LAST_CHARACTER)
+		{
+			skipped++;
+			previous = -1;
+			continue;
+		}
+
+		const int current = static_cast<int>(character) - TEXT_BATCH_FIRST_CHARACTER;
+		if (previous >= 0)
+			x += kerningTable[previous * TEXT_BATCH_CHARACTERS + current];
+		previous = current;
+
+		const Glyph& glyph = table->glyphs[current];
+		if (glyph.textureRect.width > 0 && glyph.textureRect.height > 0)
+		{
+			if (numOfVertices + 4 > static_cast<int>(vertices.size()))
+			{
+				skipped++;
+				continue;
+			}
+
+			float left = x + glyph.bounds.left - 1.f;
+			float top = y + glyph.bounds.top - 1.f;
+			float right = x + glyph.bounds.left + glyph.bounds.width + 1.f;
+			float bottom = y + glyph.bounds.top + glyph.bounds.height + 1.f;
+			float u0 = static_cast<float>(glyph.textureRect.left - 1);
+			float v0 = static_cast<float>(glyph.textureRect.top - 1);
+			float u1 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width + 1);
+			float v1 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height + 1);
+
+			sf::Vertex* quad = &vertices[numOfVertices];
+			quad[0] = sf::Vertex(transform.transformPoint(left, top), color, sf::Vector2f(u0, v0));
+			quad[1] = sf::Vertex(transform.transformPoint(right, top), color, sf::Vector2f(u1, v0));
+			quad[2] = sf::Vertex(transform.transformPoint(right, bottom), color, sf::Vector2f(u1, v1));
+			quad[3] = sf::Vertex(transform.transformPoint(left, bottom), color, sf::Vector2f(u0, v1));
+			numOfVertices += 4;
+		}
+		x += glyph.advance;
+	}
+}
+
+void TextBatch::draw(RenderBackend& renderer) const
+{
+	if (numOfVertices > 0)
+		renderer.drawTexturedQuads(vertices.data(), numOfVertices, atlas);
+}
+
+const TextBatch::SizeTable* TextBatch::findSize(const unsigned characterSize) const
+{
+	for (int i{ 0 }; i < numOfSizes; i++)
+		if (sizes[i].characterSize == characterSize)
+			return &sizes[i];
+	return nullptr;
+}
+
+// G&S
+const sf::Texture& TextBatch::getAtlas() const
+{
+	return atlas;
+}
+
+int TextBatch::getNumOfGlyphs() const
+{
+	return numOfVertices / 4;
+}
+
+int TextBatch::getSkipped() const
+{
+	return skipped;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include "MemoryTracker.h"
+#include <SFML/Graphics.hpp>
+
+#define TEXT_BATCH_MAX_SIZES 4				// character sizes one atlas holds
+#define TEXT_BATCH_MAX_GLYPHS 2048			// glyphs drawn per frame at most, menus, scores, HUD and overlay together
+#define TEXT_BATCH_FIRST_CHARACTER 32		// printable ASCII is prewarmed
+#define TEXT_BATCH_LAST_CHARACTER 126
+#define TEXT_BATCH_ATLAS_GUTTER 2			// transparent rows between the pages of two sizes, so smoothing never mixes them
+#define TEXT_BATCH_CHARACTERS (TEXT_BATCH_LAST_CHARACTER - TEXT_BATCH_FIRST_CHARACTER + 1)
+
+class TextBatch
+{
+	/*
+	Draws every sf::Text of a frame as one vertex array of quads with one texture.
+	prewarm() rasterizes every character the game can show at every size it uses before the first frame,
+	copies the font's pages into a single atlas and tables the metrics and kerning, so no glyph is
+	rasterized, no texture changes and the font is not asked anything while playing.
+	add() lays a text out like sf::Text does and appends its glyphs, draw() hands all of them to the
+	backend in one call. Only the regular style of the prewarmed font is supported, characters that
+	were not prewarmed are skipped and counted
+	*/
+public:
+	TextBatch();
+private:
+	struct Glyph
+	{
+		sf::FloatRect bounds;		// relative to the baseline
+		sf::IntRect textureRect;	// in the atlas
+		float advance = 0.f;
+	};
+	struct SizeTable
+	{
+		unsigned characterSize = 0;
+		float lineSpacing = 0.f;
+		Glyph glyphs[TEXT_BATCH_CHARACTERS];
+	};
+
+	const sf::Font* font = nullptr;
+	SizeTable sizes[TEXT_BATCH_MAX_SIZES];
+	int numOfSizes = 0;
+	sf::Texture atlas;
+	TrackedVector<float, MEMORY_TEXT> kerning; // per size, previous * TEXT_BATCH_CHARACTERS + current
+
+	TrackedVector<sf::Vertex, MEMORY_TEXT> vertices; // 4 per glyph
+	int numOfVertices = 0;
+	int skipped = 0;
+
+public:
+	bool prewarm(const sf::Font& _font, const unsigned* characterSizes, const int count); // false when the atlas can not be made
+	void clear(); // at the start of a frame
+	void add(const sf::Text& text);
+	void draw(RenderBackend& renderer) const;
+
+	// G&S
+	const sf::Texture& getAtlas() const;
+	int getNumOfGlyphs() const; // added since clear()
+	int getSkipped() const;		// characters that were not prewarmed or did not fit, since prewarm()
+
+private:
+	const SizeTable* findSize(const unsigned characterSize) const;
+};
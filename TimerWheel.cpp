@@ -0,0 +1,170 @@
+#include "TimerWheel.h"
+
+#define NO_TIMER 0xffffffffu
+
+TimerWheel::TimerWheel()
+{
+	for (auto& slot : slots)
+		slot = NO_TIMER;
+
+	timers.reserve(TIMER_WHEEL_INITIAL_TIMERS);
+	freeTimers.reserve(TIMER_WHEEL_INITIAL_TIMERS);
+}
+
+void TimerWheel::reserve(const std::size_t count)
+{
+	timers.reserve(count);
+	freeTimers.reserve(count);
+}
+
+TimerHandle TimerWheel::schedule(const std::uint32_t delay, std::function<void()> callback)
+{
+	/*
+	Function calls callback after delay ticks (at least one)
+	*/
+	std::uint32_t index;
+	if (!freeTimers.empty())
+	{
+		index = freeTimers.back();
+		freeTimers.pop_back();
+	}
+	else
+	{
+		index = static_cast<std::uint32_t>(timers.size());
+		timers.emplace_back();
+		if (freeTimers.capacity() < timers.capacity())
+			freeTimers.reserve(timers.capacity()); // every timer can be free at once, the list grows with the pool and not while firing
+	}
+
+	Timer& timer = timers[index];
+	std::uint32_t clampedDelay = delay < 1 ? 1 : (delay > TIMER_WHEEL_MAX_DELAY ? TIMER_WHEEL_MAX_DELAY : delay);
+	timer.expires = now + clampedDelay;
+	timer.generation++;
+	timer.active = true;
+	timer.callback = std::move(callback);
+	insert(index);
+	numOfActiveTimers++;
+
+	TimerHandle handle;
+	handle.index = index;
+	handle.generation = timer.generation;
+	return handle;
+}
+
+bool TimerWheel::cancel(TimerHandle& handle)
+{
+	if (!isPending(handle))
+		return false;
+
+	Timer& timer = timers[handle.index];
+	unlink(handle.index);
+	timer.active = false;
+	timer.callback = nullptr;
+	freeTimers.push_back(handle.index);
+	numOfActiveTimers--;
+	handle = TimerHandle();
+	return true;
+}
+
+void TimerWheel::advance()
+{
+	/*
+	Function moves the wheel one tick forward and fires every timer that expires on it
+	*/
+	now++;
+
+	// cascade the levels whose lower levels just wrapped around, highest first
+	int numOfLevelsToCascade = 0;
+	for (int level{ 1 }; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		if ((now & ((1u << (level * TIMER_WHEEL_SLOT_BITS)) - 1)) != 0)
+			break;
+		numOfLevelsToCascade = level;
+	}
+	for (int level{ numOfLevelsToCascade }; level >= 1; level--)
+		cascade(level);
+
+	std::uint32_t& slot = slots[now & (TIMER_WHEEL_SLOTS - 1)];
+	while (slot != NO_TIMER)
+	{
+		std::uint32_t index = slot;
+		unlink(index);
+
+		// the callback may schedule new timers and grow the pool, so it is moved out first
+		std::function<void()> callback = std::move(timers[index].callback);
+		timers[index].callback = nullptr;
+		timers[index].active = false;
+		freeTimers.push_back(index);
+		numOfActiveTimers--;
+
+		if (callback)
+			callback();
+	}
+}
+
+void TimerWheel::insert(const std::uint32_t index)
+{
+	Timer& timer = timers[index];
+	std::uint32_t delta = timer.expires - now;
+
+	int level = 0;
+	while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << ((level + 1) * TIMER_WHEEL_SLOT_BITS)))
+		level++;
+
+	std::uint32_t slotIndex = (timer.expires >> (level * TIMER_WHEEL_SLOT_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+	timer.slot = level * TIMER_WHEEL_SLOTS + slotIndex;
+	timer.prev = NO_TIMER;
+	timer.next = slots[timer.slot];
+	if (timer.next != NO_TIMER)
+		timers[timer.next].prev = index;
+	slots[timer.slot] = index;
+}
+
+void TimerWheel::unlink(const std::uint32_t index)
+{
+	Timer& timer = timers[index];
+	if (timer.prev != NO_TIMER)
+		timers[timer.prev].next = timer.next;
+	else
+		slots[timer.slot] = timer.next;
+	if (timer.next != NO_TIMER)
+		timers[timer.next].prev = timer.prev;
+}
+
+void TimerWheel::cascade(const int level)
+{
+	/*
+	Function moves every timer of the current slot of level into the levels below
+	*/
+	std::uint32_t slotIndex = (now >> (level * TIMER_WHEEL_SLOT_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+	std::uint32_t index = slots[level * TIMER_WHEEL_SLOTS + slotIndex];
+	slots[level * TIMER_WHEEL_SLOTS + slotIndex] = NO_TIMER;
+
+	while (index != NO_TIMER)
+	{
+		std::uint32_t next = timers[index].next;
+		insert(index);
+		index = next;
+	}
+}
+
+// G&S
+std::uint32_t TimerWheel::getNow() const
+{
+	return now;
+}
+
+bool TimerWheel::isPending(const TimerHandle& handle) const
+{
+	return handle.index < timers.size() && timers[handle.index].active && timers[handle.index].generation == handle.generation;
+}
+
+std::uint32_t TimerWheel::getRemaining(const TimerHandle& handle) const
+{
+	return isPending(handle) ? timers[handle.index].expires - now : 0;
+}
+
+int TimerWheel::getActiveTimers() const
+{
+	return numOfActiveTimers;
+}
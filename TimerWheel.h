@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_MAX_DELAY ((1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1) // ticks
+#define TIMER_WHEEL_INITIAL_TIMERS 1024
+
+// Simulation Time, the game advances in fixed ticks regardless of the frame rate
+#define SIM_TICKS_PER_SECOND 60
+#define SIM_TICK_MS (1000.f / SIM_TICKS_PER_SECOND)
+
+inline std::uint32_t msToTicks(const float ms)
+{
+	return static_cast<std::uint32_t>(ms / SIM_TICK_MS + 0.5f);
+}
+
+struct TimerHandle
+{
+	std::uint32_t index = 0xffffffff;
+	std::uint32_t generation = 0;
+};
+
+class TimerWheel
+{
+	/*
+	Hierarchical timer wheel driven by the simulation tick, it is the only clock the simulation reads.
+	Scheduling, cancelling and advancing by one tick are O(1), timers further away than
+	one level can hold are cascaded down a level once every TIMER_WHEEL_SLOTS ticks of that level
+	*/
+public:
+	TimerWheel();
+private:
+
+	struct Timer
+	{
+		std::uint32_t expires = 0;
+		std::uint32_t generation = 0;
+		std::uint32_t slot = 0;			// level * TIMER_WHEEL_SLOTS + slot index
+		std::uint32_t next = 0, prev = 0;
+		bool active = false;
+		std::function<void()> callback;
+	};
+
+	std::uint32_t now = 0;
+	std::vector<Timer> timers;
+	std::vector<std::uint32_t> freeTimers;
+	std::uint32_t slots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+	int numOfActiveTimers = 0;
+
+public:
+	void reserve(const std::size_t count); // timers pending at once that never allocate
+	TimerHandle schedule(const std::uint32_t delay, std::function<void()> callback = nullptr); // no callback = plain deadline
+	bool cancel(TimerHandle& handle);
+	void advance();
+
+	// G&S
+	std::uint32_t getNow() const;
+	bool isPending(const TimerHandle& handle) const;
+	std::uint32_t getRemaining(const TimerHandle& handle) const;
+	int getActiveTimers() const;
+
+private:
+	void insert(const std::uint32_t index);
+	void unlink(const std::uint32_t index);
+	void cascade(const int level);
+};
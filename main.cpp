@@ -1,24 +1,211 @@
 #include "Game.h"
+#include "Telemetry.h"
+#include "MemoryTracker.h"
+#include "PolicyBenchmark.h"
+#include "BotLoadTest.h"
+#include "BatchEnvironment.h"
+#include "ParticleSystem.h"
+#include "AsteroidSolver.h"
+#include "ContactManager.h"
+#include "Script.h"
+#include "LiveMetrics.h"
+#include "NetServer.h"
+#include "NetLoadTest.h"
+#include "LeaderboardServer.h"
 #include <iostream>
+#include <string>
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 800
 
-int main()
+GameOptions parseOptions(int argc, char* argv[])
+{
+	/*
+	Parses the command line:
+		--headless [frames]		run without a window for a number of frames
+		--capture [directory]		save every frame as a png into directory
+		--capture-raw [file]		save every frame into a single raw RGBA stream (file.rgba)
+		--snapshot file			start the game from a snapshot dumped after a frame spike
+		--record-replay file		record the input of every tick of the first game
+		--replay file			play a recorded game tick by tick, then exit
+		--telemetry [file]		log gameplay events and frame times to file (default telemetry.bin)
+		--renderer software|sfml	draw with the CPU software rasterizer (no GPU needed) or with SFML (default)
+		--render-benchmark [frames]	headless, prints the time it takes to draw the game scene (default 1000 frames)
+		--autopilot			the ship plays itself
+		--memory-report			print memory use per subsystem when the game closes (F4 prints it while playing)
+		--overlay			show the debug overlay (F3 toggles it)
+		--no-governor			keep full quality even when frames overrun their budget
+		--precise-collision		test circles after the bounding boxes (dropped again at coarse collision quality)
+		--music				play the soundtrack from assets/menuMusic.ogg and assets/gameMusic.ogg when they are there
+		--vsync				present on vertical blanks, frames are started as late as the work allows
+		--pacing-report			print frame pacing and input to present latency when the game closes
+		--fixed-point			fixed-point movement and table trigonometry, games and replays are bit-identical everywhere
+		--asteroids count		asteroids at the start of a game (default 6), thousands for the high density mode
+		--solver-threads count		threads of the asteroid collision solver, 0 uses every core (default 1)
+		--leaderboard host[:port]	submit every result to the leaderboard service (default port 8080)
+		--player name			name the results are submitted under
+		--metrics [name]		publish live metrics to shared memory for monitoring (default AsteroidsGameMetrics)
+	*/
+	GameOptions options;
+	for (int i{ 1 }; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+
+		if (arg == "--headless")
+		{
+			options.headless = true;
+			if (hasValue) options.headlessFrames = std::stoi(argv[++i]);
+		}
+		else if (arg == "--capture" || arg == "--capture-raw")
+		{
+			options.capture = true;
+			options.captureRaw = (arg == "--capture-raw");
+			if (hasValue) options.captureOutput = argv[++i];
+		}
+		else if (arg == "--metrics")
+		{
+			options.metricsName = hasValue ? argv[++i] : METRICS_DEFAULT_NAME;
+		}
+		else if (arg == "--telemetry")
+		{
+			options.telemetry = true;
+			if (hasValue) options.telemetryFile = argv[++i];
+		}
+		else if (arg == "--renderer" && hasValue)
+		{
+			options.softwareRenderer = std::string(argv[++i]) == "software";
+		}
+		else if (arg == "--render-benchmark")
+		{
+			options.headless = true;
+			options.renderBenchmarkFrames = hasValue ? std::stoi(argv[++i]) : 1000;
+		}
+		else if (arg == "--autopilot")
+		{
+			options.autopilot = true;
+		}
+		else if (arg == "--memory-report")
+		{
+			options.memoryReport = true;
+		}
+		else if (arg == "--overlay")
+		{
+			options.overlay = true;
+		}
+		else if (arg == "--vsync")
+		{
+			options.vsync = true;
+		}
+		else if (arg == "--pacing-report")
+		{
+			options.pacingReport = true;
+		}
+		else if (arg == "--fixed-point")
+		{
+			options.fixedPoint = true;
+		}
+		else if (arg == "--asteroids" && hasValue)
+		{
+			options.numOfAsteroids = std::stoi(argv[++i]);
+		}
+		else if (arg == "--solver-threads" && hasValue)
+		{
+			options.solverThreads = std::stoi(argv[++i]);
+		}
+		else if (arg == "--leaderboard" && hasValue)
+		{
+			std::string address = argv[++i];
+			size_t colon = address.find(':');
+			options.leaderboardHost = address.substr(0, colon);
+			if (colon != std::string::npos)
+				options.leaderboardPort = static_cast<unsigned short>(std::stoi(address.substr(colon + 1)));
+		}
+		else if (arg == "--player" && hasValue)
+		{
+			options.playerName = argv[++i];
+		}
+		else if (arg == "--no-governor")
+		{
+			options.qualityGovernor = false;
+		}
+		else if (arg == "--precise-collision")
+		{
+			options.preciseCollision = true;
+		}
+		else if (arg == "--music")
+		{
+			options.music = true;
+		}
+		else if (arg == "--snapshot" && hasValue)
+		{
+			options.snapshotFile = argv[++i];
+		}
+		else if (arg == "--record-replay" && hasValue)
+		{
+			options.recordReplayFile = argv[++i];
+		}
+		else if (arg == "--replay" && hasValue)
+		{
+			options.replayFile = argv[++i];
+		}
+		else
+			std::cerr << "Unknown option " << arg << "\n";
+	}
+	return options;
+}
+
+int main(int argc, char* argv[])
 {
 	/*
 		Tries to create a Game object,
 		if successful we run the game
 	*/
+	if (argc > 1 && std::string(argv[1]) == "--telemetry-report") // offline reader, no game
+		return Telemetry::printReport(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-policies") // headless simulation benchmark, no game
+		return PolicyBenchmark::run(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bot-load-test") // headless autopilot load test, no game
+		return BotLoadTest::run(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-batch") // batched environments for rollouts, no game
+		return BatchEnvironment::runBenchmark(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-particles") // particle update and vertex cost, no game
+		return ParticleSystem::runBenchmark(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-asteroid-collisions") // collision solver on one and many threads, no game
+		return AsteroidSolver::runBenchmark(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-contacts") // persistent contacts against testing every pair, no game
+		return ContactManager::runBenchmark(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-scripts") // thousands of waiting scripts, no game
+		return ScriptScheduler::runBenchmark(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--metrics-attach") // reads the live metrics of a running game, no game
+		return LiveMetrics::runAttach(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--bench-metrics") // publishing cost and torn read check, no game
+		return LiveMetrics::runBenchmark(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--server") // authoritative multiplayer server, no game
+		return NetServer::run(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--net-load-test") // server and simulated clients over localhost, no game
+		return NetLoadTest::run(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--leaderboard-server") // local stand-in for the leaderboard service, no game
+		return LeaderboardServer::run(argc - 2, argv + 2);
+	if (argc > 1 && std::string(argv[1]) == "--leaderboard-test") // submission client against a failing stand-in, no game
+		return LeaderboardServer::runTest(argc - 2, argv + 2);
+
 	try
 	{
-		Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
-		game.run();
+		GameOptions options = parseOptions(argc, argv);
+		Game game(SCREEN_WIDTH, SCREEN_HEIGHT, options);
+		if (options.renderBenchmarkFrames > 0)
+			game.runRenderBenchmark();
+		else
+			game.run();
 	}
 	catch (...)
 	{
 		std::cerr << "Exception throw in construction of Game object\n";
 	}
+
+	// the Game is gone, everything it allocated has to be freed by now
+	if (!MemoryTracker::checkLeaks(std::cerr))
+		return 1;
 	return 0;
 }
-